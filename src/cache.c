@@ -16,14 +16,25 @@
 
 static void cacheAtClient(HttpStream *stream);
 static bool fetchCachedResponse(HttpStream *stream);
+static bool getCachedValidators(cchar *content, cchar **etag, ssize *etagLen, cchar **modified, ssize *modifiedLen);
+static cchar *getVary(HttpStream *stream);
+static cchar *formatCacheKey(HttpStream *stream, char *buf, ssize size);
 static char *makeCacheKey(HttpStream *stream);
+static cchar *makeVariantKey(HttpStream *stream, cchar *key, cchar *vary, char *buf, ssize size);
 static void manageHttpCache(HttpCache *cache, int flags);
 static int matchCacheFilter(HttpStream *stream, HttpRoute *route, int dir);
 static int matchCacheHandler(HttpStream *stream, HttpRoute *route, int dir);
+static bool matchValidator(cchar *value, cchar *validator, ssize len);
 static void outgoingCacheFilterService(HttpQueue *q);
+static ssize putVariantKey(HttpStream *stream, char *dest, cchar *key, cchar *vary);
+static cchar *readCache(HttpStream *stream, cchar *key, MprTime *modified);
+static cchar *readCachedResponse(HttpStream *stream, char *buf, ssize size, cchar **keyp, MprTime *modified);
 static void readyCacheHandler(HttpQueue *q);
+static void removeCache(HttpStream *stream, cchar *key);
 static void saveCachedResponse(HttpStream *stream);
+static void saveVariantIndex(HttpStream *stream, cchar *key, cchar *vary, cchar *variantKey);
 static cchar *setHeadersFromCache(HttpStream *stream, cchar *content);
+static void writeCache(HttpStream *stream, cchar *key, cchar *data, MprTime modified);
 
 /************************************ Code ************************************/
 
@@ -133,8 +144,12 @@ static void readyCacheHandler(HttpQueue *q)
 
     if (tx->cachedContent) {
         if ((data = setHeadersFromCache(stream, tx->cachedContent)) != 0) {
-            tx->length = slen(data);
-            httpWriteString(q, data);
+            if (tx->status == HTTP_CODE_NOT_MODIFIED) {
+                httpOmitBody(stream);
+            } else {
+                tx->length = slen(data);
+                httpWriteString(q, data);
+            }
         }
     }
     httpFinalize(stream);
@@ -204,6 +219,10 @@ static void outgoingCacheFilterService(HttpQueue *q)
                      */
                     mprPutToBuf(tx->cacheBuffer, "X-Status: %d\n", tx->status);
                     for (kp = 0; (kp = mprGetNextKey(tx->headers, kp)) != 0; ) {
+                        if (scaselessmatch(kp->key, "Etag") || scaselessmatch(kp->key, "Last-Modified")) {
+                            /* The cache defines its own validators when saving the response */
+                            continue;
+                        }
                         mprPutToBuf(tx->cacheBuffer, "%s: %s\n", kp->key, (char*) kp->data);
                     }
                     mprPutCharToBuf(tx->cacheBuffer, '\n');
@@ -277,48 +296,66 @@ static bool fetchCachedResponse(HttpStream *stream)
 {
     HttpTx      *tx;
     MprTime     modified, when;
-    cchar       *value, *key, *tag;
+    cchar       *value, *key, *tag, *lastModified;
+    char        keyBuf[ME_BUFSIZE];
+    ssize       tagLen, lastModifiedLen;
     int         status, cacheOk, canUseClientCache;
 
     tx = stream->tx;
 
     /*
         Transparent caching. Manual caching must manually call httpWriteCached()
+        The cache key is formatted once into a local buffer, so serving cached content does not allocate.
      */
-    key = makeCacheKey(stream);
-    if ((value = httpGetHeader(stream, "Cache-Control")) != 0 &&
+    if ((value = httpGetHeaderById(stream, HTTP_HEADER_CACHE_CONTROL)) != 0 &&
             (scontains(value, "max-age=0") == 0 || scontains(value, "no-cache") == 0)) {
+        key = formatCacheKey(stream, keyBuf, sizeof(keyBuf));
         httpLog(stream->trace, "cache.reload", "context", "msg:'Client reload'");
 
-    } else if ((tx->cachedContent = mprReadCache(stream->host->responseCache, key, &modified, 0)) != 0) {
+    } else if ((tx->cachedContent = readCachedResponse(stream, keyBuf, sizeof(keyBuf), &key, &modified)) != 0) {
         /*
             See if a NotModified response can be served. This is much faster than sending the response.
             Observe headers:
                 If-None-Match: "ec18d-54-4d706a63"
                 If-Modified-Since: Fri, 04 Mar 2014 04:28:19 GMT
             Set status to OK when content must be transmitted.
+            The validators are computed when the response is saved, so this is just string comparisons.
+            The Etag and Last-Modified headers are then defined by setHeadersFromCache.
          */
+        if (!getCachedValidators(tx->cachedContent, &tag, &tagLen, &lastModified, &lastModifiedLen)) {
+            /*
+                Content cached via httpUpdateCache does not have precomputed validators
+             */
+            tag = mprGetMD5(key);
+            tagLen = slen(tag);
+            lastModified = mprFormatUniversalTime(MPR_HTTP_DATE, modified);
+            lastModifiedLen = slen(lastModified);
+            httpSetHeaderString(stream, "Etag", tag);
+            httpSetHeaderString(stream, "Last-Modified", lastModified);
+        }
         cacheOk = 1;
         canUseClientCache = 0;
-        tag = mprGetMD5(key);
-        if ((value = httpGetHeader(stream, "If-None-Match")) != 0) {
+        if ((value = httpGetHeaderById(stream, HTTP_HEADER_IF_NONE_MATCH)) != 0) {
             canUseClientCache = 1;
-            if (scmp(value, tag) != 0) {
+            if (!matchValidator(value, tag, tagLen)) {
                 cacheOk = 0;
             }
         }
-        if (cacheOk && (value = httpGetHeader(stream, "If-Modified-Since")) != 0) {
+        if (cacheOk && (value = httpGetHeaderById(stream, HTTP_HEADER_IF_MODIFIED_SINCE)) != 0) {
             canUseClientCache = 1;
-            mprParseTime(&when, value, 0, 0);
-            if (modified > when) {
-                cacheOk = 0;
+            /*
+                Clients normally echo the Last-Modified value. Only parse the date if it differs.
+             */
+            if (!matchValidator(value, lastModified, lastModifiedLen)) {
+                mprParseTime(&when, value, 0, 0);
+                if (modified > when) {
+                    cacheOk = 0;
+                }
             }
         }
         status = (canUseClientCache && cacheOk) ? HTTP_CODE_NOT_MODIFIED : HTTP_CODE_OK;
         httpLog(stream->trace, "cache.cached", "context", "msg:'Use cached content',key:'%s',status:%d", key, status);
         httpSetStatus(stream, status);
-        httpSetHeaderString(stream, "Etag", mprGetMD5(key));
-        httpSetHeaderString(stream, "Last-Modified", mprFormatUniversalTime(MPR_HTTP_DATE, modified));
         httpRemoveHeader(stream, "Content-Encoding");
         return 1;
     }
@@ -332,18 +369,168 @@ static void saveCachedResponse(HttpStream *stream)
     HttpTx      *tx;
     MprBuf      *buf;
     MprTime     modified;
+    cchar       *key, *primary, *vary, *data;
+    char        keyBuf[ME_BUFSIZE];
 
     tx = stream->tx;
     assert(tx->finalizedOutput && tx->cacheBuffer);
 
     buf = tx->cacheBuffer;
     tx->cacheBuffer = 0;
+    key = primary = makeCacheKey(stream);
+
+    if ((vary = getVary(stream)) != 0) {
+        if (schr(vary, '*')) {
+            httpLog(stream->trace, "cache.vary", "context", "msg:'Response varies on everything, not cached',key:'%s'", key);
+            return;
+        }
+        /*
+            Store the response under a variant key and record the variant in the index at the primary key
+         */
+        key = makeVariantKey(stream, primary, vary, keyBuf, sizeof(keyBuf));
+        saveVariantIndex(stream, primary, vary, key);
+    }
     /*
         Truncate modified time to get a 1 sec resolution. This is the resolution for If-Modified headers.
      */
     modified = mprGetTime() / TPS * TPS;
-    mprWriteCache(stream->host->responseCache, makeCacheKey(stream), mprGetBufStart(buf), modified,
-        tx->cache->serverLifespan, 0, 0);
+
+    /*
+        Compute the Etag and Last-Modified validators once here and store them at the start of the cached headers.
+        Cache hits then only need to compare strings. See getCachedValidators.
+     */
+    data = sfmt("Etag: %s\nLast-Modified: %s\n%s", mprGetMD5(key), mprFormatUniversalTime(MPR_HTTP_DATE, modified),
+        mprGetBufStart(buf));
+    writeCache(stream, key, data, modified);
+}
+
+
+/*
+    Get references to the validators stored at the start of cached content by saveCachedResponse. Content of the form:
+        Etag: tag\nLast-Modified: date\n...
+    This does not allocate. Returns false if the content does not have precomputed validators.
+ */
+static bool getCachedValidators(cchar *content, cchar **etag, ssize *etagLen, cchar **modified, ssize *modifiedLen)
+{
+    cchar   *cp;
+
+    if (!sstarts(content, "Etag: ")) {
+        return 0;
+    }
+    *etag = &content[6];
+    *etagLen = strcspn(*etag, "\n");
+    cp = &(*etag)[*etagLen];
+    if (*cp != '\n' || !sstarts(++cp, "Last-Modified: ")) {
+        return 0;
+    }
+    *modified = &cp[15];
+    *modifiedLen = strcspn(*modified, "\n");
+    return 1;
+}
+
+
+static bool matchValidator(cchar *value, cchar *validator, ssize len)
+{
+    return strncmp(value, validator, len) == 0 && value[len] == '\0';
+}
+
+
+/*
+    Write to the response cache and to the disk cache if enabled for this cache definition
+ */
+static void writeCache(HttpStream *stream, cchar *key, cchar *data, MprTime modified)
+{
+    HttpCache   *cache;
+
+    cache = stream->tx->cache;
+    mprWriteCache(stream->host->responseCache, key, data, modified, cache->serverLifespan, 0, 0);
+    if (stream->http->diskCache && (cache->flags & HTTP_CACHE_DISK)) {
+        httpWriteDiskCache(stream->http->diskCache, key, data, modified ? modified : mprGetTime(), cache->serverLifespan);
+    }
+}
+
+
+/*
+    Read from the response cache. If not present in memory, try the disk cache and promote into memory if found.
+ */
+static cchar *readCache(HttpStream *stream, cchar *key, MprTime *modified)
+{
+    MprTicks    lifespan;
+    MprTime     when;
+    cchar       *data;
+
+    if ((data = mprReadCache(stream->host->responseCache, key, modified, 0)) == 0 && stream->http->diskCache &&
+            (stream->tx->cache->flags & HTTP_CACHE_DISK)) {
+        if ((data = httpReadDiskCache(stream->http->diskCache, key, &when, &lifespan)) != 0) {
+            httpLog(stream->trace, "cache.disk", "context", "msg:'Promote from disk cache',key:'%s'", key);
+            mprWriteCache(stream->host->responseCache, key, data, when, lifespan, 0, 0);
+            if (modified) {
+                *modified = when;
+            }
+        }
+    }
+    return data;
+}
+
+
+static void removeCache(HttpStream *stream, cchar *key)
+{
+    mprRemoveCache(stream->host->responseCache, key);
+    if (stream->http->diskCache) {
+        httpRemoveDiskCache(stream->http->diskCache, key);
+    }
+}
+
+
+/*
+    Update the variant index for a primary cache key. The index is of the form:
+
+        X-Vary: fields\n
+        variantKey\n
+        ...
+
+    The number of variants per key is bounded by limits->cacheVariants. The oldest variants are evicted first.
+    If the response now varies on different fields, the previous variants are discarded.
+    Note: concurrent updates may lose an index entry. This is benign as the orphaned variant will simply expire.
+ */
+static void saveVariantIndex(HttpStream *stream, cchar *key, cchar *vary, cchar *variantKey)
+{
+    MprList     *variants;
+    MprBuf      *buf;
+    cchar       *index, *fields;
+    char        *item, *tok;
+    int         next;
+
+    variants = mprCreateList(0, 0);
+
+    if ((index = readCache(stream, key, 0)) != 0 && sstarts(index, "X-Vary: ")) {
+        index += 8;
+        fields = snclone(index, strcspn(index, "\n"));
+        item = stok(sclone(index), "\n", &tok);
+        for (item = stok(NULL, "\n", &tok); item; item = stok(NULL, "\n", &tok)) {
+            if (smatch(fields, vary)) {
+                if (!smatch(item, variantKey)) {
+                    mprAddItem(variants, item);
+                }
+            } else {
+                removeCache(stream, item);
+            }
+        }
+    }
+    mprAddItem(variants, variantKey);
+    while (mprGetListLength(variants) > stream->limits->cacheVariants) {
+        item = mprGetFirstItem(variants);
+        httpLog(stream->trace, "cache.vary", "context", "msg:'Evict cached variant',key:'%s'", item);
+        removeCache(stream, item);
+        mprRemoveItemAtPos(variants, 0);
+    }
+    buf = mprCreateBuf(0, 0);
+    mprPutToBuf(buf, "X-Vary: %s\n", vary);
+    for (ITERATE_ITEMS(variants, item, next)) {
+        mprPutToBuf(buf, "%s\n", item);
+    }
+    mprAddNullToBuf(buf);
+    writeCache(stream, key, mprGetBufStart(buf), 0);
 }
 
 
@@ -351,19 +538,21 @@ PUBLIC ssize httpWriteCached(HttpStream *stream)
 {
     MprTime     modified;
     cchar       *cacheKey, *data, *content;
+    char        keyBuf[ME_BUFSIZE];
 
     if (!stream->tx->cache) {
         return MPR_ERR_CANT_FIND;
     }
-    cacheKey = makeCacheKey(stream);
-    if ((content = mprReadCache(stream->host->responseCache, cacheKey, &modified, 0)) == 0) {
+    if ((content = readCachedResponse(stream, keyBuf, sizeof(keyBuf), &cacheKey, &modified)) == 0) {
         httpLog(stream->trace, "cache.none", "context", "msg:'No response data in cache', key:'%s'", cacheKey);
         return 0;
     }
     httpLog(stream->trace, "cache.cached", "context", "msg:'Used cached response', key:'%s'", cacheKey);
     data = setHeadersFromCache(stream, content);
-    httpSetHeaderString(stream, "Etag", mprGetMD5(cacheKey));
-    httpSetHeaderString(stream, "Last-Modified", mprFormatUniversalTime(MPR_HTTP_DATE, modified));
+    if (!sstarts(content, "Etag: ")) {
+        httpSetHeaderString(stream, "Etag", mprGetMD5(cacheKey));
+        httpSetHeaderString(stream, "Last-Modified", mprFormatUniversalTime(MPR_HTTP_DATE, modified));
+    }
     stream->tx->cacheBuffer = 0;
     httpWriteString(stream->writeq, data);
     httpFinalizeOutput(stream);
@@ -384,6 +573,10 @@ PUBLIC ssize httpUpdateCache(HttpStream *stream, cchar *uri, cchar *data, MprTic
         lifespan = stream->rx->route->lifespan;
     }
     key = sfmt("http::response::%s", uri);
+    if (stream->http->diskCache) {
+        /* Updated content is only held in memory. Discard any prior copy on disk. */
+        httpRemoveDiskCache(stream->http->diskCache, key);
+    }
     if (data == 0 || lifespan <= 0) {
         mprRemoveCache(stream->host->responseCache, key);
         return 0;
@@ -510,6 +703,132 @@ static char *makeCacheKey(HttpStream *stream)
 }
 
 
+/*
+    Format the cache key for the request into the given buffer. The key is only allocated if it does not fit.
+ */
+static cchar *formatCacheKey(HttpStream *stream, char *buf, ssize size)
+{
+    HttpRx      *rx;
+
+    rx = stream->rx;
+    if (stream->tx->cache->flags & HTTP_CACHE_UNIQUE) {
+        return makeCacheKey(stream);
+    }
+    fmt(buf, size, "http::response::%s%s", rx->route->prefix, rx->pathInfo);
+    if (slen(buf) >= size - 1) {
+        return makeCacheKey(stream);
+    }
+    return buf;
+}
+
+
+/*
+    Make a cache key for a response variant. The values of the request headers named in the vary list are appended
+    to the primary key so that each distinct combination is cached separately. The key is made in the given buffer
+    and is only allocated if it does not fit. The key may already be at the start of the buffer.
+ */
+static cchar *makeVariantKey(HttpStream *stream, cchar *key, cchar *vary, char *buf, ssize size)
+{
+    ssize   len;
+
+    len = putVariantKey(stream, NULL, key, vary);
+    if (len >= size) {
+        buf = mprAlloc(len + 1);
+    }
+    putVariantKey(stream, buf, key, vary);
+    return buf;
+}
+
+
+/*
+    Put a variant key into dest and return its length. If dest is null, just measure the key.
+    The vary list ends at a null or newline so it can be used directly from a variant index.
+ */
+static ssize putVariantKey(HttpStream *stream, char *dest, cchar *key, cchar *vary)
+{
+    cchar   *value;
+    char    field[ME_MAX_FNAME];
+    ssize   len, flen, vlen;
+
+    len = slen(key);
+    if (dest) {
+        if (dest != key) {
+            memcpy(dest, key, len);
+        }
+        memcpy(&dest[len], "::vary", 6);
+    }
+    len += 6;
+    for (vary += strspn(vary, ", \t"); *vary && *vary != '\n'; vary += strspn(vary, ", \t")) {
+        flen = strcspn(vary, ", \t\n");
+        sncopy(field, sizeof(field), vary, min(flen, (ssize) sizeof(field) - 1));
+        vary += flen;
+        value = httpGetHeader(stream, field);
+        vlen = slen(value);
+        if (dest) {
+            memcpy(&dest[len], "::", 2);
+            if (vlen > 0) {
+                memcpy(&dest[len + 2], value, vlen);
+            }
+        }
+        len += vlen + 2;
+    }
+    if (dest) {
+        dest[len] = '\0';
+    }
+    return len;
+}
+
+
+/*
+    Get the request headers on which the response varies. The route headers are not applied until the response
+    headers are created, so any route Vary directives are applied here as well.
+ */
+static cchar *getVary(HttpStream *stream)
+{
+    MprKeyValue *item;
+    cchar       *vary;
+    int         next;
+
+    vary = mprLookupKey(stream->tx->headers, "Vary");
+    for (ITERATE_ITEMS(stream->rx->route->headers, item, next)) {
+        if (!scaselessmatch(item->key, "Vary")) {
+            continue;
+        }
+        if (item->flags == HTTP_ROUTE_ADD_HEADER) {
+            if (!vary) {
+                vary = item->value;
+            }
+        } else if (item->flags == HTTP_ROUTE_APPEND_HEADER) {
+            vary = vary ? sjoin(vary, ", ", item->value, NULL) : item->value;
+        } else if (item->flags == HTTP_ROUTE_REMOVE_HEADER) {
+            vary = 0;
+        } else if (item->flags == HTTP_ROUTE_SET_HEADER) {
+            vary = item->value;
+        }
+    }
+    return (vary && *vary) ? vary : 0;
+}
+
+
+/*
+    Read cached content for the request. If the primary key holds a variant index, select the variant matching
+    the request headers. Returns the selected cache key via keyp. The key is made in the given buffer if it fits.
+    The variant key extends the primary key in place.
+ */
+static cchar *readCachedResponse(HttpStream *stream, char *buf, ssize size, cchar **keyp, MprTime *modified)
+{
+    cchar   *content, *key;
+
+    key = formatCacheKey(stream, buf, size);
+    if ((content = readCache(stream, key, modified)) != 0 && sstarts(content, "X-Vary: ")) {
+        key = makeVariantKey(stream, key, &content[8], buf, size);
+        content = readCache(stream, key, modified);
+    }
+    *keyp = key;
+    return content;
+}
+
+
 /*
     Parse cached content of the form:  headers \n\n data
     Set headers in the current request and return a reference to the data portion
@@ -527,7 +846,12 @@ static cchar *setHeadersFromCache(HttpStream *stream, cchar *content)
         for (header = stok(headers, "\n", &tok); header; header = stok(NULL, "\n", &tok)) {
             key = ssplit(header, ": ", &value);
             if (smatch(key, "X-Status")) {
-                stream->tx->status = (int) stoi(value);
+                /* Preserve a NotModified status determined by fetchCachedResponse */
+                if (stream->tx->status != HTTP_CODE_NOT_MODIFIED) {
+                    stream->tx->status = (int) stoi(value);
+                }
+            } else if (smatch(key, "Etag") || smatch(key, "Last-Modified")) {
+                httpSetHeaderString(stream, key, value);
             } else {
                 httpAddHeaderString(stream, key, value);
             }
@@ -537,6 +861,424 @@ static cchar *setHeadersFromCache(HttpStream *stream, cchar *content)
 }
 
 
+/********************************** Disk Cache ********************************/
+/*
+    Disk cache segment record header. Each record is followed by the key and data and is padded to 8 bytes.
+    Records are appended and never modified. A removed key is recorded by appending a DISK_REMOVED record.
+ */
+typedef struct DiskRecord {
+    uint32      magic;                  /* DISK_MAGIC */
+    uint32      flags;                  /* DISK_REMOVED */
+    uint32      keyLen;                 /* Length of the key */
+    uint32      dataLen;                /* Length of the data */
+    int64       modified;               /* Last modified time (MprTime) */
+    int64       expires;                /* Expiry time (MprTime) */
+} DiskRecord;
+
+#define DISK_MAGIC          0x48444331
+#define DISK_REMOVED        0x1
+#define DISK_RECORD_SIZE(keyLen, dataLen) ((sizeof(DiskRecord) + (keyLen) + (dataLen) + 7) & ~7)
+
+typedef struct DiskSegment {
+    char        *path;                  /* Segment filename */
+    MprFile     *file;                  /* Open segment file */
+    char        *map;                   /* Read-only mapping of the segment (not alloced) */
+    ssize       mapSize;                /* Size of the mapping */
+    MprOff      size;                   /* Bytes written to the segment */
+} DiskSegment;
+
+typedef struct DiskItem {
+    DiskSegment *segment;               /* Segment holding the item */
+    MprOff      offset;                 /* Offset of the item data in the segment */
+    ssize       length;                 /* Length of the item data */
+    MprTime     modified;               /* Last modified time */
+    MprTime     expires;                /* Expiry time */
+    int         hits;                   /* Reads since the item was written */
+} DiskItem;
+
+static int appendDiskRecord(HttpDiskCache *cache, cchar *key, cchar *data, ssize len, MprTime modified, MprTime expires,
+    int flags);
+static void closeSegment(DiskSegment *segment);
+static int compareSegments(MprDirEntry **d1, MprDirEntry **d2);
+static void loadSegment(HttpDiskCache *cache, DiskSegment *segment);
+static void manageDiskCache(HttpDiskCache *cache, int flags);
+static void manageDiskItem(DiskItem *item, int flags);
+static void manageDiskSegment(DiskSegment *segment, int flags);
+static DiskSegment *openSegment(HttpDiskCache *cache, int seq);
+static void pruneDiskCache(HttpDiskCache *cache);
+static ssize readSegment(DiskSegment *segment, MprOff offset, void *buf, ssize len);
+
+PUBLIC HttpDiskCache *httpOpenDiskCache(cchar *dir, MprOff maxSize)
+{
+    HttpDiskCache   *cache;
+    DiskSegment     *segment;
+    MprDirEntry     *dp;
+    MprList         *files;
+    int             next, seq;
+
+    if (mprMakeDir(dir, 0755, -1, -1, 1) < 0) {
+        mprLog("error http cache", 0, "Cannot create disk cache directory %s", dir);
+        return 0;
+    }
+    if ((cache = mprAllocObj(HttpDiskCache, manageDiskCache)) == 0) {
+        return 0;
+    }
+    cache->dir = sclone(dir);
+    cache->index = mprCreateHash(0, 0);
+    cache->segments = mprCreateList(0, 0);
+    cache->mutex = mprCreateLock();
+    cache->maxSize = maxSize;
+    cache->segmentSize = (ssize) min(maxSize / 4, ME_MAX_CACHE_SEGMENT);
+    cache->segmentSize = max(cache->segmentSize, ME_MAX_CACHE_ITEM * 2);
+    cache->nextSeq = 1;
+
+    /*
+        Rebuild the index by replaying the segments in order of creation
+     */
+    files = mprGetPathFiles(dir, MPR_PATH_NO_DIRS | MPR_PATH_RELATIVE);
+    mprSortList(files, (MprSortProc) compareSegments, 0);
+    for (ITERATE_ITEMS(files, dp, next)) {
+        if (!sends(dp->name, ".seg") || (seq = (int) stoi(dp->name)) <= 0) {
+            continue;
+        }
+        if ((segment = openSegment(cache, seq)) != 0) {
+            mprAddItem(cache->segments, segment);
+            loadSegment(cache, segment);
+            cache->size += segment->size;
+            cache->nextSeq = seq + 1;
+        }
+    }
+    pruneDiskCache(cache);
+    mprLog("info http cache", 2, "Disk cache %s has %d items in %d segments", dir, mprGetHashLength(cache->index),
+        mprGetListLength(cache->segments));
+    return cache;
+}
+
+
+PUBLIC char *httpReadDiskCache(HttpDiskCache *cache, cchar *key, MprTime *modified, MprTicks *lifespan)
+{
+    DiskItem    *item;
+    MprTime     now;
+    char        *data;
+
+    assert(cache);
+    assert(key && *key);
+
+    lock(cache);
+    if ((item = mprLookupKey(cache->index, key)) == 0) {
+        unlock(cache);
+        return 0;
+    }
+    now = mprGetTime();
+    if (item->expires <= now) {
+        mprRemoveKey(cache->index, key);
+        unlock(cache);
+        return 0;
+    }
+    if ((data = mprAlloc(item->length + 1)) == 0 || readSegment(item->segment, item->offset, data, item->length) < 0) {
+        mprRemoveKey(cache->index, key);
+        unlock(cache);
+        return 0;
+    }
+    data[item->length] = '\0';
+    item->hits++;
+    if (modified) {
+        *modified = item->modified;
+    }
+    if (lifespan) {
+        *lifespan = item->expires - now;
+    }
+    unlock(cache);
+    return data;
+}
+
+
+PUBLIC void httpRemoveDiskCache(HttpDiskCache *cache, cchar *key)
+{
+    assert(cache);
+    assert(key && *key);
+
+    lock(cache);
+    if (mprLookupKey(cache->index, key)) {
+        appendDiskRecord(cache, key, "", 0, 0, 0, DISK_REMOVED);
+        pruneDiskCache(cache);
+    }
+    unlock(cache);
+}
+
+
+PUBLIC int httpWriteDiskCache(HttpDiskCache *cache, cchar *key, cchar *data, MprTime modified, MprTicks lifespan)
+{
+    int     rc;
+
+    assert(cache);
+    assert(key && *key);
+    assert(data);
+
+    lock(cache);
+    rc = appendDiskRecord(cache, key, data, slen(data), modified, mprGetTime() + lifespan, 0);
+    pruneDiskCache(cache);
+    unlock(cache);
+    return rc;
+}
+
+
+/*
+    Append a record to the active segment and update the index. Must be called locked.
+ */
+static int appendDiskRecord(HttpDiskCache *cache, cchar *key, cchar *data, ssize len, MprTime modified, MprTime expires,
+    int flags)
+{
+    DiskSegment *segment;
+    DiskRecord  *record;
+    DiskItem    *item;
+    MprOff      offset;
+    ssize       keyLen, size;
+    char        *block;
+
+    keyLen = slen(key);
+    size = DISK_RECORD_SIZE(keyLen, len);
+    if (size > cache->segmentSize) {
+        return MPR_ERR_WONT_FIT;
+    }
+    segment = mprGetLastItem(cache->segments);
+    if (!segment || (segment->size + size) > cache->segmentSize) {
+        if ((segment = openSegment(cache, cache->nextSeq++)) == 0) {
+            return MPR_ERR_CANT_OPEN;
+        }
+        mprAddItem(cache->segments, segment);
+    }
+    if ((block = mprAlloc(size)) == 0) {
+        return MPR_ERR_MEMORY;
+    }
+    memset(block, 0, size);
+    record = (DiskRecord*) block;
+    record->magic = DISK_MAGIC;
+    record->flags = flags;
+    record->keyLen = (uint32) keyLen;
+    record->dataLen = (uint32) len;
+    record->modified = modified;
+    record->expires = expires;
+    memcpy(&block[sizeof(DiskRecord)], key, keyLen);
+    memcpy(&block[sizeof(DiskRecord) + keyLen], data, len);
+
+    offset = segment->size;
+    if (mprSeekFile(segment->file, SEEK_SET, offset) != offset || mprWriteFile(segment->file, block, size) != size) {
+        mprLog("error http cache", 0, "Cannot write to disk cache segment %s", segment->path);
+        return MPR_ERR_CANT_WRITE;
+    }
+    segment->size += size;
+    cache->size += size;
+
+    if (flags & DISK_REMOVED) {
+        mprRemoveKey(cache->index, key);
+    } else {
+        if ((item = mprAllocObj(DiskItem, manageDiskItem)) == 0) {
+            return MPR_ERR_MEMORY;
+        }
+        item->segment = segment;
+        item->offset = offset + sizeof(DiskRecord) + keyLen;
+        item->length = len;
+        item->modified = modified;
+        item->expires = expires;
+        mprAddKey(cache->index, key, item);
+    }
+    return 0;
+}
+
+
+/*
+    Replay the records of a segment into the index. A trailing partial record from an interrupted write is truncated.
+ */
+static void loadSegment(HttpDiskCache *cache, DiskSegment *segment)
+{
+    DiskRecord  record;
+    DiskItem    *item;
+    MprTime     now;
+    MprOff      offset;
+    ssize       size;
+    char        *key;
+
+    now = mprGetTime();
+    for (offset = 0; offset < segment->size; offset += size) {
+        if (readSegment(segment, offset, &record, sizeof(DiskRecord)) < 0 || record.magic != DISK_MAGIC) {
+            break;
+        }
+        size = DISK_RECORD_SIZE(record.keyLen, record.dataLen);
+        if (record.keyLen == 0 || (offset + size) > segment->size) {
+            break;
+        }
+        if ((key = mprAlloc(record.keyLen + 1)) == 0 ||
+                readSegment(segment, offset + sizeof(DiskRecord), key, record.keyLen) < 0) {
+            break;
+        }
+        key[record.keyLen] = '\0';
+        if ((record.flags & DISK_REMOVED) || record.expires <= now) {
+            mprRemoveKey(cache->index, key);
+        } else if ((item = mprAllocObj(DiskItem, manageDiskItem)) != 0) {
+            item->segment = segment;
+            item->offset = offset + sizeof(DiskRecord) + record.keyLen;
+            item->length = record.dataLen;
+            item->modified = record.modified;
+            item->expires = record.expires;
+            mprAddKey(cache->index, key, item);
+        }
+    }
+    if (offset < segment->size) {
+        mprLog("warn http cache", 2, "Truncate corrupt disk cache segment %s at %lld", segment->path, offset);
+        mprTruncateFile(segment->path, offset);
+        segment->size = offset;
+    }
+}
+
+
+/*
+    Discard the oldest segments while over the disk budget. Items that have been read since they were written are
+    copied forward to the active segment. Other items are cold and are dropped. Must be called locked.
+ */
+static void pruneDiskCache(HttpDiskCache *cache)
+{
+    DiskSegment *segment;
+    DiskItem    *item;
+    MprKey      *kp;
+    MprList     *keys;
+    MprTime     now;
+    cchar       *key;
+    char        *data;
+    int         next;
+
+    while (cache->size > cache->maxSize && mprGetListLength(cache->segments) > 1) {
+        segment = mprGetFirstItem(cache->segments);
+        mprRemoveItemAtPos(cache->segments, 0);
+        cache->size -= segment->size;
+
+        keys = mprCreateList(0, 0);
+        for (ITERATE_KEYS(cache->index, kp)) {
+            item = (DiskItem*) kp->data;
+            if (item->segment == segment) {
+                mprAddItem(keys, kp->key);
+            }
+        }
+        now = mprGetTime();
+        for (ITERATE_ITEMS(keys, key, next)) {
+            item = mprLookupKey(cache->index, key);
+            mprRemoveKey(cache->index, key);
+            if (item->hits > 0 && item->expires > now && (data = mprAlloc(item->length + 1)) != 0 &&
+                    readSegment(segment, item->offset, data, item->length) == item->length) {
+                appendDiskRecord(cache, key, data, item->length, item->modified, item->expires, 0);
+            }
+        }
+        closeSegment(segment);
+        mprDeletePath(segment->path);
+    }
+}
+
+
+static DiskSegment *openSegment(HttpDiskCache *cache, int seq)
+{
+    DiskSegment *segment;
+    MprPath     info;
+
+    if ((segment = mprAllocObj(DiskSegment, manageDiskSegment)) == 0) {
+        return 0;
+    }
+    segment->path = mprJoinPath(cache->dir, sfmt("%08d.seg", seq));
+    if ((segment->file = mprOpenFile(segment->path, O_RDWR | O_CREAT | O_BINARY, 0600)) == 0) {
+        mprLog("error http cache", 0, "Cannot open disk cache segment %s", segment->path);
+        return 0;
+    }
+    if (mprGetPathInfo(segment->path, &info) == 0) {
+        segment->size = info.size;
+    }
+#if ME_UNIX_LIKE
+    /*
+        Map the full segment extent so the mapping remains valid as records are appended
+     */
+    segment->mapSize = (ssize) max(segment->size, cache->segmentSize);
+    segment->map = mmap(0, segment->mapSize, PROT_READ, MAP_SHARED, mprGetFileFd(segment->file), 0);
+    if (segment->map == MAP_FAILED) {
+        segment->map = 0;
+    }
+#endif
+    return segment;
+}
+
+
+static void closeSegment(DiskSegment *segment)
+{
+#if ME_UNIX_LIKE
+    if (segment->map) {
+        munmap(segment->map, segment->mapSize);
+        segment->map = 0;
+    }
+#endif
+    if (segment->file) {
+        mprCloseFile(segment->file);
+        segment->file = 0;
+    }
+}
+
+
+/*
+    Read from a segment. Uses the mapping if available, otherwise reads from the file.
+ */
+static ssize readSegment(DiskSegment *segment, MprOff offset, void *buf, ssize len)
+{
+    if ((offset + len) > segment->size) {
+        return MPR_ERR_CANT_READ;
+    }
+    if (segment->map) {
+        memcpy(buf, &segment->map[offset], len);
+        return len;
+    }
+    if (mprSeekFile(segment->file, SEEK_SET, offset) != offset || mprReadFile(segment->file, buf, len) != len) {
+        return MPR_ERR_CANT_READ;
+    }
+    return len;
+}
+
+
+static int compareSegments(MprDirEntry **d1, MprDirEntry **d2)
+{
+    return scmp((*d1)->name, (*d2)->name);
+}
+
+
+static void manageDiskCache(HttpDiskCache *cache, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(cache->dir);
+        mprMark(cache->index);
+        mprMark(cache->segments);
+        mprMark(cache->mutex);
+    }
+}
+
+
+static void manageDiskItem(DiskItem *item, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(item->segment);
+    }
+}
+
+
+static void manageDiskSegment(DiskSegment *segment, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(segment->path);
+        mprMark(segment->file);
+
+    } else if (flags & MPR_MANAGE_FREE) {
+#if ME_UNIX_LIKE
+        if (segment->map) {
+            munmap(segment->map, segment->mapSize);
+        }
+#endif
+    }
+}
+
+
 /*
     Copyright (c) Embedthis Software. All Rights Reserved.
     This software is distributed under commercial and open source licenses.
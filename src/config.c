@@ -279,6 +279,12 @@ static void parseAliases(HttpRoute *route, cchar *key, MprJson *prop)
 
     attach: 'ip:port'
  */
+static void parseAsyncRead(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    httpSetRouteAsyncRead(route, (prop->type & MPR_JSON_TRUE) ? 1 : 0);
+}
+
+
 static void parseAttach(HttpRoute *route, cchar *key, MprJson *prop)
 {
     HttpEndpoint    *endpoint;
@@ -542,6 +548,10 @@ static void parseCache(HttpRoute *route, cchar *key, MprJson *prop)
                 /* User must manually call httpWriteCache */
                 flags |= HTTP_CACHE_MANUAL;
             }
+            if (smatch(mprReadJson(child, "disk"), "true")) {
+                /* Also save server cached content in the persistent disk cache. Requires limits.cacheDisk. */
+                flags |= HTTP_CACHE_DISK;
+            }
             httpAddCache(route, methods, urls, extensions, mimeTypes, clientLifespan, serverLifespan, flags);
         }
     }
@@ -592,6 +602,12 @@ static void parseCgiPrefix(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+static void parseCombineRoutes(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    httpSetHostCombineRoutes(route->host, (prop->type & MPR_JSON_TRUE) ? 1 : 0);
+}
+
+
 static void parseCompress(HttpRoute *route, cchar *key, MprJson *prop)
 {
     if (smatch(prop->value, "true")) {
@@ -788,6 +804,12 @@ static void parseLimits(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+static void parseLimitsArena(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    route->limits->arenaSize = httpGetNumber(prop->value);
+}
+
+
 static void parseLimitsCache(HttpRoute *route, cchar *key, MprJson *prop)
 {
     mprSetCacheLimits(route->host->responseCache, 0, 0, httpGetNumber(prop->value), 0);
@@ -800,6 +822,37 @@ static void parseLimitsCacheItem(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+/*
+    Enable the persistent disk cache with the given disk budget. The segment files are stored in the "cache" directory.
+    The disk cache is shared by all hosts and routes, so it may only be defined by the top level limits.
+ */
+static void parseLimitsCacheDisk(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    cchar   *dir;
+
+    if (route->flags & HTTP_ROUTE_HOSTED) {
+        return;
+    }
+    if (route->parent) {
+        httpParseWarn(route, "The disk cache limit can only be defined in the top level limits");
+        return;
+    }
+    if ((dir = httpGetDir(route, "cache")) == 0) {
+        dir = "cache";
+    }
+    dir = mprJoinPath(route->home, dir);
+    if ((route->http->diskCache = httpOpenDiskCache(dir, (MprOff) httpGetNumber(prop->value))) == 0) {
+        httpParseError(route, "Cannot open disk cache in %s", dir);
+    }
+}
+
+
+static void parseLimitsCacheVariants(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    route->limits->cacheVariants = httpGetInt(prop->value);
+}
+
+
 static void parseLimitsChunk(HttpRoute *route, cchar *key, MprJson *prop)
 {
     route->limits->chunkSize = httpGetInt(prop->value);
@@ -886,6 +939,12 @@ static void parseLimitsProcesses(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+static void parseLimitsRanges(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    route->limits->rangesMax = httpGetInt(prop->value);
+}
+
+
 static void parseLimitsRequests(HttpRoute *route, cchar *key, MprJson *prop)
 {
     route->limits->requestsPerClientMax = httpGetInt(prop->value);
@@ -1153,6 +1212,37 @@ static void createRedirectAlias(HttpRoute *route, int status, cchar *from, cchar
 }
 
 
+/*
+    Create a rate limit from { rate: 100, burst: 200, status: 429, defer: '1 sec' }
+ */
+static HttpRate *makeRate(HttpRoute *route, MprJson *prop, int status)
+{
+    cchar       *burst, *defer, *value;
+    int64       rate;
+
+    if ((value = mprReadJson(prop, "rate")) == 0 || (rate = httpGetNumber(value)) == 0) {
+        httpParseError(route, "Missing or bad rate for \"%s\"", prop->name);
+        return 0;
+    }
+    burst = mprReadJson(prop, "burst");
+    defer = mprReadJson(prop, "defer");
+    if ((value = mprReadJson(prop, "status")) != 0) {
+        status = httpGetInt(value);
+    }
+    return httpCreateRate(rate, burst ? httpGetNumber(burst) : 0, status, defer ? httpGetTicks(defer) : 0);
+}
+
+
+/*
+    rate: { rate: 1000, burst: 100, status: 503 }
+    Limits requests over all clients for this route and routes inheriting from it
+ */
+static void parseRate(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    route->rate = makeRate(route, prop, HTTP_CODE_SERVICE_UNAVAILABLE);
+}
+
+
 /*
     redirect: 'secure'
     redirect: [
@@ -1351,6 +1441,46 @@ static void parseServerAccount(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+/*
+    affinity: '0-3,6'
+ */
+static void parseServerAffinity(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    if (route->flags & HTTP_ROUTE_HOSTED) {
+        return;
+    }
+    if (mprSetWorkerAffinity(prop->value) < 0) {
+        httpParseError(route, "Bad CPU affinity list \"%s\"", prop->value);
+    }
+}
+
+
+/*
+    counters: 'path' | { path: 'path', clients: 4096 }
+ */
+static void parseServerCounters(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    cchar   *clients, *path;
+
+    if (route->flags & HTTP_ROUTE_HOSTED) {
+        return;
+    }
+    if (prop->type & MPR_JSON_OBJ) {
+        path = mprReadJson(prop, "path");
+        if ((clients = mprReadJson(prop, "clients")) != 0) {
+            HTTP->sharedClients = max(httpGetInt(clients), 16);
+        }
+    } else {
+        path = prop->value;
+    }
+    if (!path || *path == '\0') {
+        httpParseError(route, "Missing shared counters path");
+        return;
+    }
+    HTTP->sharedPath = httpMakePath(route, 0, path);
+}
+
+
 static void parseServerDefenses(HttpRoute *route, cchar *key, MprJson *prop)
 {
     MprJson     *child;
@@ -1362,6 +1492,18 @@ static void parseServerDefenses(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+/*
+    prefork: 4
+ */
+static void parseServerPrefork(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    if (route->flags & HTTP_ROUTE_HOSTED) {
+        return;
+    }
+    HTTP->prefork = max(atoi(prop->value), 0);
+}
+
+
 static void parseServerListen(HttpRoute *route, cchar *key, MprJson *prop)
 {
     HttpEndpoint    *endpoint, *dual;
@@ -1536,6 +1678,29 @@ static void parseServerMonitors(HttpRoute *route, cchar *key, MprJson *prop)
 }
 
 
+/*
+    rates: {
+        connections: { rate: 20, burst: 40, defer: '500 msecs', status: 503 },
+        requests: { rate: 100, burst: 200, status: 429 },
+    }
+    Limits new connections and requests per client IP address
+ */
+static void parseServerRates(HttpRoute *route, cchar *key, MprJson *prop)
+{
+    MprJson     *child;
+
+    if (route->flags & HTTP_ROUTE_HOSTED) {
+        return;
+    }
+    if ((child = mprReadJsonObj(prop, "connections")) != 0) {
+        HTTP->connectionRate = makeRate(route, child, HTTP_CODE_SERVICE_UNAVAILABLE);
+    }
+    if ((child = mprReadJsonObj(prop, "requests")) != 0) {
+        HTTP->requestRate = makeRate(route, child, HTTP_CODE_TOO_MANY_REQUESTS);
+    }
+}
+
+
 static void parseShowErrors(HttpRoute *route, cchar *key, MprJson *prop)
 {
     httpSetRouteShowErrors(route, (prop->type & MPR_JSON_TRUE) ? 1 : 0);
@@ -1933,6 +2098,7 @@ PUBLIC int httpInitParser()
     httpAddConfig("directories", parseDirectories);
     httpAddConfig("http", parseHttp);
     httpAddConfig("http.aliases", parseAliases);
+    httpAddConfig("http.asyncRead", parseAsyncRead);
     httpAddConfig("http.attach", parseAttach);
     httpAddConfig("http.auth", parseAuth);
     httpAddConfig("http.auth.auto", httpParseAll);
@@ -1960,6 +2126,7 @@ PUBLIC int httpInitParser()
     httpAddConfig("http.cgi", httpParseAll);
     httpAddConfig("http.cgi.escape", parseCgiEscape);
     httpAddConfig("http.cgi.prefix", parseCgiPrefix);
+    httpAddConfig("http.combineRoutes", parseCombineRoutes);
     httpAddConfig("http.compress", parseCompress);
     httpAddConfig("http.conditions", parseConditions);
     httpAddConfig("http.database", parseDatabase);
@@ -1980,8 +2147,11 @@ PUBLIC int httpInitParser()
     httpAddConfig("http.indexes", parseIndexes);
     httpAddConfig("http.languages", parseLanguages);
     httpAddConfig("http.limits", parseLimits);
+    httpAddConfig("http.limits.arena", parseLimitsArena);
     httpAddConfig("http.limits.cache", parseLimitsCache);
+    httpAddConfig("http.limits.cacheDisk", parseLimitsCacheDisk);
     httpAddConfig("http.limits.cacheItem", parseLimitsCacheItem);
+    httpAddConfig("http.limits.cacheVariants", parseLimitsCacheVariants);
     httpAddConfig("http.limits.chunk", parseLimitsChunk);
     httpAddConfig("http.limits.clients", parseLimitsClients);
     httpAddConfig("http.limits.connections", parseLimitsConnections);
@@ -1994,6 +2164,7 @@ PUBLIC int httpInitParser()
     httpAddConfig("http.limits.rxHeader", parseLimitsRxHeader);
     httpAddConfig("http.limits.packet", parseLimitsPacket);
     httpAddConfig("http.limits.processes", parseLimitsProcesses);
+    httpAddConfig("http.limits.ranges", parseLimitsRanges);
     httpAddConfig("http.limits.requests", parseLimitsRequests);
     httpAddConfig("http.limits.sessions", parseLimitsSessions);
     httpAddConfig("http.limits.txBody", parseLimitsTxBody);
@@ -2012,6 +2183,7 @@ PUBLIC int httpInitParser()
     httpAddConfig("http.pipeline.handlers", parsePipelineHandlers);
     httpAddConfig("http.profile", parseProfile);
     httpAddConfig("http.prefix", parsePrefix);
+    httpAddConfig("http.rate", parseRate);
     httpAddConfig("http.redirect", parseRedirect);
     httpAddConfig("http.renameUploads", parseRenameUploads);
     httpAddConfig("http.routes", parseRoutes);
@@ -2019,10 +2191,14 @@ PUBLIC int httpInitParser()
     httpAddConfig("http.scheme", parseScheme);
     httpAddConfig("http.server", httpParseAll);
     httpAddConfig("http.server.account", parseServerAccount);
+    httpAddConfig("http.server.affinity", parseServerAffinity);
+    httpAddConfig("http.server.counters", parseServerCounters);
     httpAddConfig("http.server.defenses", parseServerDefenses);
     httpAddConfig("http.server.listen", parseServerListen);
     httpAddConfig("http.server.modules", parseServerModules);
     httpAddConfig("http.server.monitors", parseServerMonitors);
+    httpAddConfig("http.server.prefork", parseServerPrefork);
+    httpAddConfig("http.server.rates", parseServerRates);
     httpAddConfig("http.showErrors", parseShowErrors);
     httpAddConfig("http.source", parseSource);
     httpAddConfig("http.ssl", parseSsl);
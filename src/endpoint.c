@@ -153,8 +153,11 @@ PUBLIC int httpStartEndpoint(HttpEndpoint *endpoint)
     if ((endpoint->sock = mprCreateSocket()) == 0) {
         return MPR_ERR_MEMORY;
     }
+    /*
+        Prefork workers each listen on the endpoint and the kernel balances connections over them
+     */
     if (mprListenOnSocket(endpoint->sock, endpoint->ip, endpoint->port,
-                MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD) == SOCKET_ERROR) {
+                MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD | (HTTP->preforkWorker ? MPR_SOCKET_REUSEPORT : 0)) == SOCKET_ERROR) {
         if (mprGetError() == EADDRINUSE) {
             mprLog("error http", 0, "Cannot open a socket on %s:%d, socket already bound.",
                 *endpoint->ip ? endpoint->ip : "*", endpoint->port);
@@ -219,6 +222,10 @@ static void acceptNet(HttpEndpoint *endpoint)
     wp = endpoint->sock->handler;
     if (wp->flags & MPR_WAIT_NEW_DISPATCHER) {
         dispatcher = mprCreateDispatcher("IO", MPR_DISPATCHER_AUTO);
+        /*
+            Keep the connection on the core that receives its packets
+         */
+        mprSetDispatcherCpu(dispatcher, mprGetSocketCpu(sock));
     } else if (wp->dispatcher) {
         dispatcher = wp->dispatcher;
     } else {
@@ -2,7 +2,9 @@
     fileHandler.c -- Static file content handler
 
     This handler manages static file based content such as HTML, GIF /or JPEG pages. It supports all methods including:
-    GET, PUT, DELETE, OPTIONS and TRACE. It is event based and does not use worker threads.
+    GET, PUT, DELETE, OPTIONS and TRACE. It is event based and does not use worker threads. Routes may enable
+    asynchronous reads (HTTP_ROUTE_ASYNC_READ) in which case file content is read by a small pool of file reader
+    threads so slow disks do not stall the stream dispatcher.
 
     The fileHandler also manages requests for directories that require redirection to an index or responding with
     a directory listing.
@@ -14,17 +16,60 @@
 
 #include    "http.h"
 
+/********************************** Locals ************************************/
+
+#define FILE_READ_IDLE      0           /* No read outstanding */
+#define FILE_READ_BUSY      1           /* Read queued or in progress on a reader thread */
+#define FILE_READ_DONE      2           /* Read complete and data waiting to be sent */
+
+/*
+    Asynchronous read state for a request. Stored in the handler output queue->queueData.
+ */
+typedef struct FileRead {
+    HttpQueue       *q;                 /* Handler output queue */
+    HttpTx          *tx;                /* Transmitter for the request that issued the read */
+    MprFile         *file;              /* File to read */
+    HttpPacket      *data;              /* Data packet being filled */
+    MprOff          pos;                /* File position to read from */
+    ssize           size;               /* Bytes to read */
+    ssize           nbytes;             /* Bytes read or negative MPR error code */
+    MprTicks        started;            /* When the read was requested */
+    uint64          seqno;              /* Stream sequence number for httpCreateEvent */
+    int             state;              /* FILE_READ_IDLE, FILE_READ_BUSY or FILE_READ_DONE */
+    int             closed;             /* Handler has been closed */
+    int             deferClose;         /* Handler closed during a read. Close the file when the read completes */
+} FileRead;
+
+/*
+    Pool of file reader threads shared by all requests. Stored in the handler stageData.
+ */
+typedef struct FileReaders {
+    MprList         *active;            /* Reads in progress or awaiting completion. Retained for GC */
+    MprList         *pending;           /* Reads waiting for a reader thread */
+    MprList         *conds;             /* Wakeup conditions for each reader thread */
+    MprList         *idle;              /* Wakeup conditions for idle reader threads */
+    MprMutex        *mutex;             /* Multithread sync */
+    uint64          reads;              /* Total reads completed */
+    uint64          latency[HTTP_READ_LATENCY_BUCKETS];   /* Read latency histogram in log2 msec buckets */
+} FileReaders;
+
 /***************************** Forward Declarations ***************************/
 
 static void closeFileHandler(HttpQueue *q);
+static void fileReaderMain(FileReaders *readers, MprThread *tp);
+static void fileReadComplete(HttpStream *stream, FileRead *fr);
 static void handleDeleteRequest(HttpQueue *q);
 static void handlePutRequest(HttpQueue *q);
 static void incomingFile(HttpQueue *q, HttpPacket *packet);
+static void manageFileRead(FileRead *fr, int flags);
+static void manageFileReaders(FileReaders *readers, int flags);
 static int openFileHandler(HttpQueue *q);
 static void outgoingFileService(HttpQueue *q);
+static HttpPacket *readFileAsync(HttpQueue *q, HttpPacket *packet, ssize size, ssize *nbytes);
 static ssize readFileData(HttpQueue *q, HttpPacket *packet, MprOff pos, ssize size);
 static void readyFileHandler(HttpQueue *q);
 static int rewriteFileHandler(HttpStream *stream);
+static int startFileRead(FileRead *fr, MprOff pos, ssize size);
 static void startFileHandler(HttpQueue *q);
 
 /*********************************** Code *************************************/
@@ -34,6 +79,7 @@ static void startFileHandler(HttpQueue *q);
 PUBLIC int httpOpenFileHandler()
 {
     HttpStage     *handler;
+    FileReaders   *readers;
 
     /*
         This handler serves requests without using thread workers.
@@ -48,10 +94,43 @@ PUBLIC int httpOpenFileHandler()
     handler->ready = readyFileHandler;
     handler->outgoingService = outgoingFileService;
     handler->incoming = incomingFile;
+
+    if ((readers = mprAllocObj(FileReaders, manageFileReaders)) == 0) {
+        return MPR_ERR_MEMORY;
+    }
+    readers->active = mprCreateList(0, 0);
+    readers->pending = mprCreateList(0, 0);
+    readers->conds = mprCreateList(0, 0);
+    readers->idle = mprCreateList(0, 0);
+    readers->mutex = mprCreateLock();
+    handler->stageData = readers;
     HTTP->fileHandler = handler;
     return 0;
 }
 
+
+static void manageFileReaders(FileReaders *readers, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(readers->active);
+        mprMark(readers->pending);
+        mprMark(readers->conds);
+        mprMark(readers->idle);
+        mprMark(readers->mutex);
+    }
+}
+
+
+static void manageFileRead(FileRead *fr, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(fr->q);
+        mprMark(fr->tx);
+        mprMark(fr->file);
+        mprMark(fr->data);
+    }
+}
+
 /*
     Rewrite the request for directories, indexes and compressed content.
  */
@@ -180,11 +259,27 @@ static int openFileHandler(HttpQueue *q)
  */
 static void closeFileHandler(HttpQueue *q)
 {
-    HttpTx  *tx;
+    HttpTx      *tx;
+    FileRead    *fr;
+    FileReaders *readers;
+    bool        busy;
 
     tx = q->stream->tx;
+    busy = 0;
+    if ((fr = q->queueData) != 0 && !(q->stream->rx->flags & HTTP_PUT)) {
+        /*
+            The file cannot be closed while a reader thread is using it. Defer to fileReadComplete.
+         */
+        readers = q->stage->stageData;
+        lock(readers);
+        fr->closed = 1;
+        busy = fr->deferClose = (fr->state == FILE_READ_BUSY);
+        unlock(readers);
+    }
     if (tx->file) {
-        mprCloseFile(tx->file);
+        if (!busy) {
+            mprCloseFile(tx->file);
+        }
         tx->file = 0;
     }
 }
@@ -303,12 +398,20 @@ static void outgoingFileService(HttpQueue *q)
         When EOF, and END packet will be added to the queue via httpFinalizeOutput which will then be sent.
      */
     for (packet = q->first; packet; packet = q->first) {
-        if (packet->fill) {
+        if (packet->fill && !(tx->outputRanges && q->nextQ->stage == stream->http->rangeFilter)) {
             size = min(packet->esize, q->packetSize);
             size = min(size, q->nextQ->packetSize);
             if (size > 0) {
-                data = httpCreateDataPacket(size);
-                if ((nbytes = readFileData(q, data, q->ioPos, size)) < 0) {
+                if (rx->route->flags & HTTP_ROUTE_ASYNC_READ) {
+                    if ((data = readFileAsync(q, packet, size, &nbytes)) == 0) {
+                        /* Read in progress. The queue is rescheduled when the read completes */
+                        return;
+                    }
+                } else {
+                    data = httpCreateDataPacket(size);
+                    nbytes = readFileData(q, data, q->ioPos, size);
+                }
+                if (nbytes < 0) {
                     httpError(stream, HTTP_CODE_NOT_FOUND, "Cannot read document");
                     return;
                 }
@@ -330,7 +433,10 @@ static void outgoingFileService(HttpQueue *q)
                 httpGetPacket(q);
             }
         } else {
-            /* Don't flow control as the packet is already consuming memory */
+            /*
+                Don't flow control as the packet is already consuming memory. Entity packets for ranged requests
+                are passed to the rangeFilter which reads only the selected ranges.
+             */
             packet = httpGetPacket(q);
             httpPutPacketToNext(q, packet);
         }
@@ -344,6 +450,195 @@ static void outgoingFileService(HttpQueue *q)
 }
 
 
+/*
+    Return the data packet from a completed asynchronous read. If no read has completed, start one and return null.
+    The queue will be rescheduled when the read completes. After taking the data, the next block is read ahead.
+ */
+static HttpPacket *readFileAsync(HttpQueue *q, HttpPacket *packet, ssize size, ssize *nbytes)
+{
+    FileRead    *fr;
+    FileReaders *readers;
+    HttpPacket  *data;
+    MprOff      remaining;
+    int         state;
+
+    readers = q->stage->stageData;
+    if ((fr = q->queueData) == 0) {
+        if ((fr = mprAllocObj(FileRead, manageFileRead)) == 0) {
+            *nbytes = MPR_ERR_MEMORY;
+            return httpCreateDataPacket(0);
+        }
+        fr->q = q;
+        fr->tx = q->stream->tx;
+        fr->file = q->stream->tx->file;
+        fr->seqno = q->stream->seqno;
+        q->queueData = fr;
+    }
+    lock(readers);
+    state = fr->state;
+    unlock(readers);
+
+    if (state == FILE_READ_BUSY) {
+        return 0;
+    }
+    if (state == FILE_READ_IDLE) {
+        if (startFileRead(fr, q->ioPos, size) == 0) {
+            return 0;
+        }
+        /* Cannot start a reader thread, so read synchronously */
+        data = httpCreateDataPacket(size);
+        *nbytes = readFileData(q, data, q->ioPos, size);
+        return data;
+    }
+    data = fr->data;
+    *nbytes = fr->nbytes;
+    fr->data = 0;
+    fr->state = FILE_READ_IDLE;
+
+    if (*nbytes >= 0 && (remaining = packet->esize - *nbytes) > 0) {
+        startFileRead(fr, q->ioPos + *nbytes, (ssize) min(remaining, size));
+    }
+    return data;
+}
+
+
+/*
+    Queue a read for a reader thread. Returns zero if the read was queued.
+ */
+static int startFileRead(FileRead *fr, MprOff pos, ssize size)
+{
+    FileReaders *readers;
+    MprThread   *tp;
+    MprCond     *cond;
+
+    readers = fr->q->stage->stageData;
+    if (fr->closed || !fr->file) {
+        return MPR_ERR_BAD_STATE;
+    }
+    fr->data = httpCreateDataPacket(size);
+    fr->pos = pos;
+    fr->size = size;
+    fr->nbytes = 0;
+    fr->started = mprGetTicks();
+
+    lock(readers);
+    if ((cond = mprPopItem(readers->idle)) == 0 && mprGetListLength(readers->conds) < ME_MAX_FILE_READERS) {
+        if ((tp = mprCreateThread("fileReader", fileReaderMain, readers, 0)) == 0 || mprStartThread(tp) < 0) {
+            unlock(readers);
+            fr->data = 0;
+            return MPR_ERR_CANT_CREATE;
+        }
+    }
+    fr->state = FILE_READ_BUSY;
+    mprAddItem(readers->active, fr);
+    mprAddItem(readers->pending, fr);
+    unlock(readers);
+    if (cond) {
+        mprSignalCond(cond);
+    }
+    return 0;
+}
+
+
+/*
+    Reader thread main. Reads are done while yielded so GC is not blocked by slow disk I/O. The FileRead is retained
+    via readers->active until fileReadComplete runs on the stream dispatcher.
+ */
+static void fileReaderMain(FileReaders *readers, MprThread *tp)
+{
+    FileRead    *fr;
+    MprCond     *cond;
+    MprTicks    elapsed;
+    ssize       nbytes;
+    int         bucket;
+
+    cond = mprCreateCond();
+    lock(readers);
+    mprAddItem(readers->conds, cond);
+
+    while (!mprIsStopping()) {
+        if ((fr = mprGetFirstItem(readers->pending)) == 0) {
+            mprAddItem(readers->idle, cond);
+            unlock(readers);
+            mprYield(MPR_YIELD_STICKY);
+            mprWaitForCond(cond, -1);
+            mprResetYield();
+            lock(readers);
+            continue;
+        }
+        mprRemoveItemAtPos(readers->pending, 0);
+        unlock(readers);
+
+        mprYield(MPR_YIELD_STICKY);
+        nbytes = MPR_ERR_CANT_READ;
+        if (mprSeekFile(fr->file, SEEK_SET, fr->pos) == fr->pos &&
+                mprReadFile(fr->file, mprGetBufStart(fr->data->content), fr->size) == fr->size) {
+            mprAdjustBufEnd(fr->data->content, fr->size);
+            nbytes = fr->size;
+        }
+        mprResetYield();
+
+        elapsed = mprGetElapsedTicks(fr->started);
+        for (bucket = 0; bucket < HTTP_READ_LATENCY_BUCKETS - 1 && elapsed >= (1 << bucket); bucket++) ;
+
+        lock(readers);
+        fr->nbytes = nbytes;
+        fr->state = FILE_READ_DONE;
+        readers->latency[bucket]++;
+        readers->reads++;
+        unlock(readers);
+
+        /*
+            The callback is always invoked, with a null stream if the stream has been destroyed
+         */
+        httpCreateEvent(fr->seqno, (HttpEventProc) fileReadComplete, fr);
+        lock(readers);
+    }
+    unlock(readers);
+}
+
+
+/*
+    Read completion. This runs on the stream dispatcher.
+ */
+static void fileReadComplete(HttpStream *stream, FileRead *fr)
+{
+    FileReaders *readers;
+
+    readers = HTTP->fileHandler->stageData;
+    lock(readers);
+    mprRemoveItem(readers->active, fr);
+    unlock(readers);
+
+    if (fr->deferClose) {
+        mprCloseFile(fr->file);
+        fr->deferClose = 0;
+    }
+    if (fr->closed || !stream || stream->tx != fr->tx) {
+        return;
+    }
+    httpScheduleQueue(fr->q);
+    httpProcess(stream->inputq);
+}
+
+
+/*
+    Get the file reader statistics
+ */
+PUBLIC void httpGetFileReadStats(HttpStats *sp)
+{
+    FileReaders *readers;
+
+    if (!HTTP->fileHandler || (readers = HTTP->fileHandler->stageData) == 0) {
+        return;
+    }
+    lock(readers);
+    sp->fileReads = readers->reads;
+    memcpy(sp->fileReadLatency, readers->latency, sizeof(sp->fileReadLatency));
+    unlock(readers);
+}
+
+
 /*
     The incoming callback is invoked to receive body data
  */
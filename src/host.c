@@ -58,7 +58,7 @@ PUBLIC HttpHost *httpCloneHost(HttpHost *parent)
         Do not clone routes, ip, port and name
      */
     host->parent = parent;
-    host->flags = parent->flags & HTTP_HOST_NO_TRACE;
+    host->flags = parent->flags & (HTTP_HOST_NO_TRACE | HTTP_HOST_COMBINE_ROUTES);
     host->streaming = parent->streaming;
     host->routes = mprCreateList(-1, MPR_LIST_STABLE);
     return host;
@@ -74,6 +74,7 @@ static void manageHost(HttpHost *host, int flags)
         mprMark(host->parent);
         mprMark(host->responseCache);
         mprMark(host->routes);
+        mprMark(host->routeIndex);
         mprMark(host->defaultRoute);
         mprMark(host->defaultEndpoint);
         mprMark(host->secureEndpoint);
@@ -261,6 +262,16 @@ PUBLIC int httpSetHostCanonicalName(HttpHost *host, cchar *name)
 }
 
 
+PUBLIC void httpSetHostCombineRoutes(HttpHost *host, bool on)
+{
+    host->flags &= ~HTTP_HOST_COMBINE_ROUTES;
+    if (on) {
+        host->flags |= HTTP_HOST_COMBINE_ROUTES;
+    }
+    HTTP->routeVersion++;
+}
+
+
 PUBLIC int httpSetHostName(HttpHost *host, cchar *name)
 {
     cchar   *errMsg;
@@ -332,6 +343,7 @@ PUBLIC int httpAddRoute(HttpHost *host, HttpRoute *route)
         }
     }
     httpSetRouteHost(route, host);
+    HTTP->routeVersion++;
     return 0;
 }
 
@@ -363,6 +375,7 @@ PUBLIC HttpRoute *httpLookupRoute(HttpHost *host, cchar *pattern)
 PUBLIC void httpResetRoutes(HttpHost *host)
 {
     host->routes = mprCreateList(-1, MPR_LIST_STABLE);
+    HTTP->routeVersion++;
 }
 
 
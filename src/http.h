@@ -104,6 +104,12 @@ struct HttpWebSocket;
 #ifndef ME_HTTP_DELAY
     #define ME_HTTP_DELAY           (2000)               /**< 2 second delay per request - while delay enforced */
 #endif
+#ifndef ME_HTTP_SHARED_CLIENTS
+    #define ME_HTTP_SHARED_CLIENTS  4096                 /**< Default client slots in the shared counter segment */
+#endif
+#ifndef ME_HTTP_ADDRESS_SHARDS
+    #define ME_HTTP_ADDRESS_SHARDS  16                   /**< Writer locks for the client address table. Power of 2 */
+#endif
 #ifndef ME_MAX_URI
     #define ME_MAX_URI              512                  /**< Reasonable URI size */
 #endif
@@ -113,9 +119,15 @@ struct HttpWebSocket;
 #ifndef ME_MAX_CLIENTS_HASH
     #define ME_MAX_CLIENTS_HASH     131                  /**< Hash table for client IP addresses */
 #endif
+#ifndef ME_MAX_ARENA
+    #define ME_MAX_ARENA            0                    /**< Request arena chunk size. Zero to disable arenas */
+#endif
 #ifndef  ME_MAX_CACHE_ITEM
     #define ME_MAX_CACHE_ITEM       (256 * 1024)         /**< Maximum cachable item size */
 #endif
+#ifndef ME_MAX_CACHE_VARIANTS
+    #define ME_MAX_CACHE_VARIANTS   8                    /**< Maximum cached response variants per URI */
+#endif
 #ifndef ME_MAX_CHUNK
     #define ME_MAX_CHUNK            (8 * 1024)           /**< Maximum chunk size for transfer chunk encoding */
 #endif
@@ -155,12 +167,21 @@ struct HttpWebSocket;
 #ifndef ME_MAX_REQUESTS_PER_CLIENT
     #define ME_MAX_REQUESTS_PER_CLIENT 20               /**< Maximum concurrent requests per client */
 #endif
+#ifndef ME_MAX_RANGES
+    #define ME_MAX_RANGES           16                   /**< Maximum byte ranges in a Range request header */
+#endif
 #ifndef ME_MAX_REWRITE
     #define ME_MAX_REWRITE          20                   /**< Maximum URI rewrites */
 #endif
 #ifndef ME_MAX_ROUTE_MATCHES
     #define ME_MAX_ROUTE_MATCHES    32                   /**< Maximum number of submatches in routes */
 #endif
+#ifndef ME_MAX_ROUTE_CACHE
+    #define ME_MAX_ROUTE_CACHE      1024                 /**< Maximum cached route selections per host. Zero to disable. */
+#endif
+#ifndef ME_MAX_HEADER_PREFIXES
+    #define ME_MAX_HEADER_PREFIXES  16                   /**< Cached response header prefixes per route. Zero to disable. */
+#endif
 #ifndef ME_MAX_ROUTE_MAP_HASH
     #define ME_MAX_ROUTE_MAP_HASH   17                   /**< Size of the route mapping hash */
 #endif
@@ -191,6 +212,12 @@ struct HttpWebSocket;
 #ifndef ME_MAX_CACHE_DURATION
     #define ME_MAX_CACHE_DURATION   (86400 * 1000)       /**< Default cache lifespan to 1 day */
 #endif
+#ifndef ME_MAX_CACHE_SEGMENT
+    #define ME_MAX_CACHE_SEGMENT    (16 * 1024 * 1024)   /**< Maximum size of a disk cache segment file */
+#endif
+#ifndef ME_MAX_FILE_READERS
+    #define ME_MAX_FILE_READERS     4                    /**< Maximum threads for asynchronous file reads */
+#endif
 #ifndef ME_MAX_INACTIVITY_DURATION
     #define ME_MAX_INACTIVITY_DURATION (30  * 1000)     /**< Default keep alive between requests timeout (30 sec) */
 #endif
@@ -225,6 +252,7 @@ struct HttpWebSocket;
 #define HTTP_MAX_SECRET               16                  /**< Size of secret data for auth */
 #define HTTP_SMALL_HASH_SIZE          31                  /* Small hash (less than the alphabet) */
 #define HTTP_TIMER_PERIOD             1000                /**< HttpTimer checks ever 1 second */
+#define HTTP_TIMER_SLOTS              64                  /**< Timeout wheel slots (each of HTTP_TIMER_PERIOD) */
 
 #define HTTP_PACKET_ALIGN(x)          (((x) + 0x3FF) & ~0x3FF)
 
@@ -266,6 +294,7 @@ struct HttpWebSocket;
 #define HTTP_CODE_EXPECTATION_FAILED        417     /**< The server cannot satisfy the Expect header requirements */
 #define HTTP_CODE_IM_A_TEAPOT               418     /**< Short and stout error code (RFC 2324) */
 #define HTTP_CODE_UNPROCESSABLE             422     /**< The request was well-formed but was unable process */
+#define HTTP_CODE_TOO_MANY_REQUESTS         429     /**< The client has sent too many requests in a given time */
 #define HTTP_CODE_NO_RESPONSE               444     /**< The connection was closed with no response to the client */
 #define HTTP_CODE_INTERNAL_SERVER_ERROR     500     /**< Server processing or configuration error. No response generated */
 #define HTTP_CODE_NOT_IMPLEMENTED           501     /**< The server does not recognize the request or method */
@@ -411,10 +440,16 @@ typedef struct HttpMonitor {
 
 /**
     Per-IP address structure
+    @description Addresses are linked into the client address table and the counters are allocated once when
+        the address is created.
     @ingroup HttpMonitor HttpMonitor
     @stability Internal
  */
 typedef struct HttpAddress {
+    struct HttpAddress * volatile next;         /**< Next address in the hash chain (not marked) */
+    cchar       *ip;                            /**< Client IP address */
+    uint        hash;                           /**< Hash of the IP address */
+    volatile int retired;                       /**< Address has been pruned from the table */
     MprTicks    updated;                        /**< When the address counters were last updated */
     MprTicks    banUntil;                       /**< Ban IP address until this time */
     MprTicks    delayUntil;                     /**< Delay (go-slow) servicing requests until this time  */
@@ -423,9 +458,98 @@ typedef struct HttpAddress {
     int         delay;                          /**< Delay per request */
     int         ncounters;                      /**< Number of counters in ncounters */
     int         seqno;                          /**< Unique client sequence number */
+    volatile int64 connectionTat;               /**< Connection rate theoretical arrival time (usec) */
+    volatile int64 requestTat;                  /**< Request rate theoretical arrival time (usec) */
+    struct HttpSharedClient *shared;            /**< Client slot in the shared counter segment (not marked) */
+    void        *sharedKey;                     /**< Key of the shared slot when it was bound to this address */
     HttpCounter counters[1];                    /**< Counters allocated here */
 } HttpAddress;
 
+/**
+    Token bucket rate limit
+    @description Rates are checked inline in constant time using the generic cell rate algorithm which is equivalent
+        to a token bucket holding "burst" tokens that refills at "rate" tokens per second. The bucket state for a rate
+        is a single theoretical arrival time (TAT). Per-client state is kept in the HttpAddress. The tat field is the
+        state for a route rate that applies over all clients. Concurrent updates to the same state may race and admit
+        a request beyond the limit. This is tolerated.
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+typedef struct HttpRate {
+    int64       interval;                       /**< Time to earn one token (usec) */
+    int64       window;                         /**< Burst window. The burst size times the interval (usec) */
+    MprTicks    defer;                          /**< Maximum time to defer accepting a connection. Zero to refuse */
+    int         status;                         /**< Response status when the rate is exceeded. Zero to close */
+    volatile int64 tat;                         /**< Theoretical arrival time for a route rate (usec) */
+} HttpRate;
+
+/**
+    Client address table
+    @description Hash table of HttpAddress chains. Lookups do not lock and may run concurrently with inserts and
+        pruning. Writers lock the shard for the bucket. Pruned addresses are unlinked and retained for one prune
+        epoch before they may be collected so that concurrent lookups never see a freed address. Iterators that
+        may yield must hold their current address.
+    @ingroup HttpMonitor
+    @stability Internal
+ */
+typedef struct HttpAddresses {
+    HttpAddress * volatile *buckets;            /**< Hash buckets (not marked) */
+    MprMutex    *shards[ME_HTTP_ADDRESS_SHARDS];/**< Writer locks. Shard is the bucket index modulo shards */
+    MprList     *retired;                       /**< Addresses pruned in the current epoch */
+    MprMutex    *mutex;                         /**< Serialize pruning */
+    volatile int64 count;                       /**< Number of addresses in the table */
+    int64       epoch;                          /**< Prune epoch */
+    uint        mask;                           /**< Bucket mask. Buckets are a power of two */
+} HttpAddresses;
+
+#define HTTP_SHARED_MAGIC       0x48545043      /**< Shared counter segment magic ("HTPC") */
+#define HTTP_SHARED_VERSION     1               /**< Shared counter segment layout version */
+#define HTTP_SHARED_COUNTERS    16              /**< Counters per client in the shared segment */
+#define HTTP_SHARED_IP          48              /**< Size of the client IP field including the null */
+#define HTTP_SHARED_TOMBSTONE   ((void*) 1)     /**< Key of a pruned client slot */
+
+/**
+    Client slot in the shared counter segment
+    @description Slots are in an open-addressed table keyed by a hash of the client IP. A key of zero is an empty
+        slot and HTTP_SHARED_TOMBSTONE is a pruned slot. Slots are claimed by an atomic compare and swap on the key.
+        The ip is valid once ready is set. Times are in MprTicks (monotonic msec).
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+typedef struct HttpSharedClient {
+    void * volatile key;                        /**< Hash of the client IP (pointer sized) */
+    volatile int    ready;                      /**< Set when the ip field is valid */
+    volatile int    banStatus;                  /**< Ban response status */
+    char            ip[HTTP_SHARED_IP];         /**< Client IP address */
+    volatile int64  updated;                    /**< When the counters were last updated */
+    volatile int64  banUntil;                   /**< Ban the client until this time */
+    volatile int64  delayUntil;                 /**< Delay servicing requests until this time */
+    volatile int64  delay;                      /**< Delay per request */
+    volatile int64  counters[HTTP_SHARED_COUNTERS]; /**< Counters indexed by HTTP_COUNTER_* */
+} HttpSharedClient;
+
+/**
+    Shared counter segment
+    @description Per-client and global monitor counters in a memory mapped file shared by all server processes.
+        The client table of HttpSharedClient slots immediately follows this header. Counters are updated with
+        atomic operations. External tools may map the file read-only to read the counters. Convert ticks to
+        wall clock time via: created + (ticks - createdTicks).
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+typedef struct HttpSharedCounters {
+    int             magic;                      /**< HTTP_SHARED_MAGIC once the segment is initialized */
+    int             version;                    /**< HTTP_SHARED_VERSION */
+    int             clients;                    /**< Number of client slots. Power of two */
+    int             ncounters;                  /**< HTTP_SHARED_COUNTERS */
+    int64           size;                       /**< Total segment size in bytes */
+    int64           created;                    /**< Time the segment was created (MprTime) */
+    int64           createdTicks;               /**< Ticks when the segment was created (MprTicks) */
+    int64           owner;                      /**< Process ID of the process that checks monitors */
+    volatile int64  active;                     /**< Number of client slots in use */
+    volatile int64  counters[HTTP_SHARED_COUNTERS]; /**< Global counters summed over all clients */
+} HttpSharedCounters;
+
 /**
     Defense remedy callback
     @param args Hash of configuration args for the callback
@@ -551,6 +675,64 @@ PUBLIC int httpBanClient(cchar *ip, MprTicks period, int status, cchar *msg);
   */
 PUBLIC void httpDumpCounters(void);
 
+/**
+    Check a request against the client and route rate limits
+    @description If a rate limit is exceeded, the request is failed with the rate status (default 429) and a
+        Retry-After header. This is called when routing requests.
+    @param stream HttpStream object
+    @return True if the request may proceed
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+PUBLIC bool httpCheckRequestRate(struct HttpStream *stream);
+
+/**
+    Take a token from a rate limit
+    @param rate Rate limit
+    @param tat Reference to the rate state. Use &rate->tat for a rate without per-client state.
+    @param now Current time in ticks
+    @param defer Maximum time a caller is willing to wait. If the wait is less than this, a token is reserved.
+    @return Zero if a token was taken. Otherwise, the time in ticks until a token is available. If this is less
+        than or equal to defer, the token has been reserved for that time.
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+PUBLIC MprTicks httpCheckRate(HttpRate *rate, volatile int64 *tat, MprTicks now, MprTicks defer);
+
+/**
+    Create a rate limit
+    @param rate Tokens earned per second
+    @param burst Maximum tokens in the bucket. Set to zero for the same as rate.
+    @param status HTTP status for limited requests. Set to zero to close connections without a response.
+    @param defer Maximum time to defer accepting connections. Set to zero to refuse connections immediately.
+    @return HttpRate object
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+PUBLIC HttpRate *httpCreateRate(int64 rate, int64 burst, int status, MprTicks defer);
+
+/**
+    Open the shared counter segment
+    @description Map a file of monitor counters shared by all server processes. When shared, monitor counters,
+        bans and delays apply across processes. Only the process that creates the segment checks monitors and invokes
+        defenses. This is the prefork master, or the server process when not using prefork.
+        Only supported on Unix.
+    @param path Filename for the segment
+    @param clients Number of client slots. Rounded up to a power of two.
+    @param create Set to true to create and initialize the segment. Otherwise, attach to an existing segment.
+    @return Zero if successful, otherwise a negative MPR error code.
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+PUBLIC int httpOpenSharedCounters(cchar *path, int clients, bool create);
+
+/**
+    Close the shared counter segment
+    @ingroup HttpMonitor
+    @stability Evolving
+ */
+PUBLIC void httpCloseSharedCounters(void);
+
 /*
     Internal
  */
@@ -561,6 +743,10 @@ PUBLIC uint64 httpGetNumber(cchar *value);
 PUBLIC int httpGetInt(cchar *value);
 PUBLIC void httpPruneMonitors(void);
 PUBLIC HttpAddress *httpMonitorAddress(struct HttpNet *net, int counterIndex);
+PUBLIC HttpAddresses *httpCreateAddresses(int buckets);
+PUBLIC HttpAddress *httpLookupAddress(cchar *ip);
+PUBLIC HttpAddress *httpGetNextAddress(HttpAddress *last);
+PUBLIC int httpGetAddressCount(void);
 
 /********************************** HttpTrace *********************************/
 
@@ -955,7 +1141,9 @@ typedef struct Http {
     MprHash         *parsers;               /**< Table config parser callbacks */
     MprHash         *stages;                /**< Possible stages in connection pipelines */
     MprCache        *sessionCache;          /**< Session state cache */
+    struct HttpDiskCache *diskCache;        /**< Persistent second tier for the response cache */
     MprHash         *statusCodes;           /**< Http status codes */
+    MprHash         *headerIds;             /**< Well-known header IDs by header name */
 
     MprHash         *routeSets;             /**< Http route sets functions */
     MprHash         *routeTargets;          /**< Http route target functions */
@@ -971,7 +1159,14 @@ typedef struct Http {
     MprList         *monitors;              /**< List of monitors */
     MprHash         *defenses;              /**< List of Defenses */
     MprHash         *remedies;              /**< List of Defense Remedies */
-    MprHash         *addresses;             /**< Monitored per-IP-address counters */
+    HttpAddresses   *addresses;             /**< Monitored per-IP-address counters */
+    HttpRate        *connectionRate;        /**< New connections per client rate limit */
+    HttpRate        *requestRate;           /**< Requests per client rate limit */
+    HttpSharedCounters *shared;             /**< Counters shared over server processes (not marked) */
+    cchar           *sharedPath;            /**< Filename for the shared counter segment */
+    int             sharedClients;          /**< Client slots for the shared counter segment */
+    int             sharedOwner;            /**< This process created the shared segment and checks monitors */
+    int             sharedFd;               /**< File descriptor for the shared counter segment */
 
     /*
         Some standard pipeline stages
@@ -1011,6 +1206,8 @@ typedef struct Http {
 
     MprEvent        *timer;                 /**< Admin service timer */
     MprEvent        *timestamp;             /**< Timestamp timer */
+    struct HttpNet  *timeouts[HTTP_TIMER_SLOTS]; /**< Timeout wheel of networks by deadline (not marked) */
+    int64           timeoutTick;            /**< Last timeout wheel tick (in HTTP_TIMER_PERIOD units) expired */
     MprTime         booted;                 /**< Time the server started */
     MprTicks        now;                    /**< Current time in ticks */
     MprMutex        *mutex;                 /**< Multithread sync */
@@ -1022,16 +1219,28 @@ typedef struct Http {
     int             monitorsStarted;        /**< Monitors are running */
     MprTicks        monitorPeriod;          /**< Minimum monitor period */
 
+    MprList         *preforkWorkers;        /**< Worker processes supervised by the prefork master */
+    MprEvent        *preforkTimer;          /**< Timer to detect the master exiting (in worker processes) */
+    int             prefork;                /**< Number of prefork worker processes to run */
+    int             preforkWorker;          /**< Index of this prefork worker process (1-based). Zero if not a worker */
+    int             preforkParent;          /**< Process ID of the prefork master (in worker processes) */
+    int             preforkRestart;         /**< Index of the worker in a rolling restart. Set to -1 if not restarting */
+    int64           preforkRespawns;        /**< Count of worker processes respawned by the master */
+
     int             nextAuth;               /**< Auth object version vector */
+    int             routeVersion;           /**< Route table version vector. Incremented when routes change */
     int             activeProcesses;        /**< Count of active external processes */
     uint64          totalConnections;       /**< Total connections accepted */
     uint64          totalRequests;          /**< Total requests served */
     uint64          totalStreams;           /**< Total streams created */
+    int64           routeCacheHits;         /**< Route selections served from the route cache */
+    int64           routeCacheMisses;       /**< Route cache lookups that required route matching */
 
     int             flags;                  /**< Open flags */
     void            *context;               /**< Embedding context */
-    MprTicks        currentTime;            /**< When currentDate was last calculated (ticks) */
+    MprTime         currentTime;            /**< When currentDate was last calculated (time) */
     char            *currentDate;           /**< Date string for HTTP response headers */
+    char            *dateHeader;            /**< Serialized "Date" response header line for currentDate */
     char            *secret;                /**< Random bytes for authentication */
 
     char            *defaultClientHost;     /**< Default ip address */
@@ -1197,6 +1406,13 @@ PUBLIC void httpGetUserGroup(void);
  */
 PUBLIC int httpInitParser(void);
 
+/**
+    Initialize the well-known header IDs
+    @ingroup Http
+    @stability Internal
+ */
+PUBLIC void httpInitHeaders(void);
+
 /**
     Lookup a Http status code
     @description Lookup the code and return the corresponding text message briefly expaining the status.
@@ -1330,6 +1546,24 @@ PUBLIC void httpSetProxy(cchar *host, int port);
  */
 PUBLIC void httpSetRedirectCallback(HttpRedirectCallback redirectCallback);
 
+/**
+    Run the server as a set of prefork worker processes
+    @description This starts the given number of worker processes and supervises them. Each worker re-executes
+        the application with the same command line and listens on its own endpoint sockets with SO_REUSEPORT so
+        the kernel balances new connections over the workers. Each worker has its own heap, GC and event service.
+        The master process does not listen on endpoints. It respawns workers that exit, forwards shutdown to the
+        workers and does a rolling restart of the workers on SIGHUP.
+        \n\n
+        Call after loading the configuration and before #httpStartEndpoints. Only supported on Unix.
+    @param count Number of worker processes. Set to zero to run as a single process.
+    @return The number of workers started in the master process. Returns zero in a worker process or when
+        running as a single process. In both cases the caller should then call #httpStartEndpoints.
+        Returns a negative MPR error code if the workers cannot be started.
+    @ingroup Http
+    @stability Evolving
+ */
+PUBLIC int httpPrefork(int count);
+
 /**
     Set the software description
     @param description String describing the Http software. By default, this is set to HTTP_NAME.
@@ -1353,6 +1587,7 @@ PUBLIC void httpAddStream(struct HttpNet *net, struct HttpStream *stream);
 PUBLIC void httpRemoveStream(struct HttpNet *net, struct HttpStream *stream);
 PUBLIC void httpAddNet(struct HttpNet *net);
 PUBLIC void httpRemoveNet(struct HttpNet *net);
+PUBLIC void httpUpdateDeadline(struct HttpStream *stream);
 PUBLIC struct HttpEndpoint *httpGetFirstEndpoint(void);
 PUBLIC void httpAddEndpoint(struct HttpEndpoint *endpoint);
 PUBLIC void httpRemoveEndpoint(struct HttpEndpoint *endpoint);
@@ -1363,6 +1598,8 @@ PUBLIC void httpSetInfoLevel(int level);
 PUBLIC void httpStopNetworks(void *data);
 
 /*********************************** HttpStats ********************************/
+#define HTTP_READ_LATENCY_BUCKETS   12      /**< Number of file read latency histogram buckets */
+
 /**
     HttpStats
     @defgroup HttpStats HttpStats
@@ -1385,6 +1622,15 @@ typedef struct HttpStats {
     int     workersIdle;                /**< Current idle worker threads */
     int     workersYielded;             /**< Number of busy workers that are yielded for GC */
     int     workersMax;                 /**< Maximum number of workers in the thread pool */
+    int     workersQueued;              /**< Current jobs queued waiting for a busy worker */
+    int     workersMaxQueued;           /**< Max jobs ever queued waiting for a busy worker */
+    int     workersQueueWait;           /**< Average msec a queued job waited for a worker */
+    int     workersQueueWaitMax;        /**< Max msec a queued job waited for a worker */
+    uint64  workersTotalQueued;         /**< Total jobs queued waiting for a busy worker */
+    uint64  workersRejected;            /**< Total jobs rejected with a full worker queue */
+
+    int     preforkWorkers;             /**< Running prefork worker processes (in the master) */
+    uint64  preforkRespawns;            /**< Total prefork worker processes respawned */
 
     int     activeClients;              /**< Current active client IPs */
     int     activeConnections;          /**< Current active connections */
@@ -1392,7 +1638,17 @@ typedef struct HttpStats {
     int     activeRequests;             /**< Current active requests */
     int     activeSessions;             /**< Current active sessions */
 
+    uint64  routeCacheHits;             /**< Route selections served from the route cache */
+    uint64  routeCacheMisses;           /**< Route cache lookups that required route matching */
+
+    uint64  fileReads;                  /**< Total asynchronous file reads */
+    uint64  fileReadLatency[HTTP_READ_LATENCY_BUCKETS]; /**< File read latency. Bucket N counts reads under 2^N msec */
+
     uint64  totalSweeps;                /**< Total GC sweeps */
+    uint64  gcPauses;                   /**< Total GC pauses where threads were stopped for marking */
+    uint64  gcPauseTotal;               /**< Total time threads were stopped for GC marking (usec) */
+    uint64  gcPauseMax;                 /**< Longest GC pause (usec) */
+    uint64  gcPauseHistogram[MPR_GC_PAUSE_BUCKETS]; /**< GC pauses. See MPR_GC_PAUSE_BUCKETS. The last bucket counts longer pauses */
     uint64  totalRequests;              /**< Total requests served */
     uint64  totalConnections;           /**< Total connections accepted */
     uint64  cpuUsage;                   /**< Total process CPU usage in ticks */
@@ -1427,7 +1683,9 @@ PUBLIC void httpGetStats(HttpStats *sp);
     @stability Internal
  */
 typedef struct HttpLimits {
+    ssize    arenaSize;                 /**< Request arena chunk size. Zero to disable request arenas */
     int      cacheItemSize;             /**< Maximum size of a cachable item */
+    int      cacheVariants;             /**< Maximum number of cached response variants (Vary) per URI */
     ssize    chunkSize;                 /**< Maximum chunk size for transfer encoding */
     int      clientMax;                 /**< Maximum number of unique clients IP addresses */
     int      connectionsMax;            /**< Maximum number of simultaneous client connections */
@@ -1437,6 +1695,7 @@ typedef struct HttpLimits {
     int      keepAliveMax;              /**< Maximum number of Keep-Alive requests to perform per socket */
     int      packetSize;                /**< Maximum packet size for queues and stages */
     int      processMax;                /**< Maximum number of processes (CGI) */
+    int      rangesMax;                 /**< Maximum number of byte ranges in a Range request header */
     int      requestMax;                /**< Maximum number of simultaneous concurrent requests */
     MprTicks requestTimeout;            /**< Time a request can take (msec) */
     MprTicks requestParseTimeout;       /**< Time a request can take to parse the request headers (msec) */
@@ -2910,6 +3169,7 @@ PUBLIC int httpOpenWebSockFilter(void);
 PUBLIC int httpSendOpen(HttpQueue *q);
 PUBLIC void httpSendOutgoingService(HttpQueue *q);
 PUBLIC int httpHandleDirectory(struct HttpStream *stream);
+PUBLIC void httpGetFileReadStats(HttpStats *sp);
 PUBLIC int httpOpenHttp1Filter(void);
 PUBLIC int httpOpenHttp2Filter(void);
 PUBLIC int httpOpenTailFilter(void);
@@ -3122,6 +3382,9 @@ typedef struct HttpNet {
     MprEvent        *timeoutEvent;          /**< Connection or request timeout event */
     MprEvent        *workerEvent;           /**< Event for running connection via a worker thread (used by ejs) */
     MprTicks        lastActivity;           /**< Last activity on the connection */
+    MprTicks        deadline;               /**< Earliest time the network or its streams may timeout */
+    struct HttpNet  *timeoutNext;           /**< Next network in the same timeout wheel slot */
+    struct HttpNet  *timeoutPrev;           /**< Previous network in the same timeout wheel slot */
     MprOff          bytesWritten;           /**< Total bytes written */
 
     void            *context;               /**< Embedding context (EjsRequest) */
@@ -3139,6 +3402,7 @@ typedef struct HttpNet {
     int             ownStreams;             /**< Number of peer created streams */
     int             session;                /**< Currently parsing frame for this session */
     int             timeout;                /**< Network timeout indication */
+    int             timeoutSlot;            /**< Timeout wheel slot plus one. Zero if not in the wheel */
     int             totalRequests;          /**< Total number of requests serviced */
 
     bool            async: 1;               /**< Network is in async mode (non-blocking) */
@@ -3558,6 +3822,7 @@ typedef struct HttpStream {
     HttpQueue       *readq;                 /**< Application queue to old incoming data for reading (qhead) */
     HttpQueue       *writeq;                /**< Application queue to write outgoing data (handler) */
 
+    MprArena        *arena;                 /**< Request scoped memory arena */
     MprSocket       *sock;                  /**< Underlying socket handle */
     HttpLimits      *limits;                /**< Service limits. Alias to HttpRoute.limits for this request */
     Http            *http;                  /**< Http service object  */
@@ -3635,6 +3900,44 @@ typedef struct HttpStream {
  */
 PUBLIC void httpAddEndInputPacket(HttpStream *stream, HttpQueue *q);
 
+/**
+    Allocate request scoped memory
+    @description Allocate a block from the stream arena. Arena memory is released in bulk when the stream is reset
+        for the next request on a keep-alive connection or when the stream is collected. This avoids garbage
+        collector overhead for short-lived request temporaries. If arenas are disabled via the
+        HttpLimits.arenaSize limit, the block is allocated from the garbage collected heap.
+        Arena memory must not be retained beyond the current request. Use #httpPromote to make a durable copy.
+    @param stream HttpStream object created via #httpCreateStream
+    @param size Size of the block to allocate
+    @return Allocated block.
+    @ingroup HttpStream
+    @stability Prototype
+ */
+PUBLIC void *httpArenaAlloc(HttpStream *stream, ssize size);
+
+/**
+    Clone a string into request scoped memory
+    @description See #httpArenaAlloc for the lifespan of arena memory.
+    @param stream HttpStream object created via #httpCreateStream
+    @param str String to clone
+    @return Cloned string
+    @ingroup HttpStream
+    @stability Prototype
+ */
+PUBLIC char *httpArenaClone(HttpStream *stream, cchar *str);
+
+/**
+    Promote request scoped memory
+    @description Values that must outlive the request, such as values stored in caches, sessions or module state,
+        must be promoted from the stream arena. If the block was not allocated from the arena, it is returned unchanged.
+    @param stream HttpStream object created via #httpCreateStream
+    @param ptr Block to promote
+    @return A block allocated from the garbage collected heap.
+    @ingroup HttpStream
+    @stability Prototype
+ */
+PUBLIC void *httpPromote(HttpStream *stream, cvoid *ptr);
+
 /**
     Emit an error message for a badly formatted request
     @param stream HttpStream stream object created via #httpCreateStream
@@ -4758,6 +5061,7 @@ typedef struct HttpLang {
 #define HTTP_CACHE_UNIQUE           0x10    /**< Uniquely cache request with different params */
 #define HTTP_CACHE_HAS_PARAMS       0x20    /**< Cache definition has params */
 #define HTTP_CACHE_STATIC           0x40    /**< Cache extensions: css, gif, ico, jpg, js, html, pdf, ttf, txt, xml, woff */
+#define HTTP_CACHE_DISK             0x80    /**< Also save server cached content in the persistent disk cache */
 
 /**
     Cache Control
@@ -4788,7 +5092,9 @@ typedef struct HttpCache {
     cached. Subsequent client requests will revalidate the cached content with the server. If the server-side cached
     content has not expired, a HTTP Not-Modified (304) response will be sent and the client will use its client-side
     cached content.  This results in a very fast transaction with the client as no response data is sent.
-    Server-side caching will cache both the response headers and content.
+    Server-side caching will cache both the response headers and content. If the response defines a 'Vary' header,
+    each distinct combination of the named request header values is cached as a separate variant. The number of
+    variants per URI is bounded by the 'cacheVariants' limit. Responses with 'Vary: *' are not cached.
     \n\n
     If manual server-side caching is requested, the response will be automatically cached, but subsequent requests will
     require the handler to explicitly send cached content by calling #httpWriteCached.
@@ -4843,6 +5149,8 @@ typedef struct HttpCache {
         Select HTTP_CACHE_SERVER to define the server-side caching mode.
         \n\n
         Select HTTP_CACHE_UNIQUE to uniquely cache requests with different request parameters.
+        \n\n
+        Select HTTP_CACHE_DISK to also save server cached content in the persistent disk cache. See #httpOpenDiskCache.
     @return A count of the bytes actually written
     @ingroup HttpCache
     @stability Evolving
@@ -4874,6 +5182,76 @@ PUBLIC ssize httpUpdateCache(HttpStream *stream, cchar *uri, cchar *data, MprTic
   */
 PUBLIC ssize httpWriteCached(HttpStream *stream);
 
+/******************************** HttpDiskCache ********************************/
+/**
+    Persistent disk cache
+    @description The disk cache is an optional second tier behind the in-memory response cache. Cached responses are
+        appended to memory mapped segment files in the cache directory. The index is rebuilt by scanning the segments
+        on startup, so cached content survives a restart. Content read from the disk cache is promoted into the
+        in-memory cache, while the in-memory cache may evict cold items that then remain on disk.
+        When the total size of the segments exceeds the disk budget, the oldest segment is discarded after copying
+        forward any unexpired items that have been read since they were written.
+    @defgroup HttpDiskCache HttpDiskCache
+    @see httpOpenDiskCache httpReadDiskCache httpRemoveDiskCache httpWriteDiskCache
+    @stability Internal
+ */
+typedef struct HttpDiskCache {
+    cchar       *dir;                       /**< Directory containing the segment files */
+    MprHash     *index;                     /**< Index of cached items by key */
+    MprList     *segments;                  /**< Segments in order of creation. The last is the active segment. */
+    MprMutex    *mutex;                     /**< Multithread sync */
+    MprOff      size;                       /**< Total size of all segments */
+    MprOff      maxSize;                    /**< Disk budget for all segments */
+    ssize       segmentSize;                /**< Maximum size of a segment */
+    int         nextSeq;                    /**< Sequence number for the next segment file */
+} HttpDiskCache;
+
+/**
+    Open the persistent disk cache
+    @description Open the disk cache in the given directory and load the index from any existing segment files.
+        The directory is created if required. The cache is used for routes with HTTP_CACHE_DISK caching.
+    @param dir Directory to hold the cache segment files
+    @param maxSize Maximum total size of the segment files in bytes
+    @return The disk cache object. Returns null if the directory cannot be created.
+    @ingroup HttpDiskCache
+    @stability Prototype
+ */
+PUBLIC HttpDiskCache *httpOpenDiskCache(cchar *dir, MprOff maxSize);
+
+/**
+    Read an item from the disk cache
+    @param cache Disk cache object
+    @param key Cache item key
+    @param modified Optional reference to receive the item last modified time
+    @param lifespan Optional reference to receive the remaining lifespan of the item
+    @return The cached data or null if not found or expired
+    @ingroup HttpDiskCache
+    @stability Prototype
+ */
+PUBLIC char *httpReadDiskCache(HttpDiskCache *cache, cchar *key, MprTime *modified, MprTicks *lifespan);
+
+/**
+    Remove an item from the disk cache
+    @param cache Disk cache object
+    @param key Cache item key
+    @ingroup HttpDiskCache
+    @stability Prototype
+ */
+PUBLIC void httpRemoveDiskCache(HttpDiskCache *cache, cchar *key);
+
+/**
+    Write an item to the disk cache
+    @param cache Disk cache object
+    @param key Cache item key
+    @param data Data to cache
+    @param modified Last modified time for the item
+    @param lifespan Lifespan for the item in milliseconds
+    @return Zero if successful, otherwise a negative MPR error code
+    @ingroup HttpDiskCache
+    @stability Prototype
+ */
+PUBLIC int httpWriteDiskCache(HttpDiskCache *cache, cchar *key, cchar *data, MprTime modified, MprTicks lifespan);
+
 /******************************** Action Handler *************************************/
 /**
     Action handler callback signature
@@ -4949,6 +5327,7 @@ PUBLIC void httpSetStreaming(struct HttpHost *host, cchar *mime, cchar *uri, boo
 #define HTTP_ROUTE_UTILITY              0x100000    /**< Route hosted by a utility */
 #define HTTP_ROUTE_LAX_COOKIE           0x200000    /**< Session cookie is SameSite=lax */
 #define HTTP_ROUTE_STRICT_COOKIE        0x400000    /**< Session cookie is SameSite=strict */
+#define HTTP_ROUTE_ASYNC_READ           0x800000    /**< Read static files via the file reader threads */
 
 /*
     Route hook types
@@ -4984,11 +5363,13 @@ typedef struct HttpRoute {
     char            *pattern;               /**< Original matching URI pattern for the route (includes prefix) */
     char            *startSegment;          /**< First starting literal segment of pattern */
     char            *startWith;             /**< Starting literal portion of pattern */
+    char            *literalPattern;        /**< Pattern without regular expression characters (matched without pcre) */
     char            *optimizedPattern;      /**< Processed pattern (excludes prefix) */
     char            *prefix;                /**< Application scriptName prefix. Set to '' for '/'. Always set */
     char            *tplate;                /**< URI template for forming links based on this route (includes prefix) */
     char            *targetRule;            /**< Target rule */
     char            *target;                /**< Route target details */
+    struct HttpRouteTemplate *targetTemplate; /**< Compiled route target tokens */
 
     cchar           *documents;             /**< Documents directory */
     cchar           *home;                  /**< Home directory for configuration files */
@@ -5001,6 +5382,7 @@ typedef struct HttpRoute {
     ssize           prefixLen;              /**< Prefix length */
     ssize           startWithLen;           /**< Length of startWith */
     ssize           startSegmentLen;        /**< Prefix length */
+    ssize           literalPatternLen;      /**< Length of literalPattern */
 
     MprJson         *config;                /**< Configuration file content */
     cchar           *mode;                  /**< Application run profile mode (debug|release) */
@@ -5015,6 +5397,7 @@ typedef struct HttpRoute {
     bool            error: 1;               /**< Parse or runtime error */
     bool            ignoreEncodingErrors: 1;/**< Ignore UTF8 encoding errors */
     bool            json: 1;                /**< Response format is json */
+    bool            literalExact: 1;        /**< The literalPattern must match the entire path */
 
     MprList         *caching;               /**< Items to cache */
     MprTicks        lifespan;               /**< Default lifespan for all cache items in route */
@@ -5040,6 +5423,7 @@ typedef struct HttpRoute {
     int             renameUploads;          /**< Rename uploaded files */
 
     HttpLimits      *limits;                /**< Host resource limits */
+    HttpRate        *rate;                  /**< Request rate limit over all clients. Shared with inheriting routes */
     MprHash         *mimeTypes;             /**< Hash table of mime types (key is extension) */
 
     HttpTrace       *trace;                 /**< Per-route tracing configuration */
@@ -5071,6 +5455,7 @@ typedef struct HttpRoute {
     cchar           *sourceName;            /**< Source name for route target */
     MprList         *tokens;                /**< Tokens in pattern, {name} */
     MprList         *headers;               /**< Response header values */
+    struct HttpHeaderPrefix **headerPrefixes; /**< Cache of pre-serialized response header prefixes */
 
     struct MprSsl   *ssl;                   /**< SSL configuration */
     char            *webSocketsProtocol;    /**< WebSockets sub-protocol */
@@ -5089,6 +5474,7 @@ typedef struct HttpRouteOp {
     char            *var;                   /**< Var to set */
     char            *value;                 /**< Value to assign to var */
     void            *mdata;                 /**< pcre_ data (unmanaged) */
+    struct HttpRouteTemplate *compiled;     /**< Compiled tokens of the details or value */
     int             flags;                  /**< Route flags to control freeing mdata */
 } HttpRouteOp;
 
@@ -5888,6 +6274,18 @@ PUBLIC void httpResetRoutePipeline(HttpRoute *route);
  */
 PUBLIC void httpSetDir(HttpRoute *route, cchar *name, cchar *value);
 
+/**
+    Control asynchronous file reads for a route
+    @description When enabled, the fileHandler reads static file content using a pool of file reader threads so that
+        slow disk reads do not block the stream dispatcher. The next block of the file is read ahead while the
+        current block is being written to the client.
+    @param route Route to modify
+    @param on Set to true to enable asynchronous file reads. Disabled by default.
+    @ingroup HttpRoute
+    @stability Prototype
+ */
+PUBLIC void httpSetRouteAsyncRead(HttpRoute *route, bool on);
+
 /**
     Set the route authentication
     @description This defines the authentication configuration for basic and digest authentication for the route.
@@ -6638,6 +7036,56 @@ typedef struct HttpUploadFile {
 #define HTTP_CHUNK_DATA       2             /**< Start of chunk data */
 #define HTTP_CHUNK_EOF        3             /**< End of last chunk */
 
+/*
+    Well-known header IDs. Received headers with these names are indexed when parsed. See httpGetHeaderById.
+ */
+#define HTTP_HEADER_ACCEPT              0
+#define HTTP_HEADER_ACCEPT_CHARSET      1
+#define HTTP_HEADER_ACCEPT_ENCODING     2
+#define HTTP_HEADER_ACCEPT_LANGUAGE     3
+#define HTTP_HEADER_AUTHORIZATION       4
+#define HTTP_HEADER_CACHE_CONTROL       5
+#define HTTP_HEADER_CONNECTION          6
+#define HTTP_HEADER_CONTENT_LENGTH      7
+#define HTTP_HEADER_CONTENT_RANGE       8
+#define HTTP_HEADER_CONTENT_TYPE        9
+#define HTTP_HEADER_COOKIE              10
+#define HTTP_HEADER_EXPECT              11
+#define HTTP_HEADER_HOST                12
+#define HTTP_HEADER_IF_MATCH            13
+#define HTTP_HEADER_IF_MODIFIED_SINCE   14
+#define HTTP_HEADER_IF_NONE_MATCH       15
+#define HTTP_HEADER_IF_RANGE            16
+#define HTTP_HEADER_IF_UNMODIFIED_SINCE 17
+#define HTTP_HEADER_KEEP_ALIVE          18
+#define HTTP_HEADER_LOCATION            19
+#define HTTP_HEADER_ORIGIN              20
+#define HTTP_HEADER_PRAGMA              21
+#define HTTP_HEADER_RANGE               22
+#define HTTP_HEADER_REFERER             23
+#define HTTP_HEADER_SEC_WEBSOCKET_ACCEPT 24
+#define HTTP_HEADER_SEC_WEBSOCKET_KEY   25
+#define HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL 26
+#define HTTP_HEADER_SEC_WEBSOCKET_VERSION 27
+#define HTTP_HEADER_SET_COOKIE          28
+#define HTTP_HEADER_TRANSFER_ENCODING   29
+#define HTTP_HEADER_UPGRADE             30
+#define HTTP_HEADER_USER_AGENT          31
+#define HTTP_HEADER_WWW_AUTHENTICATE    32
+#define HTTP_HEADER_X_HTTP_METHOD_OVERRIDE 33
+#define HTTP_HEADER_MAX                 34  /**< Number of well-known headers */
+
+/**
+    Received header field
+    @ingroup HttpRx
+    @stability Internal
+ */
+typedef struct HttpHeaderField {
+    cchar           *key;                   /**< Header name. Lower case name for well-known headers */
+    cchar           *value;                 /**< Header value */
+    int             id;                     /**< Well-known header ID or -1 */
+} HttpHeaderField;
+
 /**
     Http Rx
     @description Most of the APIs in the rx group still take a HttpStream object as their first parameter. This is
@@ -6671,14 +7119,18 @@ typedef struct HttpRx {
     MprList         *etags;                 /**< Document etag to uniquely identify the document version */
     MprList         *files;                 /**< List of uploaded files (HttpUploadFile objects) */
     HttpPacket      *headerPacket;          /**< HTTP headers */
-    MprHash         *headers;               /**< Header variables */
+    HttpHeaderField *fields;                /**< Received header fields in order of receipt */
+    MprHash         *headers;               /**< Header hash view of fields. Created on demand by httpGetHeaderHash */
     MprList         *inputPipeline;         /**< Input processing */
     HttpUri         *parsedUri;             /**< Parsed request uri */
     MprHash         *requestData;           /**< General request data storage. Set via #httpSetStageData */
     MprTime         since;                  /**< If-Modified date */
 
     int             chunkState;             /**< Chunk encoding state */
+    int             fieldCount;             /**< Number of header fields */
+    int             fieldMax;               /**< Allocated size of fields */
     int             flags;                  /**< Rx modifiers */
+    short           known[HTTP_HEADER_MAX]; /**< Index plus one of each well-known header in fields */
 
     bool            authenticateProbed: 1;  /**< Request has been authenticated */
     bool            authenticated: 1;       /**< Request has been authenticated */
@@ -6896,6 +7348,9 @@ PUBLIC cchar *httpGetParamsString(HttpStream *stream);
 /**
     Get an rx http header.
     @description Get a http request header value for a given header key.
+        When request arenas are enabled via HttpLimits.arenaSize, header values are request scoped and are recycled
+        when the stream is reset for the next request on a keep-alive connection. Use #httpPromote to retain a value
+        beyond the request.
     @param stream HttpStream stream object created via #httpCreateStream
     @param key Name of the header to retrieve.
     @return Value associated with the header key or null if the key did not exist in the request.
@@ -6904,9 +7359,36 @@ PUBLIC cchar *httpGetParamsString(HttpStream *stream);
  */
 PUBLIC cchar *httpGetHeader(HttpStream *stream, cchar *key);
 
+/**
+    Get a well-known rx http header.
+    @description This is a constant time lookup of a header that was indexed when the headers were parsed.
+        When request arenas are enabled via HttpLimits.arenaSize, header values are request scoped and are recycled
+        when the stream is reset for the next request on a keep-alive connection. Use #httpPromote to retain a value
+        beyond the request.
+    @param stream HttpStream stream object created via #httpCreateStream
+    @param id Well-known header ID. Set to HTTP_HEADER_ACCEPT ... HTTP_HEADER_X_HTTP_METHOD_OVERRIDE.
+    @return Value of the header. Returns null if not present.
+    @ingroup HttpRx
+    @stability Evolving
+ */
+PUBLIC cchar *httpGetHeaderById(HttpStream *stream, int id);
+
+/**
+    Get the ID of a well-known header
+    @param key Header name. The name is not case sensitive.
+    @return The header ID or -1 if the header is not a well-known header.
+    @ingroup HttpRx
+    @stability Evolving
+ */
+PUBLIC int httpGetHeaderId(cchar *key);
+
 /**
     Get the hash table of rx Http headers
-    @description Get the internal hash table of rx headers
+    @description Get a hash table view of the rx headers. The hash is created on the first call.
+        Use #httpSetRxHeader to add headers. Headers added directly to the hash are not visible via #httpGetHeader.
+        When request arenas are enabled via HttpLimits.arenaSize, the keys and values of the hash are request scoped
+        and are recycled when the stream is reset for the next request on a keep-alive connection. Use #httpPromote
+        to retain a key or value beyond the request.
     @param stream HttpStream stream object created via #httpCreateStream
     @return Hash table. See MprHash for how to access the hash table.
     @ingroup HttpRx
@@ -6918,6 +7400,8 @@ PUBLIC MprHash *httpGetHeaderHash(HttpStream *stream);
     Get all the request http headers.
     @description Get all the rx headers. The returned string formats all the headers in the form:
         key: value\\nkey2: value2\\n...
+        The returned string is allocated from the garbage collected heap, even when request arenas are enabled,
+        and may be retained beyond the request.
     @param stream HttpStream stream object created via #httpCreateStream
     @return String containing all the headers. The caller must free this returned string.
     @ingroup HttpRx
@@ -7119,6 +7603,18 @@ PUBLIC void httpSetEof(HttpStream *stream);
  */
 PUBLIC void httpSetParam(HttpStream *stream, cchar *var, cchar *value);
 
+/**
+    Set a received header
+    @description Set a header received from the peer. This replaces any prior value for the header except for
+        Set-Cookie headers which may be repeated. Well-known headers are indexed for #httpGetHeaderById.
+    @param stream HttpStream stream object
+    @param key Header name. The name is copied if required.
+    @param value Header value. The value is retained and not copied.
+    @ingroup HttpRx
+    @stability Evolving
+ */
+PUBLIC void httpSetRxHeader(HttpStream *stream, cchar *key, cchar *value);
+
 /**
     Set an integer request param value
     @description Set the value of a named request param to an integer value. Request parameters are define via
@@ -7242,6 +7738,23 @@ PUBLIC void httpProcessWriteEvent(HttpStream *stream);
 #define HTTP_TX_PIPELINE            0x80    /**< Created Tx pipeline */
 #define HTTP_TX_HAS_FILTERS         0x100   /**< Has output filters */
 
+/**
+    Pre-serialized response header prefix
+    @description The invariant leading portion of a HTTP/1 response header for a given protocol, status and route.
+        This includes the status line, the Server header and static route headers. Prefixes are cached per route
+        in HttpRoute.headerPrefixes and are emitted by httpCreateHeaders1 with a single copy.
+    @stability Internal
+ */
+typedef struct HttpHeaderPrefix {
+    char            *data;                  /**< Serialized status line and headers */
+    ssize           length;                 /**< Length of data */
+    cchar           *software;              /**< Http.software when the prefix was created */
+    int             protocol;               /**< HTTP/1 protocol minor version */
+    int             status;                 /**< Response status */
+    bool            routeHeaders;           /**< Route headers are included in the prefix */
+    bool            server;                 /**< Server header is included in the prefix */
+} HttpHeaderPrefix;
+
 /**
     Http Tx
     @description The tx object controls the transmission of data. This may be client requests or responses to
@@ -7282,6 +7795,7 @@ typedef struct HttpTx {
     HttpStage       *connector;             /**< Network connector to send / receive socket data */
     MprHash         *cookies;               /**< Browser cookies */
     MprHash         *headers;               /**< Transmission headers */
+    struct HttpHeaderPrefix *headerPrefix;  /**< Pre-serialized header prefix to emit before the headers */
     HttpCache       *cache;                 /**< Cache control entry (only set if this request is being cached) */
     MprBuf          *cacheBuffer;           /**< Response caching buffer */
     ssize           cacheBufferLength;      /**< Current size of the cache buffer data */
@@ -8082,6 +8596,7 @@ PUBLIC void httpStopEndpoint(HttpEndpoint *endpoint);
 #define HTTP_HOST_WILD_CONTAINS 0x40        /**< Host name contains the host name */
 #define HTTP_HOST_WILD_REGEXP   0x80        /**< Host name is a regular expression */
 #define HTTP_HOST_ATTACHED      0x100       /**< Host name attached to an endpoint */
+#define HTTP_HOST_COMBINE_ROUTES 0x200      /**< Match route patterns using combined matchers */
 
 /**
     Host Object
@@ -8101,6 +8616,7 @@ typedef struct HttpHost {
     struct HttpHost *parent;                /**< Parent host to inherit aliases, dirs, routes */
     MprCache        *responseCache;         /**< Response content caching store */
     MprList         *routes;                /**< List of Route defintions */
+    struct HttpRouteIndex *routeIndex;      /**< Compiled index of routes by literal path segment (built on demand) */
     HttpRoute       *defaultRoute;          /**< Default route for the host */
     HttpEndpoint    *defaultEndpoint;       /**< Default endpoint for host */
     HttpEndpoint    *secureEndpoint;        /**< Secure endpoint for host */
@@ -8221,6 +8737,18 @@ PUBLIC void httpResetRoutes(HttpHost *host);
  */
 PUBLIC int httpSetHostCanonicalName(HttpHost *host, cchar *name);
 
+/**
+    Control combined route matching for a host
+    @description When enabled, the route patterns of the host are compiled into combined matchers that find the first
+        matching route for a request path in one pass rather than testing each route pattern in turn. Matching
+        semantics are unchanged.
+    @param host HttpHost object
+    @param on Set to true to enable combined route matching
+    @ingroup HttpHost
+    @stability Prototype
+ */
+PUBLIC void httpSetHostCombineRoutes(HttpHost *host, bool on);
+
 /**
     Set the default host for all servers.
     @param host Host to define as the default host
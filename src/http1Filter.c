@@ -8,20 +8,41 @@
 
 #include    "http.h"
 
+#ifndef ME_HTTP_SIMD
+    #define ME_HTTP_SIMD 1
+#endif
+#if ME_HTTP_SIMD && (ME_CPU_ARCH == ME_CPU_X86 || ME_CPU_ARCH == ME_CPU_X64) && (__GNUC__ >= 5 || __clang__)
+    #define HTTP_SSE42 1
+    #include    <nmmintrin.h>
+#endif
+
 /*********************************** Locals ***********************************/
+/*
+    Character classes for token scanning
+ */
+#define CHAR_TOKEN              0x1     /* Header key and method characters (RFC 7230 tchar) */
+#define CHAR_URI                0x2     /* URI characters. Same set as httpValidUriChars. Also used for the protocol */
+#define CHAR_VALUE              0x4     /* Header value characters: space and visible characters */
+#define CHAR_LINE               0x8     /* Any character except NUL, CR and LF */
+#define CHAR_DIGIT              0x10    /* Decimal digits */
 
-#define TOKEN_HEADER_KEY        0x1     /* Validate token as a header key */
-#define TOKEN_HEADER_VALUE      0x2     /* Validate token as a header value */
-#define TOKEN_URI               0x4     /* Validate token as a URI value */
-#define TOKEN_NUMBER            0x8     /* Validate token as a number */
-#define TOKEN_WORD              0x10    /* Validate token as single word with no spaces */
-#define TOKEN_LINE              0x20    /* Validate token as line with no newlines */
+#define NO_SIMD_ENV             "HTTP_NO_SIMD"  /* Set to use the portable scanner. Used to test both scanners. */
+
+static uchar charClass[256];
+
+/*
+    Scan characters while they are in a class. Selected at runtime to use SSE4.2 if available and not disabled
+    via NO_SIMD_ENV.
+ */
+static char *(*scanChars)(char *start, char *end, int cls);
 
 /********************************** Forwards **********************************/
 
+static cchar *findHeaderEnd(cchar *start, ssize len);
 static HttpStream *findStream(HttpQueue *q);
-static char *getToken(HttpPacket *packet, cchar *delim, int validation);
+static char *getToken(HttpPacket *packet, cchar *delim, int cls);
 static bool gotHeaders(HttpQueue *q, HttpPacket *packet);
+static void initCharClasses(void);
 static void logPacket(HttpQueue *q, HttpPacket *packet);
 static void incomingHttp1(HttpQueue *q, HttpPacket *packet);
 static bool monitorActiveRequests(HttpStream *stream);
@@ -31,7 +52,10 @@ static HttpPacket *parseFields(HttpQueue *q, HttpPacket *packet);
 static HttpPacket *parseHeaders(HttpQueue *q, HttpPacket *packet);
 static void parseRequestLine(HttpQueue *q, HttpPacket *packet);
 static void parseResponseLine(HttpQueue *q, HttpPacket *packet);
-static char *validateToken(char *token, char *endToken, int validation);
+static char *scanCharsScalar(char *start, char *end, int cls);
+#if HTTP_SSE42
+static char *scanCharsSse42(char *start, char *end, int cls);
+#endif
 
 /*********************************** Code *************************************/
 /*
@@ -48,10 +72,45 @@ PUBLIC int httpOpenHttp1Filter()
     filter->incoming = incomingHttp1;
     filter->outgoing = outgoingHttp1;
     filter->outgoingService = outgoingHttp1Service;
+    initCharClasses();
     return 0;
 }
 
 
+static void initCharClasses(void)
+{
+    cchar   *cp;
+    int     c;
+
+    for (c = 0; c < 256; c++) {
+        if (isalnum(c)) {
+            charClass[c] |= CHAR_TOKEN | CHAR_URI;
+        }
+        if (isdigit(c)) {
+            charClass[c] |= CHAR_DIGIT;
+        }
+        if (c >= 0x20 && c < 0x7F) {
+            charClass[c] |= CHAR_VALUE;
+        }
+        if (c != '\0' && c != '\r' && c != '\n') {
+            charClass[c] |= CHAR_LINE;
+        }
+    }
+    for (cp = "!#$%&'*+-.^_`|~"; *cp; cp++) {
+        charClass[(uchar) *cp] |= CHAR_TOKEN;
+    }
+    for (cp = "-._~:/?#[]@!$&'()*+,;=%"; *cp; cp++) {
+        charClass[(uchar) *cp] |= CHAR_URI;
+    }
+    scanChars = scanCharsScalar;
+#if HTTP_SSE42
+    if (__builtin_cpu_supports("sse4.2") && !getenv(NO_SIMD_ENV)) {
+        scanChars = scanCharsSse42;
+    }
+#endif
+}
+
+
 /*
     The queue is the net->inputq == netHttp-rx
  */
@@ -198,11 +257,33 @@ static cchar *eatBlankLines(HttpPacket *packet)
         if (*start != '\r' && *start != '\n') {
             break;
         }
+        mprAdjustBufStart(content, 1);
     }
     return mprGetBufStart(content);
 }
 
 
+/*
+    Find the end of the headers in one pass. Returns a reference to the blank line terminator "\r\n\r\n" or "\n\n".
+    The newline search uses memchr which is vectorized by the C library.
+ */
+static cchar *findHeaderEnd(cchar *start, ssize len)
+{
+    cchar   *cp, *end;
+
+    end = &start[len];
+    for (cp = start; cp < end && (cp = memchr(cp, '\n', end - cp)) != 0; cp++) {
+        if (&cp[1] < end && cp[1] == '\n') {
+            return cp;
+        }
+        if (&cp[2] < end && cp[1] == '\r' && cp[2] == '\n' && cp > start && cp[-1] == '\r') {
+            return &cp[-1];
+        }
+    }
+    return 0;
+}
+
+
 static bool gotHeaders(HttpQueue *q, HttpPacket *packet)
 {
     HttpStream  *stream;
@@ -215,7 +296,7 @@ static bool gotHeaders(HttpQueue *q, HttpPacket *packet)
     start = eatBlankLines(packet);
     len = httpGetPacketLength(packet);
 
-    if ((end = sncontains(start, "\r\n\r\n", len)) != 0 || (end = sncontains(start, "\n\n", len)) != 0) {
+    if ((end = findHeaderEnd(start, len)) != 0) {
         len = end - start;
     }
     if (len >= limits->headerSize || len >= q->max) {
@@ -246,7 +327,7 @@ static void parseRequestLine(HttpQueue *q, HttpPacket *packet)
     rx = stream->rx;
     limits = stream->limits;
 
-    method = getToken(packet, NULL, TOKEN_WORD);
+    method = getToken(packet, NULL, CHAR_TOKEN);
     if (method == NULL || *method == '\0') {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad HTTP request. Empty method");
         return;
@@ -254,7 +335,7 @@ static void parseRequestLine(HttpQueue *q, HttpPacket *packet)
     rx->originalMethod = rx->method = supper(method);
     httpParseMethod(stream);
 
-    uri = getToken(packet, NULL, TOKEN_URI);
+    uri = getToken(packet, NULL, CHAR_URI);
     if (uri == NULL || *uri == '\0') {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad HTTP request. Empty URI");
         return;
@@ -269,7 +350,7 @@ static void parseRequestLine(HttpQueue *q, HttpPacket *packet)
     if (!rx->originalUri) {
         rx->originalUri = rx->uri;
     }
-    protocol = getToken(packet, "\r\n", TOKEN_WORD);
+    protocol = getToken(packet, "\r\n", CHAR_URI);
     if (protocol == NULL || *protocol == '\0') {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad HTTP request. Empty protocol");
         return;
@@ -309,7 +390,7 @@ static void parseResponseLine(HttpQueue *q, HttpPacket *packet)
     rx = stream->rx;
     tx = stream->tx;
 
-    protocol = getToken(packet, NULL, TOKEN_WORD);
+    protocol = getToken(packet, NULL, CHAR_URI);
     if (protocol == NULL || *protocol == '\0') {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_NOT_ACCEPTABLE, "Bad response protocol");
         return;
@@ -324,14 +405,14 @@ static void parseResponseLine(HttpQueue *q, HttpPacket *packet)
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_NOT_ACCEPTABLE, "Unsupported HTTP protocol");
         return;
     }
-    status = getToken(packet, NULL, TOKEN_NUMBER);
+    status = getToken(packet, NULL, CHAR_DIGIT);
     if (status == NULL || *status == '\0') {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_NOT_ACCEPTABLE, "Bad response status code");
         return;
     }
     rx->status = atoi(status);
 
-    message = getToken(packet, "\r\n", TOKEN_LINE);
+    message = getToken(packet, "\r\n", CHAR_LINE);
     if (message == NULL || *message == '\0') {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_NOT_ACCEPTABLE, "Bad response status message");
         return;
@@ -359,14 +440,11 @@ static void parseResponseLine(HttpQueue *q, HttpPacket *packet)
 static HttpPacket *parseFields(HttpQueue *q, HttpPacket *packet)
 {
     HttpStream  *stream;
-    HttpRx      *rx;
     HttpLimits  *limits;
     char        *key, *value;
     int         count;
 
     stream = q->stream;
-    rx = stream->rx;
-
     limits = stream->limits;
 
     for (count = 0; mprGetBufLength(packet->content) > 0 && packet->content->start[0] != '\r' && !stream->error; count++) {
@@ -374,21 +452,17 @@ static HttpPacket *parseFields(HttpQueue *q, HttpPacket *packet)
             httpLimitError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Too many headers");
             return 0;
         }
-        key = getToken(packet, ":", TOKEN_HEADER_KEY);
+        key = getToken(packet, ":", CHAR_TOKEN);
         if (key == NULL || *key == '\0' || mprGetBufLength(packet->content) == 0) {
             httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad header format");
             return 0;
         }
-        value = getToken(packet, "\r\n", TOKEN_HEADER_VALUE);
+        value = getToken(packet, "\r\n", CHAR_VALUE);
         if (value == NULL || mprGetBufLength(packet->content) == 0 || packet->content->start[0] == '\0') {
             httpBadRequestError(conn, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad header value");
             return 0;
         }
-        if (scaselessmatch(key, "set-cookie")) {
-            mprAddDuplicateKey(rx->headers, key, sclone(value));
-        } else {
-            mprAddKey(rx->headers, key, sclone(value));
-        }
+        httpSetRxHeader(stream, key, httpArenaClone(stream, value));
     }
     if (mprGetBufLength(packet->content) < 2) {
         httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad header format");
@@ -398,7 +472,7 @@ static HttpPacket *parseFields(HttpQueue *q, HttpPacket *packet)
         Split the headers and retain the data for later. Step over "\r\n" after headers except if chunked
         so chunking can parse a single chunk delimiter of "\r\nSIZE ...\r\n"
      */
-    if (smatch(httpGetHeader(stream, "transfer-encoding"), "chunked")) {
+    if (smatch(httpGetHeaderById(stream, HTTP_HEADER_TRANSFER_ENCODING), "chunked")) {
         httpInitChunking(stream);
     } else {
         mprAdjustBufStart(packet->content, 2);
@@ -413,100 +487,119 @@ static HttpPacket *parseFields(HttpQueue *q, HttpPacket *packet)
 
 /*
     Get the next input token. The content buffer is advanced to the next token.
-    The delimiter is a string to match and not a set of characters.
-    If the delimeter null, it means use white space (space or tab) as a delimiter.
+    The token characters must be in the given character class (cls). The token is scanned and validated in one pass.
+    The delimiter is a string that must immediately follow the token. If the delimeter is null, it means use
+    white space (space or tab) as a delimiter. Header values may have leading and trailing white space which is trimmed.
+    The token is null terminated in place.
  */
-static char *getToken(HttpPacket *packet, cchar *delim, int validation)
+static char *getToken(HttpPacket *packet, cchar *delim, int cls)
 {
     MprBuf  *buf;
-    char    *token, *endToken;
+    char    *token, *endToken, *end, *cp;
+    ssize   len;
 
     buf = packet->content;
     /* Already null terminated but for safety */
     mprAddNullToBuf(buf);
     token = mprGetBufStart(buf);
-    endToken = mprGetBufEnd(buf);
+    end = mprGetBufEnd(buf);
 
     /*
         Eat white space before token
      */
-    for (; token < endToken && (*token == ' ' || *token == '\t'); token++) {}
-
+    for (; token < end && (*token == ' ' || *token == '\t'); token++) {}
+
+    endToken = scanChars(token, end, cls);
+    cp = endToken;
+    if (cls == CHAR_VALUE) {
+        for (; cp < end && (*cp == ' ' || *cp == '\t'); cp++) {}
+        while (endToken > token && endToken[-1] == ' ') {
+            endToken--;
+        }
+    }
     if (delim) {
-        if ((endToken = sncontains(token, delim, endToken - token)) == NULL) {
+        len = slen(delim);
+        if (cp + len > end || strncmp(cp, delim, len) != 0) {
             return NULL;
         }
         /* Only eat one occurence of the delimiter */
-        buf->start = endToken + strlen(delim);
-        *endToken = '\0';
+        buf->start = cp + len;
 
     } else {
-        delim = " \t";
-        if ((endToken = strpbrk(token, delim)) == NULL) {
+        if (cp >= end || (*cp != ' ' && *cp != '\t')) {
             return NULL;
         }
-        buf->start = endToken + strspn(endToken, delim);
-        *endToken = '\0';
+        for (cp++; cp < end && (*cp == ' ' || *cp == '\t'); cp++) {}
+        buf->start = cp;
     }
-    token = validateToken(token, endToken, validation);
+    *endToken = '\0';
     return token;
 }
 
 
-static char *validateToken(char *token, char *endToken, int validation)
+static char *scanCharsScalar(char *cp, char *end, int cls)
 {
-    char   *t;
+    for (; cp < end && (charClass[(uchar) *cp] & cls); cp++) {}
+    return cp;
+}
 
-    if (validation == TOKEN_HEADER_KEY) {
-        if (*token == '\0') {
-            return NULL;
-        }
-        if (strpbrk(token, "\"\\/ \t\r\n(),:;<=>?@[]{}")) {
-            return NULL;
-        }
-        for (t = token; t < endToken && *t; t++) {
-            if (!isprint(*t)) {
-                return NULL;
-            }
-        }
-    } else if (validation == TOKEN_HEADER_VALUE) {
-        if (token < endToken) {
-            /* Trim white space */
-            for (t = endToken - 1; t >= token; t--) {
-                if (isspace((uchar) *t)) {
-                    *t = '\0';
-                } else {
-                    break;
-                }
-            }
-        }
-        while (isspace((uchar) *token)) {
-            token++;
-        }
-        for (t = token; *t; t++) {
-            if (!isprint(*t)) {
-                return NULL;
+
+#if HTTP_SSE42
+/*
+    Scan 16 bytes at a time using SSE4.2 string ranges. The ranges cover the bytes not in the class and may include
+    some class bytes (at most eight ranges are supported). A range hit on a class byte is resolved via charClass.
+ */
+__attribute__((target("sse4.2")))
+static char *scanCharsSse42(char *cp, char *end, int cls)
+{
+    static const char tokenRanges[16] = "\x00 \"\"(),,//:@[]{\xff";
+    static const char uriRanges[16] = "\x00 \"\"<<>>\\\\^^``{\xff";
+    static const char valueRanges[16] = "\x00\x1f\x7f\xff";
+    static const char lineRanges[16] = "\x00\x00\n\n\r\r";
+    static const char digitRanges[16] = "\x00/:\xff";
+    cchar   *ranges;
+    __m128i rangeSet, data;
+    int     count, i;
+
+    switch (cls) {
+    case CHAR_TOKEN:
+        ranges = tokenRanges;
+        count = 16;
+        break;
+    case CHAR_URI:
+        ranges = uriRanges;
+        count = 16;
+        break;
+    case CHAR_VALUE:
+        ranges = valueRanges;
+        count = 4;
+        break;
+    case CHAR_LINE:
+        ranges = lineRanges;
+        count = 6;
+        break;
+    case CHAR_DIGIT:
+        ranges = digitRanges;
+        count = 4;
+        break;
+    default:
+        return scanCharsScalar(cp, end, cls);
+    }
+    rangeSet = _mm_loadu_si128((const __m128i*) ranges);
+    while (end - cp >= 16) {
+        data = _mm_loadu_si128((const __m128i*) cp);
+        i = _mm_cmpestri(rangeSet, count, data, 16, _SIDD_LEAST_SIGNIFICANT | _SIDD_CMP_RANGES | _SIDD_UBYTE_OPS);
+        cp += i;
+        if (i < 16) {
+            if (!(charClass[(uchar) *cp] & cls)) {
+                return cp;
             }
-        }
-    } else if (validation == TOKEN_URI) {
-        if (!httpValidUriChars(token)) {
-            return NULL;
-        }
-    } else if (validation == TOKEN_NUMBER) {
-        if (!snumber(token)) {
-            return NULL;
-        }
-    } else if (validation == TOKEN_WORD) {
-        if (strpbrk(token, " \t\r\n") != NULL) {
-            return NULL;
-        }
-    } else {
-        if (strpbrk(token, "\r\n") != NULL) {
-            return NULL;
+            cp++;
         }
     }
-    return token;
+    return scanCharsScalar(cp, end, cls);
 }
+#endif
 
 
 PUBLIC void httpCreateHeaders1(HttpQueue *q, HttpPacket *packet)
@@ -536,7 +629,12 @@ PUBLIC void httpCreateHeaders1(HttpQueue *q, HttpPacket *packet)
     }
     httpPrepareHeaders(stream);
 
-    if (httpServerStream(stream)) {
+    if (tx->headerPrefix) {
+        /* Pre-serialized status line, Server and route headers */
+        mprPutBlockToBuf(buf, tx->headerPrefix->data, tx->headerPrefix->length);
+        mprPutStringToBuf(buf, http->dateHeader);
+
+    } else if (httpServerStream(stream)) {
         mprPutStringToBuf(buf, httpGetProtocol(stream->net));
         mprPutCharToBuf(buf, ' ');
         mprPutIntToBuf(buf, tx->status);
@@ -566,8 +664,9 @@ PUBLIC void httpCreateHeaders1(HttpQueue *q, HttpPacket *packet)
             }
         }
     }
-    mprPutStringToBuf(buf, "\r\n");
-
+    if (!tx->headerPrefix) {
+        mprPutStringToBuf(buf, "\r\n");
+    }
     if (httpTracing(q->net)) {
         httpLog(stream->trace, "http.tx.headers", "headers", "\n\n%s %d %s\n%s",
             httpGetProtocol(stream->net), tx->status, httpLookupStatus(tx->status), httpTraceHeaders(q, tx->headers));
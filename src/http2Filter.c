@@ -1006,7 +1006,7 @@ static void addHeaderToSet(HttpStream *stream, cchar *key, cchar *value)
     }
     if (key[0] == ':') {
         if (key[1] == 'a' && smatch(key, ":authority")) {
-            mprAddKey(stream->rx->headers, "host", value);
+            httpSetRxHeader(stream, "host", value);
 
         } else if (key[1] == 'm' && smatch(key, ":method")) {
             rx->originalMethod = rx->method = supper(value);
@@ -1035,11 +1035,7 @@ static void addHeaderToSet(HttpStream *stream, cchar *key, cchar *value)
             }
         }
     } else {
-        if (scaselessmatch(key, "set-cookie")) {
-            mprAddDuplicateKey(rx->headers, key, value);
-        } else {
-            mprAddKey(rx->headers, key, value);
-        }
+        httpSetRxHeader(stream, key, value);
     }
 }
 
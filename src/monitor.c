@@ -5,6 +5,10 @@
 
     A note on locking. Unlike most of appweb which effectively runs single-threaded due to the dispatcher,
     this module typically runs the httpMonitorEvent and checkMonitor routines multi-threaded.
+
+    When the shared counter segment is open, per-client counters, bans and delays are also kept in a memory mapped
+    file shared by all server processes. Only the process that created the segment checks monitors over the shared
+    counters and invokes defenses. Other processes update the shared counters and apply bans and delays.
  */
 
 /********************************* Includes ***********************************/
@@ -13,9 +17,17 @@
 
 /********************************** Forwards **********************************/
 
-static HttpAddress *growAddresses(HttpNet *net, HttpAddress *address, int counterIndex);
+static HttpAddress *createAddress(Http *http, cchar *ip, uint hash);
+static HttpAddress *lookupAddress(HttpAddresses *addresses, cchar *ip, uint hash);
+static HttpSharedClient *lookupSharedClient(HttpSharedCounters *shared, cchar *ip, bool add);
+static void manageAddress(HttpAddress *address, int flags);
+static void manageAddresses(HttpAddresses *addresses, int flags);
 static MprTicks lookupTicks(MprHash *args, cchar *key, MprTicks defaultValue);
+static void pruneSharedClients(Http *http, MprTicks period);
+static int64 sharedEvent(Http *http, HttpNet *net, HttpAddress *address, int counterIndex, int64 adj);
+static void startMonitors(void);
 static void stopMonitors(void);
+static void unlinkAddress(HttpAddresses *addresses, HttpAddress *address);
 
 /************************************ Code ************************************/
 
@@ -106,30 +118,31 @@ static void checkCounter(HttpMonitor *monitor, HttpCounter *counter, cchar *ip)
 {
     MprHash     *args;
     cchar       *address, *fmt, *msg, *subject;
-    uint64      period;
+    uint64      period, value;
 
     fmt = 0;
+    value = counter->value;
 
     if (monitor->expr == '>') {
-        if (counter->value > monitor->limit) {
+        if (value > monitor->limit) {
             fmt = "Monitor%s for \"%s\". Value %lld per %lld secs exceeds limit of %lld.";
         }
 
     } else if (monitor->expr == '>') {
-        if (counter->value < monitor->limit) {
+        if (value < monitor->limit) {
             fmt = "Monitor%s for \"%s\". Value %lld per %lld secs outside limit of %lld.";
         }
     }
     if (fmt) {
         period = monitor->period / 1000;
         address = ip ? sfmt(" %s", ip) : "";
-        msg = sfmt(fmt, address, monitor->counterName, counter->value, period, monitor->limit);
+        msg = sfmt(fmt, address, monitor->counterName, value, period, monitor->limit);
         httpLog(HTTP->trace, "monitor.check", "context", "msg:'%s'", msg);
 
         subject = sfmt("Monitor %s Alert", monitor->counterName);
         args = mprDeserialize(
             sfmt("{ COUNTER: '%s', DATE: '%s', IP: '%s', LIMIT: %lld, MESSAGE: '%s', PERIOD: %lld, SUBJECT: '%s', VALUE: %lld }",
-            monitor->counterName, mprGetDate(NULL), ip, monitor->limit, msg, period, subject, counter->value));
+            monitor->counterName, mprGetDate(NULL), ip, monitor->limit, msg, period, subject, value));
         /*
             WARNING: remedies may yield
          */
@@ -137,31 +150,93 @@ static void checkCounter(HttpMonitor *monitor, HttpCounter *counter, cchar *ip)
         invokeDefenses(monitor, args);
         mprRemoveRoot(args);
     }
-    counter->value = 0;
+    /*
+        Subtract the value checked so concurrent updates (possibly from other processes) are not lost
+     */
+    mprAtomicAdd64((int64*) &counter->value, -(int64) value);
 }
 
 
+/*
+    Prune stale addresses. This does not lock the table and runs concurrently with lookups and inserts.
+    Each prune starts a new epoch and releases the addresses retired in the prior epoch to the garbage collector.
+    Lookups do not yield and complete well within one epoch, so no lookup can be traversing a retired address when
+    it is freed. Iterators that may yield must hold their current address.
+ */
 PUBLIC void httpPruneMonitors()
 {
-    Http        *http;
-    HttpAddress *address;
-    MprTicks    period;
-    MprKey      *kp;
+    Http            *http;
+    HttpAddresses   *addresses;
+    HttpAddress     *address, *next;
+    MprTicks        period;
+    uint            i;
 
     http = HTTP;
+    addresses = http->addresses;
     period = max(http->monitorPeriod, ME_HTTP_MONITOR_PERIOD);
-    lock(http->addresses);
-    for (ITERATE_KEY_DATA(http->addresses, kp, address)) {
-        if (address->banUntil && address->banUntil < http->now) {
-            httpLog(http->trace, "monitor.ban.stop", "context", "client:'%s'", kp->key);
-            address->banUntil = 0;
+
+    /*
+        Monitors may run on multiple threads. Only one needs to prune.
+     */
+    if (!mprTryLock(addresses->mutex)) {
+        return;
+    }
+    addresses->retired = mprCreateList(0, MPR_LIST_STABLE);
+    addresses->epoch++;
+    for (i = 0; i <= addresses->mask; i++) {
+        for (address = addresses->buckets[i]; address; address = next) {
+            next = address->next;
+            if (address->banUntil && address->banUntil < http->now) {
+                httpLog(http->trace, "monitor.ban.stop", "context", "client:'%s'", address->ip);
+                address->banUntil = 0;
+            }
+            if ((address->updated + period) < http->now && address->banUntil == 0) {
+                unlinkAddress(addresses, address);
+            }
+        }
+    }
+    mprUnlock(addresses->mutex);
+    if (http->shared && http->sharedOwner) {
+        pruneSharedClients(http, period);
+    }
+}
+
+
+/*
+    Prune idle clients from the shared segment. Only run by the owner so there is one pruner.
+ */
+static void pruneSharedClients(Http *http, MprTicks period)
+{
+    HttpSharedCounters  *shared;
+    HttpSharedClient    *cp;
+    int                 i;
+
+    shared = http->shared;
+    cp = (HttpSharedClient*) &shared[1];
+    for (i = 0; i < shared->clients; i++, cp++) {
+        if (!cp->ready) {
+            continue;
+        }
+        if (cp->banUntil && cp->banUntil < http->now) {
+            httpLog(http->trace, "monitor.ban.stop", "context", "client:'%s'", cp->ip);
+            cp->banUntil = 0;
         }
-        if ((address->updated + period) < http->now && address->banUntil == 0) {
-            mprRemoveKey(http->addresses, kp->key);
-            /* Safe to keep iterating after removal of key */
+        if ((cp->updated + period) < http->now && cp->banUntil == 0 &&
+                cp->counters[HTTP_COUNTER_ACTIVE_CONNECTIONS] <= 0) {
+            /*
+                Processes holding this slot notice the key change and lookup a new slot
+             */
+            cp->ready = 0;
+            mprAtomicBarrier();
+            memset((char*) cp->counters, 0, sizeof(cp->counters));
+            cp->ip[0] = '\0';
+            cp->banStatus = 0;
+            cp->delayUntil = cp->delay = 0;
+            mprAtomicBarrier();
+            cp->key = HTTP_SHARED_TOMBSTONE;
+            mprAtomicAdd64(&shared->active, -1);
         }
     }
-    unlock(http->addresses);
 }
 
 
@@ -170,10 +245,12 @@ PUBLIC void httpPruneMonitors()
  */
 static void checkMonitor(HttpMonitor *monitor, MprEvent *event)
 {
-    Http            *http;
-    HttpAddress     *address;
-    HttpCounter     c, *counter;
-    MprKey          *kp;
+    Http                *http;
+    HttpAddress         *address;
+    HttpCounter         c;
+    HttpSharedCounters  *shared;
+    HttpSharedClient    *cp;
+    int                 i;
 
     http = HTTP;
     http->now = mprGetTicks();
@@ -189,30 +266,45 @@ static void checkMonitor(HttpMonitor *monitor, MprEvent *event)
         checkCounter(monitor, &c, NULL);
 
     } else if (monitor->counterIndex == HTTP_COUNTER_ACTIVE_CLIENTS) {
+        if (http->shared && !http->sharedOwner) {
+            return;
+        }
         memset(&c, 0, sizeof(HttpCounter));
-        c.value = mprGetHashLength(http->addresses);
+        c.value = http->shared ? http->shared->active : httpGetAddressCount();
         checkCounter(monitor, &c, NULL);
 
-    } else {
+    } else if (http->shared && monitor->counterIndex < HTTP_SHARED_COUNTERS) {
         /*
-            Check the monitor for each active client address
+            Check the monitor for each client over all processes
          */
-        lock(http->addresses);
-        for (ITERATE_KEY_DATA(http->addresses, kp, address)) {
-            counter = &address->counters[monitor->counterIndex];
+        if (http->sharedOwner) {
+            shared = http->shared;
+            cp = (HttpSharedClient*) &shared[1];
+            for (i = 0; i < shared->clients; i++, cp++) {
+                if (cp->ready) {
+                    checkCounter(monitor, (HttpCounter*) &cp->counters[monitor->counterIndex], sclone(cp->ip));
+                }
+            }
+        } else if (httpGetAddressCount() == 0) {
+            stopMonitors();
+        }
+        httpPruneMonitors();
 
-            /*
-                WARNING: this may allow new addresses to be added or stale addresses to be removed.
-                Regardless, because GC is paused, iterating is safe.
-             */
-            unlock(http->addresses);
-            checkCounter(monitor, counter, kp->key);
-            lock(http->addresses);
+    } else {
+        /*
+            Check the monitor for each active client address. Remedies may yield and other monitors may prune
+            meanwhile, so hold the current address until the iterator has moved past it.
+         */
+        for (address = 0; (address = httpGetNextAddress(address)) != 0; ) {
+            if (monitor->counterIndex < address->ncounters) {
+                mprHold(address);
+                checkCounter(monitor, &address->counters[monitor->counterIndex], address->ip);
+                mprRelease(address);
+            }
         }
-        if (mprGetHashLength(http->addresses) == 0) {
+        if (httpGetAddressCount() == 0 && !http->sharedOwner) {
             stopMonitors();
         }
-        unlock(http->addresses);
         httpPruneMonitors();
     }
 }
@@ -284,6 +376,7 @@ static void manageAddress(HttpAddress *address, int flags)
 {
     if (flags & MPR_MANAGE_MARK) {
         mprMark(address->banMsg);
+        mprMark(address->ip);
     }
 }
 
@@ -332,60 +425,217 @@ static void stopMonitors()
 }
 
 
+/*
+    Lookup or add the client address for the network connection.
+    The counterIndex is not required as counters are allocated for all defined counters when the address is created.
+ */
 PUBLIC HttpAddress *httpMonitorAddress(HttpNet *net, int counterIndex)
 {
     Http            *http;
+    HttpAddresses   *addresses;
     HttpAddress     *address;
+    MprMutex        *mutex;
+    uint            hash, bucket;
     int             count;
-    static int      seqno = 0;
+    static volatile int seqno = 0;
 
     address = net->address;
     if (address) {
         return address;
     }
     http = net->http;
-    count = mprGetHashLength(http->addresses);
-    if (count > net->limits->clientMax) {
-        mprLog("net info", 3, "Too many concurrent clients, active: %d, max:%d", count, net->limits->clientMax);
+    addresses = http->addresses;
+    hash = shash(net->ip, slen(net->ip));
+
+    if ((address = lookupAddress(addresses, net->ip, hash)) == 0) {
+        count = (int) addresses->count;
+        if (count > net->limits->clientMax) {
+            mprLog("net info", 3, "Too many concurrent clients, active: %d, max:%d", count, net->limits->clientMax);
+            return 0;
+        }
+        bucket = hash & addresses->mask;
+        mutex = addresses->shards[bucket & (ME_HTTP_ADDRESS_SHARDS - 1)];
+        mprLock(mutex);
+        /*
+            Check again while locked in case another thread has just added this client
+         */
+        if ((address = lookupAddress(addresses, net->ip, hash)) == 0) {
+            if ((address = createAddress(http, net->ip, hash)) == 0) {
+                mprUnlock(mutex);
+                return 0;
+            }
+            address->seqno = mprAtomicAddFetch(&seqno, 1);
+            address->next = addresses->buckets[bucket];
+            /*
+                Publish the address only after it is fully initialized
+             */
+            mprAtomicBarrier();
+            addresses->buckets[bucket] = address;
+            mprAtomicAdd64(&addresses->count, 1);
+        }
+        mprUnlock(mutex);
+    }
+    net->address = address;
+    if (!http->monitorsStarted) {
+        startMonitors();
+    }
+    return address;
+}
+
+
+static HttpAddress *createAddress(Http *http, cchar *ip, uint hash)
+{
+    HttpAddress     *address;
+    int             ncounters;
+
+    /*
+        Counters are never reallocated, so size for all defined counters
+     */
+    ncounters = max(mprGetListLength(http->counters), HTTP_COUNTER_MAX);
+    ncounters = ((ncounters + 0xF) & ~0xF);
+    address = mprAllocBlock(sizeof(HttpAddress) + (ncounters - 1) * sizeof(HttpCounter), MPR_ALLOC_MANAGER | MPR_ALLOC_ZERO);
+    if (address == 0) {
         return 0;
     }
-    if (counterIndex <= 0) {
-        counterIndex = HTTP_COUNTER_MAX;
+    mprSetManager(address, (MprManager) manageAddress);
+    address->ip = sclone(ip);
+    address->hash = hash;
+    address->ncounters = ncounters;
+    address->updated = http->now;
+    return address;
+}
+
+
+/*
+    Lookup an address without locking. Inserts publish complete addresses and unlinked addresses retain their
+    next pointer, so a concurrent traversal always sees a valid chain.
+ */
+static HttpAddress *lookupAddress(HttpAddresses *addresses, cchar *ip, uint hash)
+{
+    HttpAddress     *address;
+
+    for (address = addresses->buckets[hash & addresses->mask]; address; address = address->next) {
+        if (address->hash == hash && !address->retired && smatch(address->ip, ip)) {
+            return address;
+        }
+    }
+    return 0;
+}
+
+
+/*
+    Remove an address from its chain. Called only by the pruner.
+ */
+static void unlinkAddress(HttpAddresses *addresses, HttpAddress *address)
+{
+    HttpAddress * volatile  *prev;
+    MprMutex                *mutex;
+    uint                    bucket;
+
+    bucket = address->hash & addresses->mask;
+    mutex = addresses->shards[bucket & (ME_HTTP_ADDRESS_SHARDS - 1)];
+    mprLock(mutex);
+    for (prev = &addresses->buckets[bucket]; *prev; prev = &(*prev)->next) {
+        if (*prev == address) {
+            *prev = address->next;
+            address->retired = 1;
+            mprAddItem(addresses->retired, address);
+            mprAtomicAdd64(&addresses->count, -1);
+            break;
+        }
     }
-    lock(http->addresses);
-    address = mprLookupKey(http->addresses, net->ip);
-    if ((address = growAddresses(net, address, counterIndex)) == 0) {
-        unlock(http->addresses);
+    mprUnlock(mutex);
+}
+
+
+PUBLIC HttpAddresses *httpCreateAddresses(int buckets)
+{
+    HttpAddresses   *addresses;
+    int             i, size;
+
+    if ((addresses = mprAllocObj(HttpAddresses, manageAddresses)) == 0) {
         return 0;
     }
-    address->seqno = ++seqno;
-    mprAddKey(http->addresses, net->ip, address);
+    for (size = 16; size < buckets; size <<= 1) ;
+    addresses->mask = size - 1;
+    addresses->buckets = mprAllocZeroed(size * sizeof(HttpAddress*));
+    addresses->mutex = mprCreateLock();
+    addresses->retired = mprCreateList(0, MPR_LIST_STABLE);
+    for (i = 0; i < ME_HTTP_ADDRESS_SHARDS; i++) {
+        addresses->shards[i] = mprCreateLock();
+    }
+    return addresses;
+}
 
-    net->address = address;
-    if (!http->monitorsStarted) {
-        startMonitors();
+
+static void manageAddresses(HttpAddresses *addresses, int flags)
+{
+    HttpAddress     *address;
+    uint            i;
+
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(addresses->buckets);
+        mprMark(addresses->mutex);
+        mprMark(addresses->retired);
+        for (i = 0; i < ME_HTTP_ADDRESS_SHARDS; i++) {
+            mprMark(addresses->shards[i]);
+        }
+        /*
+            Threads are paused while marking, so the chains are stable
+         */
+        for (i = 0; i <= addresses->mask; i++) {
+            for (address = addresses->buckets[i]; address; address = address->next) {
+                mprMark(address);
+            }
+        }
     }
-    unlock(http->addresses);
-    return address;
 }
 
 
-static HttpAddress *growAddresses(HttpNet *net, HttpAddress *address, int counterIndex)
+PUBLIC HttpAddress *httpLookupAddress(cchar *ip)
 {
-    int     ncounters;
+    if (!ip || !HTTP->addresses) {
+        return 0;
+    }
+    return lookupAddress(HTTP->addresses, ip, shash(ip, slen(ip)));
+}
 
-    if (!address || address->ncounters <= counterIndex) {
-        ncounters = ((counterIndex + 0xF) & ~0xF);
+
+/*
+    Iterate over addresses without locking. Start with last set to null.
+    If the last address has been pruned, resume from the start of its bucket. Addresses may be visited twice.
+ */
+PUBLIC HttpAddress *httpGetNextAddress(HttpAddress *last)
+{
+    HttpAddresses   *addresses;
+    HttpAddress     *address;
+    uint            bucket;
+
+    if ((addresses = HTTP->addresses) == 0) {
+        return 0;
+    }
+    if (last) {
+        bucket = last->hash & addresses->mask;
+        address = last->retired ? addresses->buckets[bucket] : last->next;
         if (address) {
-            address = mprRealloc(address, sizeof(HttpAddress) * ncounters * sizeof(HttpCounter));
-            memset(&address[address->ncounters], 0, (ncounters - address->ncounters) * sizeof(HttpCounter));
-        } else {
-            address = mprAllocBlock(sizeof(HttpAddress) * ncounters * sizeof(HttpCounter), MPR_ALLOC_MANAGER | MPR_ALLOC_ZERO);
-            mprSetManager(address, (MprManager) manageAddress);
+            return address;
         }
-        address->ncounters = ncounters;
+        bucket++;
+    } else {
+        bucket = 0;
     }
-    return address;
+    for (; bucket <= addresses->mask; bucket++) {
+        if ((address = addresses->buckets[bucket]) != 0) {
+            return address;
+        }
+    }
+    return 0;
+}
+
+
+PUBLIC int httpGetAddressCount()
+{
+    return HTTP->addresses ? (int) HTTP->addresses->count : 0;
 }
 
 
@@ -394,19 +644,224 @@ PUBLIC int64 httpMonitorNetEvent(HttpNet *net, int counterIndex, int64 adj)
     HttpAddress     *address;
     HttpCounter     *counter;
 
-    if ((address = httpMonitorAddress(net, counterIndex)) == 0) {
+    if ((address = httpMonitorAddress(net, counterIndex)) == 0 || counterIndex >= address->ncounters) {
+        /* Counters defined after the address was created are not tracked for the address */
         return 0;
     }
     counter = &address->counters[counterIndex];
     mprAtomicAdd64((int64*) &counter->value, adj);
     /*
-        Tolerated race with "updated" and the return value
+        Tolerated race with "updated" and the return value. Only write when changed to avoid contending for the cache line.
      */
-    address->updated = net->http->now;
+    if (address->updated != net->http->now) {
+        address->updated = net->http->now;
+    }
+    if (net->http->shared && counterIndex < HTTP_SHARED_COUNTERS) {
+        return sharedEvent(net->http, net, address, counterIndex, adj);
+    }
     return counter->value;
 }
 
 
+/*
+    Update the shared counters and refresh bans and delays imposed by the monitoring process
+ */
+static int64 sharedEvent(Http *http, HttpNet *net, HttpAddress *address, int counterIndex, int64 adj)
+{
+    HttpSharedClient    *cp;
+
+    cp = address->shared;
+    if (!cp || cp->key != address->sharedKey || !cp->ready) {
+        if ((cp = lookupSharedClient(http->shared, net->ip, 1)) == 0) {
+            /* Shared segment is full */
+            address->shared = 0;
+            return address->counters[counterIndex].value;
+        }
+        address->shared = cp;
+        address->sharedKey = cp->key;
+    }
+    mprAtomicAdd64(&cp->counters[counterIndex], adj);
+    mprAtomicAdd64(&http->shared->counters[counterIndex], adj);
+    cp->updated = http->now;
+    address->banUntil = cp->banUntil;
+    address->banStatus = cp->banStatus;
+    if (cp->delayUntil > http->now) {
+        address->delayUntil = cp->delayUntil;
+        address->delay = (int) cp->delay;
+    }
+    return cp->counters[counterIndex];
+}
+
+
+/*
+    Find a client in the shared open-addressed table. Slots are claimed by compare and swap on the key.
+    Racing inserts of the same IP see the claimed key and wait for the slot to be ready.
+ */
+static HttpSharedClient *lookupSharedClient(HttpSharedCounters *shared, cchar *ip, bool add)
+{
+    HttpSharedClient    *clients, *cp, *slot;
+    void                *key, *expected;
+    uint                hash, mask, i, n;
+    int                 spin;
+
+    clients = (HttpSharedClient*) &shared[1];
+    hash = shash(ip, slen(ip));
+    key = (void*) (((ssize) hash << 1) | 2);
+    mask = shared->clients - 1;
+
+    while (1) {
+        slot = 0;
+        cp = 0;
+        for (n = 0, i = hash & mask; n <= mask; n++, i = (i + 1) & mask) {
+            cp = &clients[i];
+            if (cp->key == 0) {
+                break;
+            }
+            if (cp->key == HTTP_SHARED_TOMBSTONE) {
+                if (!slot) {
+                    slot = cp;
+                }
+                continue;
+            }
+            if (cp->key == key) {
+                for (spin = 0; !cp->ready && spin < 1000; spin++) {
+                    mprAtomicBarrier();
+                }
+                if (cp->ready && smatch(cp->ip, ip)) {
+                    return cp;
+                }
+            }
+        }
+        if (!add) {
+            return 0;
+        }
+        if (!slot) {
+            if (n > mask) {
+                return 0;
+            }
+            slot = cp;
+        }
+        expected = slot->key;
+        if (expected != 0 && expected != HTTP_SHARED_TOMBSTONE) {
+            continue;
+        }
+        if (mprAtomicCas(&slot->key, expected, key)) {
+            break;
+        }
+    }
+    /*
+        A reclaimed slot may have been updated by a late writer after it was pruned, so reset it before use
+     */
+    memset((char*) slot->counters, 0, sizeof(slot->counters));
+    slot->banUntil = 0;
+    slot->banStatus = 0;
+    slot->delayUntil = slot->delay = 0;
+    scopy(slot->ip, sizeof(slot->ip), ip);
+    slot->updated = mprGetTicks();
+    mprAtomicBarrier();
+    slot->ready = 1;
+    mprAtomicAdd64(&shared->active, 1);
+    return slot;
+}
+
+
+PUBLIC int httpOpenSharedCounters(cchar *path, int clients, bool create)
+{
+#if ME_UNIX_LIKE
+    Http                *http;
+    HttpSharedCounters  *shared;
+    struct stat         info;
+    int64               size;
+    int                 fd, count;
+
+    http = HTTP;
+    if (http->shared) {
+        return 0;
+    }
+    for (count = 16; count < clients; count <<= 1) ;
+
+    if (create) {
+        size = sizeof(HttpSharedCounters) + count * sizeof(HttpSharedClient);
+        if ((fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+            mprLog("error http monitor", 0, "Cannot create shared counters %s, errno %d", path, errno);
+            return MPR_ERR_CANT_CREATE;
+        }
+        if (ftruncate(fd, size) < 0) {
+            mprLog("error http monitor", 0, "Cannot size shared counters %s, errno %d", path, errno);
+            close(fd);
+            return MPR_ERR_CANT_WRITE;
+        }
+    } else {
+        if ((fd = open(path, O_RDWR | O_CLOEXEC)) < 0) {
+            mprLog("error http monitor", 0, "Cannot open shared counters %s, errno %d", path, errno);
+            return MPR_ERR_CANT_OPEN;
+        }
+        if (fstat(fd, &info) < 0 || info.st_size < (MprOff) sizeof(HttpSharedCounters)) {
+            mprLog("error http monitor", 0, "Shared counters %s are not initialized", path);
+            close(fd);
+            return MPR_ERR_BAD_STATE;
+        }
+        size = info.st_size;
+    }
+    if ((shared = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        mprLog("error http monitor", 0, "Cannot map shared counters %s, errno %d", path, errno);
+        close(fd);
+        return MPR_ERR_CANT_ALLOCATE;
+    }
+    if (create) {
+        shared->version = HTTP_SHARED_VERSION;
+        shared->clients = count;
+        shared->ncounters = HTTP_SHARED_COUNTERS;
+        shared->size = size;
+        shared->created = mprGetTime();
+        shared->createdTicks = mprGetTicks();
+        shared->owner = getpid();
+        mprAtomicBarrier();
+        shared->magic = HTTP_SHARED_MAGIC;
+
+    } else if (shared->magic != HTTP_SHARED_MAGIC || shared->version != HTTP_SHARED_VERSION ||
+            shared->ncounters != HTTP_SHARED_COUNTERS ||
+            shared->size != (int64) (sizeof(HttpSharedCounters) + shared->clients * sizeof(HttpSharedClient)) ||
+            shared->size > size) {
+        mprLog("error http monitor", 0, "Shared counters %s have an incompatible layout", path);
+        munmap(shared, size);
+        close(fd);
+        return MPR_ERR_BAD_FORMAT;
+    }
+    http->sharedFd = fd;
+    http->sharedOwner = create;
+    http->shared = shared;
+    if (create) {
+        /*
+            The owner checks monitors even if it does not accept connections itself (prefork master)
+         */
+        startMonitors();
+    }
+    return 0;
+#else
+    mprLog("error http monitor", 0, "Shared counters are not supported on this platform");
+    return MPR_ERR_BAD_STATE;
+#endif
+}
+
+
+PUBLIC void httpCloseSharedCounters()
+{
+#if ME_UNIX_LIKE
+    Http                *http;
+    HttpSharedCounters  *shared;
+
+    http = HTTP;
+    if ((shared = http->shared) != 0) {
+        http->shared = 0;
+        munmap(shared, shared->size);
+        close(http->sharedFd);
+        http->sharedFd = -1;
+    }
+#endif
+}
+
+
 PUBLIC int64 httpMonitorEvent(HttpStream *stream, int counterIndex, int64 adj)
 {
     return httpMonitorNetEvent(stream->net, counterIndex, adj);
@@ -492,22 +947,39 @@ PUBLIC int httpAddDefenseFromJson(cchar *name, cchar *remedy, MprJson *jargs)
 
 PUBLIC void httpDumpCounters()
 {
-    Http            *http;
-    HttpAddress     *address;
-    HttpCounter     *counter;
-    MprKey          *kp;
-    cchar           *name;
-    int             i;
+    Http                *http;
+    HttpAddress         *address;
+    HttpCounter         *counter;
+    HttpSharedCounters  *shared;
+    HttpSharedClient    *cp;
+    cchar               *name;
+    int                 i, j;
 
     http = HTTP;
     mprLog(0, 0, "Monitor Counters:\n");
     mprLog(0, 0, "Memory counter     %'zd\n", mprGetMem());
     mprLog(0, 0, "Active processes   %d\n", mprGetListLength(MPR->cmdService->cmds));
-    mprLog(0, 0, "Active clients     %d\n", mprGetHashLength(http->addresses));
+    mprLog(0, 0, "Active clients     %d\n", httpGetAddressCount());
 
-    lock(http->addresses);
-    for (ITERATE_KEY_DATA(http->addresses, kp, address)) {
-        mprLog(0, 0, "Client             %s\n", kp->key);
+    if ((shared = http->shared) != 0) {
+        mprLog(0, 0, "Shared clients     %'lld of %d\n", shared->active, shared->clients);
+        for (i = 0; i < HTTP_SHARED_COUNTERS && (name = mprGetItem(http->counters, i)) != 0; i++) {
+            mprLog(0, 0, "  Total            %s = %'lld\n", name, shared->counters[i]);
+        }
+        cp = (HttpSharedClient*) &shared[1];
+        for (i = 0; i < shared->clients; i++, cp++) {
+            if (!cp->ready) {
+                continue;
+            }
+            mprLog(0, 0, "Shared client      %s\n", cp->ip);
+            for (j = 0; j < HTTP_SHARED_COUNTERS && (name = mprGetItem(http->counters, j)) != 0; j++) {
+                mprLog(0, 0, "  Counter          %s = %'lld\n", name, cp->counters[j]);
+            }
+        }
+    }
+
+    for (address = 0; (address = httpGetNextAddress(address)) != 0; ) {
+        mprLog(0, 0, "Client             %s\n", address->ip);
         for (i = 0; i < address->ncounters; i++) {
             counter = &address->counters[i];
             name = mprGetItem(http->counters, i);
@@ -517,32 +989,125 @@ PUBLIC void httpDumpCounters()
             mprLog(0, 0, "  Counter          %s = %'lld\n", name, counter->value);
         }
     }
-    unlock(http->addresses);
 }
 
 
-/************************************ Remedies ********************************/
+/************************************* Rates **********************************/
 
-PUBLIC int httpBanClient(cchar *ip, MprTicks period, int status, cchar *msg)
+PUBLIC HttpRate *httpCreateRate(int64 rate, int64 burst, int status, MprTicks defer)
+{
+    HttpRate    *rp;
+
+    if (rate <= 0) {
+        return 0;
+    }
+    if ((rp = mprAllocObj(HttpRate, 0)) == 0) {
+        return 0;
+    }
+    if (burst <= 0) {
+        burst = rate;
+    }
+    rp->interval = max(1000000 / rate, 1);
+    rp->window = burst * rp->interval;
+    rp->status = status;
+    rp->defer = defer;
+    return rp;
+}
+
+
+/*
+    Generic cell rate algorithm. The tat is the time when the bucket will be full again. A request is admitted if
+    taking a token does not move the tat more than the burst window beyond now.
+ */
+PUBLIC MprTicks httpCheckRate(HttpRate *rate, volatile int64 *tat, MprTicks now, MprTicks defer)
+{
+    int64   next, usec, wait;
+
+    usec = now * 1000;
+    next = max(*tat, usec) + rate->interval;
+    wait = next - usec - rate->window;
+    if (wait <= 0) {
+        *tat = next;
+        return 0;
+    }
+    wait = (wait + 999) / 1000;
+    if (wait <= defer) {
+        /* Reserve the token */
+        *tat = next;
+    }
+    return wait;
+}
+
+
+static void rateError(HttpStream *stream, HttpRate *rate, MprTicks wait, cchar *msg)
+{
+    httpSetHeader(stream, "Retry-After", "%lld", (wait + 999) / TPS);
+    httpLimitError(stream, rate->status ? rate->status : HTTP_CODE_TOO_MANY_REQUESTS, "%s", msg);
+}
+
+
+PUBLIC bool httpCheckRequestRate(HttpStream *stream)
 {
     Http            *http;
     HttpAddress     *address;
-    MprTicks        banUntil;
+    HttpRate        *rate;
+    MprTicks        now, wait;
+
+    http = stream->http;
+    now = mprGetTicks();
+    if ((rate = http->requestRate) != 0 && (address = stream->net->address) != 0) {
+        if ((wait = httpCheckRate(rate, &address->requestTat, now, 0)) > 0) {
+            rateError(stream, rate, wait, "Too many requests from client");
+            return 0;
+        }
+    }
+    if ((rate = stream->rx->route->rate) != 0) {
+        if ((wait = httpCheckRate(rate, &rate->tat, now, 0)) > 0) {
+            rateError(stream, rate, wait, "Too many requests for route");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/************************************ Remedies ********************************/
+
+PUBLIC int httpBanClient(cchar *ip, MprTicks period, int status, cchar *msg)
+{
+    Http                *http;
+    HttpAddress         *address;
+    HttpSharedClient    *cp;
+    MprTicks            banUntil;
 
     http = HTTP;
-    if ((address = mprLookupKey(http->addresses, ip)) == 0) {
+    address = httpLookupAddress(ip);
+    cp = http->shared ? lookupSharedClient(http->shared, ip, 0) : 0;
+    if (!address && !cp) {
         mprLog("error http monitor", 1, "Cannot find client %s to ban", ip);
         return MPR_ERR_CANT_FIND;
     }
-    if (address->banUntil < http->now) {
-        httpLog(http->trace, "monitor.ban.start", "error", "client:'%s', duration:%lld", ip, period / 1000);
-    }
     banUntil = http->now + period;
-    address->banUntil = max(banUntil, address->banUntil);
-    if (msg && *msg) {
-        address->banMsg = sclone(msg);
+    if (cp) {
+        /*
+            Other processes apply the ban on the next event for this client. The ban message is not shared.
+         */
+        if (cp->banUntil < http->now) {
+            httpLog(http->trace, "monitor.ban.start", "error", "client:'%s', duration:%lld", ip, period / 1000);
+        }
+        cp->banStatus = status;
+        cp->banUntil = max(banUntil, cp->banUntil);
+    }
+    if (address) {
+        if (!cp && address->banUntil < http->now) {
+            httpLog(http->trace, "monitor.ban.start", "error", "client:'%s', duration:%lld", ip, period / 1000);
+        }
+        address->banUntil = max(banUntil, address->banUntil);
+        if (msg && *msg) {
+            address->banMsg = sclone(msg);
+        }
+        address->banStatus = status;
     }
-    address->banStatus = status;
     return 0;
 }
 
@@ -624,20 +1189,29 @@ static void cmdRemedy(MprHash *args)
 
 static void delayRemedy(MprHash *args)
 {
-    Http            *http;
-    HttpAddress     *address;
-    MprTicks        delayUntil;
-    cchar           *ip;
-    int             delay;
+    Http                *http;
+    HttpAddress         *address;
+    HttpSharedClient    *cp;
+    MprTicks            delayUntil;
+    cchar               *ip;
+    int                 delay;
 
     http = HTTP;
     if ((ip = mprLookupKey(args, "IP")) != 0) {
-        if ((address = mprLookupKey(http->addresses, ip)) != 0) {
-            delayUntil = http->now + lookupTicks(args, "PERIOD", ME_HTTP_DELAY_PERIOD);
+        delayUntil = http->now + lookupTicks(args, "PERIOD", ME_HTTP_DELAY_PERIOD);
+        delay = (int) lookupTicks(args, "DELAY", ME_HTTP_DELAY);
+        cp = http->shared ? lookupSharedClient(http->shared, ip, 0) : 0;
+        if (cp) {
+            cp->delayUntil = max(delayUntil, cp->delayUntil);
+            cp->delay = max(delay, cp->delay);
+            httpLog(http->trace, "monitor.delay.start", "context", "client:'%s', delay:%lld", ip, cp->delay);
+        }
+        if ((address = httpLookupAddress(ip)) != 0) {
             address->delayUntil = max(delayUntil, address->delayUntil);
-            delay = (int) lookupTicks(args, "DELAY", ME_HTTP_DELAY);
             address->delay = max(delay, address->delay);
-            httpLog(http->trace, "monitor.delay.start", "context", "client:'%s', delay:%d", ip, address->delay);
+            if (!cp) {
+                httpLog(http->trace, "monitor.delay.start", "context", "client:'%s', delay:%d", ip, address->delay);
+            }
         }
     }
 }
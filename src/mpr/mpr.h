@@ -105,6 +105,9 @@ struct  MprXml;
 #ifndef ME_MPR_THREAD_LIMIT_BY_CORES
     #define ME_MPR_THREAD_LIMIT_BY_CORES 1
 #endif
+#ifndef ME_MPR_WORKER_QUEUE
+    #define ME_MPR_WORKER_QUEUE 256     /**< Max jobs queued when all workers are busy. Zero to disable queueing */
+#endif
 
 /*
     Select wakeup port. Port can be any free port number. If this is not free, the MPR will use the next free port.
@@ -157,6 +160,8 @@ struct  MprXml;
  */
 #define MPR_DEFAULT_MIN_THREADS 0           /**< Default min threads */
 #define MPR_DEFAULT_MAX_THREADS 5           /**< Default max threads */
+#define MPR_MAX_CPU             1024        /**< Highest CPU number accepted for worker affinity */
+#define MPR_WORKERS_PER_CPU     2           /**< Workers pinned to a CPU before idle workers on other CPUs are used */
 
 /*
     Debug control
@@ -352,9 +357,9 @@ PUBLIC void assert(bool cond);
 /*********************************** Thread Sync ******************************/
 /**
     Multithreaded Synchronization Services
-    @see MprCond MprMutex MprSpin mprAtomicAdd mprAtomicAdd64 mprAtomicBarrier mprAtomicCas mprAtomicExchange
-        mprAtomicListInsert mprCreateCond mprCreateLock mprCreateSpinLock mprGlobalLock mprGlobalUnlock mprInitLock
-        mprInitSpinLock mprLock mprResetCond mprSignalCond mprSignalMultiCond mprSpinLock mprSpinUnlock mprTryLock
+    @see MprCond MprMutex MprSpin mprAtomicAdd mprAtomicAdd64 mprAtomicAddFetch mprAtomicBarrier mprAtomicCas
+        mprAtomicExchange mprAtomicListInsert mprCreateCond mprCreateLock mprCreateSpinLock mprGlobalLock mprGlobalUnlock
+        mprInitLock mprInitSpinLock mprLock mprResetCond mprSignalCond mprSignalMultiCond mprSpinLock mprSpinUnlock mprTryLock
         mprTrySpinLock mprUnlock mprWaitForCond mprWaitForMultiCond
     @stability Internal.
     @defgroup MprSync MprSync
@@ -715,6 +720,16 @@ PUBLIC int mprAtomicCas(void * volatile * target, void *expected, cvoid *value);
  */
 PUBLIC void mprAtomicAdd(volatile int *target, int value);
 
+/**
+    Atomic Add and return the result. This is a lock free function.
+    @param target Address of the target word to add to.
+    @param value Value to add to the target
+    @return The value of the target after the addition
+    @ingroup MprSync
+    @stability Evolving
+ */
+PUBLIC int mprAtomicAddFetch(volatile int *target, int value);
+
 /**
     Atomic 64 bit Add. This is a lock free function.
     @param target Address of the target word to add to.
@@ -793,6 +808,16 @@ PUBLIC void mprAtomicAdd64(volatile int64 *target, int64 value);
 #ifndef ME_MPR_ALLOC_REGION_SIZE
     #define ME_MPR_ALLOC_REGION_SIZE (256 * 1024)       /* Memory region allocation chunk size */
 #endif
+#ifndef ME_MPR_ALLOC_THREAD_CACHE
+    #if ME_UNIX_LIKE
+        #define ME_MPR_ALLOC_THREAD_CACHE 1             /* Per-thread caches of free blocks */
+    #else
+        #define ME_MPR_ALLOC_THREAD_CACHE 0
+    #endif
+#endif
+#ifndef ME_MPR_GC_SWEEPERS
+    #define ME_MPR_GC_SWEEPERS 0                        /* GC sweeper threads. Zero for one per 8 CPU cores */
+#endif
 
 #ifndef ME_MPR_ALLOC_ALIGN_SHIFT
     /*
@@ -958,6 +983,20 @@ typedef struct MprFreeQueue {
 #define MPR_ALLOC_BITMAP_BITS       BITS(size_t)
 #define MPR_ALLOC_NUM_BITMAPS       ((MPR_ALLOC_NUM_QUEUES + MPR_ALLOC_BITMAP_BITS - 1) / MPR_ALLOC_BITMAP_BITS)
 
+/*
+    Per-thread caches serve the small block queues (user sizes up to 2K). Blocks move between a thread cache and the
+    heap free queues in batches so that the queue lock is acquired once per batch rather than once per allocation.
+    Empty bins are carved from a single heap block of MPR_ALLOC_CACHE_CARVE bytes.
+ */
+#define MPR_ALLOC_CACHE_QUEUES      28
+#define MPR_ALLOC_CACHE_BATCH       16
+#define MPR_ALLOC_CACHE_CARVE       4096
+
+/*
+    Default chunk size for arenas. Allocations larger than a quarter chunk are given a dedicated chunk.
+ */
+#define MPR_ARENA_CHUNK             8192
+
 /*
     Pointer to MprMem and vice-versa
  */
@@ -1060,6 +1099,16 @@ typedef struct MprLocationStats {
 #endif
 
 
+/*
+    GC pause histogram buckets. Bucket N counts pauses under (128 << N) microseconds. The last bucket counts longer pauses.
+ */
+#define MPR_GC_PAUSE_BUCKETS 12
+
+/*
+    Maximum number of threads that sweep the heap in parallel
+ */
+#define MPR_MAX_SWEEPERS 16
+
 /**
     Memory allocator statistics
     @ingroup MprMem
@@ -1085,6 +1134,24 @@ typedef struct MprMemStats {
     uint64          warnHeap;               /**< Warn if heap size exceeds this level */
     uint64          swept;                  /**< Number of blocks swept */
     uint64          sweptBytes;             /**< Number of bytes swept */
+    uint            threadCaches;           /**< Number of per-thread allocation caches */
+    uint64          threadCacheBytes;       /**< Bytes held in per-thread allocation caches */
+    uint64          threadCacheHits;        /**< Allocations served from per-thread caches */
+    uint64          threadCacheMisses;      /**< Allocations that could not be served from per-thread caches */
+    uint64          threadCacheRefills;     /**< Batches moved from the heap free queues to per-thread caches */
+    uint64          threadCacheFlushes;     /**< Per-thread caches returned to the heap free queues */
+    uint64          gcPauses;               /**< Number of GC pauses where threads were stopped for marking */
+    uint64          gcPauseTotal;           /**< Total time threads were stopped for marking (usec) */
+    uint64          gcPauseLast;            /**< Most recent GC pause (usec) */
+    uint64          gcPauseMax;             /**< Longest GC pause (usec) */
+    uint64          gcSyncMax;              /**< Longest wait for all threads to yield (usec) */
+    uint64          gcMarkMax;              /**< Longest mark phase (usec) */
+    uint64          gcPauseHistogram[MPR_GC_PAUSE_BUCKETS]; /**< Pause counts by duration. See MPR_GC_PAUSE_BUCKETS */
+    uint            sweepers;               /**< Number of threads sweeping the heap in parallel */
+    uint64          sweepTime;              /**< Duration of the last sweep (usec) */
+    uint64          sweepTimeTotal;         /**< Total time spent sweeping (usec) */
+    uint64          sweepScanned;           /**< Total bytes of heap regions scanned by the sweeper */
+    uint64          sweptBytesTotal;        /**< Total bytes freed by the sweeper */
 #if ME_MPR_ALLOC_STATS
     /*
         Extended memory stats
@@ -1114,6 +1181,27 @@ typedef struct MprMemStats {
 } MprMemStats;
 
 
+/**
+    Per-thread cache of free blocks
+    @description Each thread allocating from the heap has a cache of free blocks for the small block queues.
+        Cached blocks are held as eternal blocks so the sweeper will neither collect nor coalesce them. Caches are
+        refilled from the heap free queues in batches and flushed back when the thread exits or the heap runs low.
+    @ingroup MprMem
+    @stability Internal.
+ */
+typedef struct MprThreadCache {
+    struct MprThreadCache *next;            /**< Next cache in the heap list of caches */
+    MprFreeMem      *bins[MPR_ALLOC_CACHE_QUEUES];  /**< Cached free blocks for each queue */
+    uint            counts[MPR_ALLOC_CACHE_QUEUES]; /**< Number of blocks in each bin */
+    uint64          bytes;                  /**< Bytes held in the cache */
+    uint64          hits;                   /**< Allocations served from the cache */
+    uint64          misses;                 /**< Allocations that could not be served from the cache */
+    uint64          refills;                /**< Batches moved from the free queues */
+    uint64          flushes;                /**< Times the cache was returned to the free queues */
+    size_t          owned;                  /**< Cache is in use by a thread. Must be size_t for cas() */
+    int             generation;             /**< Flush generation last observed by the owning thread */
+} MprThreadCache;
+
 /**
     Memmory regions allocated from the O/S
     @ingroup MprMem
@@ -1141,7 +1229,20 @@ typedef struct MprHeap {
     MprMemNotifier   notifier;              /**< Memory allocation failure callback */
     MprCond          *gcCond;               /**< GC sleep cond var */
     MprRegion        *regions;              /**< List of memory regions */
+#if ME_MPR_ALLOC_THREAD_CACHE
+    MprThreadCache   *caches;               /**< List of per-thread caches */
+    pthread_key_t    cacheKey;              /**< Thread data key for the current thread cache */
+    int              cacheGeneration;       /**< Incremented to request all thread caches be flushed */
+#endif
     struct MprThread *sweeper;              /**< GC sweeper thread */
+    struct MprSweeper *sweepers;            /**< Helper threads that share the sweep of heap regions */
+    MprCond          *sweepDone;            /**< Signalled as sweeper helpers complete */
+    MprRegion        **sweepList;           /**< Regions to sweep in the current cycle */
+    int              sweepCount;            /**< Number of regions in sweepList */
+    int              sweepMax;              /**< Allocated size of sweepList */
+    size_t           sweepNext;             /**< Index of the next region to claim from sweepList */
+    int              sweepPending;          /**< Sweeper helpers yet to complete the current cycle */
+    int              sweepHelpers;          /**< Number of active sweeper helpers */
     int              allocPolicy;           /**< Memory allocation depletion policy */
     int              regionSize;            /**< Memory allocation region size */
     int              compact;               /**< Next GC sweep should do a full compact */
@@ -1313,6 +1414,86 @@ PUBLIC size_t mprMemcpy(void *dest, size_t destMax, cvoid *src, size_t nbytes);
  */
 PUBLIC void *mprMemdup(cvoid *ptr, size_t size);
 
+/**
+    Request scoped arena for short-lived allocations
+    @description Arenas provide fast bump-pointer allocation for temporaries that share a common lifespan. Arena memory
+        is carved from large chunks that are retained by the arena object. Each arena allocation carries a memory
+        header so it may be safely passed to mprMark and other MPR routines. Individual arena allocations are never
+        collected; all arena memory is released at once when the arena is reset or is no longer referenced.
+        Arena memory must not be referenced after the arena is reset. Use #mprArenaPromote to copy a value
+        that must outlive the arena onto the garbage collected heap.
+    @see mprArenaAlloc mprArenaClone mprArenaContains mprArenaPromote mprCreateArena mprResetArena
+    @ingroup MprMem
+    @stability Prototype
+ */
+typedef struct MprArena {
+    struct MprArenaChunk *chunks;           /**< Chunks with the current chunk first */
+    size_t          chunkSize;              /**< Default chunk size */
+    size_t          allocated;              /**< Bytes allocated since the arena was last reset */
+} MprArena;
+
+/**
+    Allocate a block from an arena
+    @description The allocated block is not zeroed and lives until the arena is reset.
+    @param arena Arena object created via #mprCreateArena
+    @param size Size of the block to allocate.
+    @return Returns a pointer to the allocated block. Returns NULL if memory cannot be allocated.
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC void *mprArenaAlloc(MprArena *arena, size_t size);
+
+/**
+    Clone a string into an arena
+    @param arena Arena object created via #mprCreateArena
+    @param str String to clone. If NULL, an empty string is returned.
+    @return Returns a string allocated from the arena.
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC char *mprArenaClone(MprArena *arena, cchar *str);
+
+/**
+    Test if a block was allocated from an arena
+    @param arena Arena object created via #mprCreateArena
+    @param ptr Block to test
+    @return True if the block resides in the arena.
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC bool mprArenaContains(MprArena *arena, cvoid *ptr);
+
+/**
+    Promote an arena block to the garbage collected heap
+    @description If the block resides in the arena, it is copied to a new garbage collected block. Otherwise the
+        block is returned unchanged. Use this for values that must outlive the arena.
+    @param arena Arena object created via #mprCreateArena
+    @param ptr Block to promote
+    @return A block that is independent of the arena.
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC void *mprArenaPromote(MprArena *arena, cvoid *ptr);
+
+/**
+    Create an arena
+    @param chunkSize Size of the chunks used to satisfy arena allocations. Set to zero for a default size.
+    @return The arena object.
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC MprArena *mprCreateArena(size_t chunkSize);
+
+/**
+    Reset an arena
+    @description Release all memory allocated from the arena. The first chunk is retained and reused for
+        subsequent allocations. All blocks previously allocated from the arena become invalid.
+    @param arena Arena object created via #mprCreateArena
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC void mprResetArena(MprArena *arena);
+
 #define MPR_MEM_DETAIL      0x1     /* Print a detailed report */
 
 /**
@@ -1635,6 +1816,16 @@ PUBLIC int mprGC(int flags);
  */
 PUBLIC bool mprEnableGC(bool on);
 
+/**
+    Set the number of threads that sweep the heap
+    @description The heap regions are partitioned across the sweeper threads so that large heaps can be swept in
+        parallel. The default is defined by ME_MPR_GC_SWEEPERS or one thread per 8 CPU cores if zero.
+    @param count Number of sweeper threads including the primary GC thread. Limited to MPR_MAX_SWEEPERS.
+    @ingroup MprMem
+    @stability Prototype
+ */
+PUBLIC void mprSetGCSweepers(int count);
+
 
 /**
     Hold a memory block
@@ -5832,6 +6023,14 @@ PUBLIC int mprUnloadModule(MprModule *mp);
 
 #define MPR_EVENT_MAX_PERIOD (MAXINT64 / 2)
 
+/*
+    Timer wheel geometry. Each level has MPR_TIMER_SLOTS slots and each slot spans MPR_TIMER_SLOTS times the
+    period of the level below. With 1 msec ticks, four levels cover 4.6 hours. Longer timers are cascaded.
+ */
+#define MPR_TIMER_BITS              6
+#define MPR_TIMER_SLOTS             (1 << MPR_TIMER_BITS)
+#define MPR_TIMER_LEVELS            4
+
 /**
     Event callback function
     @ingroup MprEvent
@@ -5865,6 +6064,10 @@ typedef struct MprEvent {
     MprTicks                period;             /**< Reschedule period */
     struct MprEvent         *next;              /**< Next event linkage */
     struct MprEvent         *prev;              /**< Previous event linkage */
+    struct MprEvent         *timerNext;         /**< Next timer in the same timer wheel slot */
+    struct MprEvent         *timerPrev;         /**< Previous timer in the same timer wheel slot */
+    int                     wheel;              /**< Timer wheel slot plus one. Zero if not in the wheel */
+    struct MprEvent         *inboxNext;         /**< Next event in the dispatcher inbox. Self if last. Zero if not posted */
     struct MprDispatcher    *dispatcher;        /**< Event dispatcher service */
     struct MprWaitHandler   *handler;           /**< Optional wait handler */
     MprCond                 *cond;              /**< Wait for event to complete */
@@ -5886,8 +6089,10 @@ typedef struct MprEvent {
  */
 typedef struct MprDispatcher {
     cchar           *name;              /**< Static debug dispatcher name / purpose */
-    MprEvent        *eventQ;            /**< Event queue */
+    MprEvent        *eventQ;            /**< Queue of due events */
+    MprEvent        *timerQ;            /**< Unordered queue of future timer events (also in the timer wheel) */
     MprEvent        *currentQ;          /**< Currently executing events */
+    MprEvent * volatile inbox;          /**< Lock-free stack of due events posted by any thread, newest first */
     MprCond         *cond;              /**< Multi-thread sync */
     int             flags;              /**< Dispatcher control flags */
     int64           mark;               /**< Last event sequence mark (may reuse over time) */
@@ -5896,6 +6101,7 @@ typedef struct MprDispatcher {
     struct MprDispatcher *parent;       /**< Queue pointer */
     struct MprEventService *service;    /**< Event service reference */
     MprOsThread     owner;              /**< Thread currently dispatching events, otherwise zero */
+    int             cpu;                /**< CPU preferred for workers servicing this dispatcher. Set to -1 for any */
 } MprDispatcher;
 
 
@@ -5909,13 +6115,16 @@ typedef struct MprEventService {
     MprTicks        willAwake;          /**< When the event service will next awake */
     MprDispatcher   *runQ;              /**< Queue of running dispatchers */
     MprDispatcher   *readyQ;            /**< Queue of dispatchers with events ready to run */
-    MprDispatcher   *waitQ;             /**< Queue of waiting (future) events */
+    MprDispatcher   *waitQ;             /**< Queue of dispatchers with only future timers */
     MprDispatcher   *idleQ;             /**< Queue of idle dispatchers */
     MprDispatcher   *pendingQ;          /**< Queue of pending dispatchers (waiting for resources) */
     MprOsThread     serviceThread;      /**< Thread running the dispatcher service */
     MprTicks        delay;              /**< Maximum sleep time before awaking */
     int             eventCount;         /**< Count of events */
     int             waiting;            /**< Waiting for I/O (sleeping) */
+    int             timerCount;         /**< Number of timers in the timer wheel */
+    MprTicks        wheelTime;          /**< Time up to which the timer wheel has been expired */
+    MprEvent        *wheel[MPR_TIMER_LEVELS * MPR_TIMER_SLOTS]; /**< Hierarchical timer wheel of future events */
     struct MprCond  *waitCond;          /**< Waiting sync */
     struct MprMutex *mutex;             /**< Multi-thread sync */
 } MprEventService;
@@ -6130,7 +6339,8 @@ PUBLIC MprEvent *mprCreateTimerEvent(MprDispatcher *dispatcher, cchar *name, Mpr
 
 /*
     Queue a new event for service.
-    @description Queue an event for service
+    @description Queue an event for service. Events that are due immediately are posted to the dispatcher inbox
+        without locking. Only the first event posted to an empty inbox schedules the dispatcher.
     @param dispatcher Dispatcher object created via mprCreateDispatcher
     @param event Event object to queue
     @ingroup MprEvent
@@ -6186,6 +6396,19 @@ PUBLIC void mprEnableContinuousEvent(MprEvent *event, int enable);
  */
 PUBLIC void mprRescheduleEvent(MprEvent *event, MprTicks period);
 
+/**
+    Bind a dispatcher to a CPU
+    @description When worker CPU affinity is enabled via #mprSetWorkerAffinity, events for the dispatcher are
+        preferentially serviced by workers pinned to the selected CPU. This keeps a connection's processing and
+        caches on one core for its lifetime. If affinity is not enabled, this call has no effect.
+    @param dispatcher Dispatcher object created via #mprCreateDispatcher
+    @param cpu Hint of the CPU to use, such as the CPU that received the socket data via #mprGetSocketCpu.
+        If the CPU is not in the affinity set, it is mapped onto the set. Set to -1 to select CPUs round-robin.
+    @stability Evolving
+    @ingroup MprEvent
+ */
+PUBLIC void mprSetDispatcherCpu(MprDispatcher *dispatcher, int cpu);
+
 /**
     Start a dispatcher by setting it on the run queue
     @description This is used to ensure that all event activity will only happen on the thread that
@@ -6213,9 +6436,12 @@ PUBLIC void mprDedicateWorkerToDispatcher(MprDispatcher *dispatcher, struct MprW
 PUBLIC void mprDequeueEvent(MprEvent *event);
 PUBLIC bool mprDispatcherHasEvents(MprDispatcher *dispatcher);
 PUBLIC int mprDispatchersAreIdle(void);
+PUBLIC void mprDrainInbox(MprDispatcher *dispatcher);
+PUBLIC void mprExpireTimers(MprEventService *es);
 PUBLIC int mprGetEventCount(MprDispatcher *dispatcher);
 PUBLIC MprEvent *mprGetNextEvent(MprDispatcher *dispatcher);
 PUBLIC MprDispatcher *mprGetNonBlockDispatcher(void);
+PUBLIC MprTicks mprGetTimerDelay(MprEventService *es);
 PUBLIC void mprInitEventQ(MprEvent *q);
 PUBLIC void mprQueueTimerEvent(MprDispatcher *dispatcher, MprEvent *event);
 PUBLIC void mprReleaseWorkerFromDispatcher(MprDispatcher *dispatcher, struct MprWorker *worker);
@@ -7597,6 +7823,7 @@ PUBLIC void mprSetSocketPrebindCallback(MprSocketPrebind callback);
 #define MPR_SOCKET_SERVER           0x400   /**< Socket is on the server-side */
 #define MPR_SOCKET_BUFFERED_READ    0x800   /**< Socket has buffered read data (in SSL stack) */
 #define MPR_SOCKET_BUFFERED_WRITE   0x1000  /**< Socket has buffered write data (in SSL stack) */
+#define MPR_SOCKET_REUSEPORT        0x2000  /**< Set SO_REUSEPORT so multiple processes can listen on the endpoint */
 #define MPR_SOCKET_DISCONNECTED     0x4000  /**< The mprDisconnectSocket has been called */
 #define MPR_SOCKET_HANDSHAKING      0x8000  /**< Doing an SSL handshake */
 #define MPR_SOCKET_CERT_ERROR       0x10000 /**< Error when validating peer certificate */
@@ -7780,6 +8007,17 @@ PUBLIC bool mprGetSocketBlockingMode(MprSocket *sp);
  */
 PUBLIC int mprGetSocketError(MprSocket *sp);
 
+/**
+    Get the CPU that received data for a socket
+    @description This returns the CPU that last processed incoming packets for the socket. When the network interface
+        spreads connections over receive queues (RSS), this identifies the core servicing the connection's queue.
+    @param sp Socket object returned from #mprCreateSocket
+    @return The CPU number or -1 if not supported on this platform.
+    @ingroup MprSocket
+    @stability Evolving
+ */
+PUBLIC int mprGetSocketCpu(MprSocket *sp);
+
 /**
     Get the socket file descriptor.
     @description Get the file descriptor associated with a socket.
@@ -7904,6 +8142,7 @@ PUBLIC bool mprIsSocketEof(MprSocket *sp);
         @li MPR_SOCKET_DATAGRAM - Use IPv4 datagrams
         @li MPR_SOCKET_NOREUSE - Set NOREUSE flag on the socket
         @li MPR_SOCKET_NODELAY - Set NODELAY on the socket
+        @li MPR_SOCKET_REUSEPORT - Set SO_REUSEPORT so other processes may listen on the same endpoint
         @li MPR_SOCKET_THREAD - Process callbacks on a separate thread.
     @return Zero if the connection is successful. Otherwise a negative MPR error code.
     @ingroup MprSocket
@@ -8418,6 +8657,13 @@ typedef struct MprWorkerStats {
     int     idle;           /**< Number of idle workers */
     int     busy;           /**< Number of busy workers */
     int     yielded;        /**< Number of busy workers yielded for GC */
+    int     queued;         /**< Number of jobs waiting for a worker */
+    int     maxQueued;      /**< Max number of jobs ever waiting for a worker */
+    int     queueLimit;     /**< Configured max number of queued jobs */
+    int64   totalQueued;    /**< Total number of jobs that waited for a worker */
+    int64   rejected;       /**< Total number of jobs rejected because the queue was full */
+    int     queueWait;      /**< Average time in msec a queued job waited for a worker */
+    int     queueWaitMax;   /**< Max time in msec a queued job waited for a worker */
 } MprWorkerStats;
 
 /**
@@ -8446,6 +8692,18 @@ typedef struct MprWorkerService {
     MprMutex        *mutex;             /**< Per task synchronization */
     struct MprEvent *pruneTimer;        /**< Timer for excess threads pruner */
     MprWorkerProc   startWorker;        /**< Worker thread startup hook */
+    struct MprWorkerJob *queue;         /**< Ring of jobs waiting for a worker when the pool is fully busy */
+    int             queueSize;          /**< Max number of jobs in the queue */
+    int             queueHead;          /**< Index of the oldest queued job */
+    int             queueCount;         /**< Number of jobs in the queue */
+    int             maxQueued;          /**< Max jobs ever queued */
+    int64           totalQueued;        /**< Total jobs queued */
+    int64           rejected;           /**< Total jobs rejected with a full queue */
+    int64           queueWait;          /**< Total msec dequeued jobs waited for a worker */
+    MprTicks        queueWaitMax;       /**< Max msec a job waited for a worker */
+    int             *cpus;              /**< CPUs to pin workers to. Null if affinity is disabled */
+    int             numCpus;            /**< Number of CPUs in cpus */
+    int             nextCpu;            /**< Next index in cpus to assign round-robin */
 } MprWorkerService;
 
 
@@ -8503,6 +8761,35 @@ PUBLIC void mprSetMaxWorkers(int count);
  */
 PUBLIC int mprGetMaxWorkers(void);
 
+/**
+    Set the maximum count of queued worker jobs
+    @description When all worker pool threads are busy and the pool is at its maximum size, mprStartWorker queues
+        jobs in a bounded FIFO queue. Workers take queued jobs as they complete their current job. When the queue is
+        full, mprStartWorker returns MPR_ERR_BUSY. Defaults to ME_MPR_WORKER_QUEUE.
+    @param count Maximum number of queued jobs. Set to zero to disable queueing.
+    @ingroup MprWorker
+    @stability Evolving
+ */
+PUBLIC void mprSetWorkerQueueLimit(int count);
+
+/**
+    Pin worker threads to CPUs
+    @description Define the set of CPUs for worker threads. Each new worker is pinned to one CPU from the set and
+        dispatchers bound via #mprSetDispatcherCpu prefer workers on their CPU. Existing workers are not moved.
+        Only supported on Linux. Elsewhere workers are not pinned but the CPU binding of dispatchers still applies.
+    @param cpus List of CPU numbers and ranges. For example: "0-3,6". Set to "all" for all CPUs, or to null, an
+        empty string or "none" to disable affinity.
+    @return Zero if successful, otherwise MPR_ERR_BAD_ARGS if the list cannot be parsed.
+    @ingroup MprWorker
+    @stability Evolving
+ */
+PUBLIC int mprSetWorkerAffinity(cchar *cpus);
+
+/*
+    Internal
+ */
+PUBLIC int mprSelectWorkerCpu(int hint);
+
 /*
     Worker Thread State
  */
@@ -8516,7 +8803,7 @@ PUBLIC int mprGetMaxWorkers(void);
     @defgroup MprWorker MprWorker
     @see MPrWorkerProc MprWorkerService MprWorkerStats mprActivateWorker mprDedicateWorker mprGetCurrentWorker
         mprGetMaxWorkers mprGetWorkerServiceStats mprReleaseWorker mprSetMaxWorkers mprSetMinWorkers
-        mprSetWorkerStackSize mprStartWorker
+        mprSetWorkerAffinity mprSetWorkerQueueLimit mprSetWorkerStackSize mprStartWorker mprStartWorkerOnCpu
     @stability Internal
  */
 typedef struct MprWorker {
@@ -8529,6 +8816,7 @@ typedef struct MprWorker {
     MprTicks        lastActivity;           /**< When the worker was last used */
     MprWorkerService *workerService;        /**< Worker service */
     MprCond         *idleCond;              /**< Used to wait for work */
+    int             cpu;                    /**< CPU the worker thread is pinned to. Set to -1 if not pinned */
 } MprWorker;
 
 /*
@@ -8573,14 +8861,28 @@ PUBLIC void mprReleaseWorker(MprWorker *worker);
 
 /**
     Start a worker thread
-    @description Start a worker thread executing the given worker procedure callback.
+    @description Start a worker thread executing the given worker procedure callback. If all workers are busy and
+        the pool is at its maximum size, the job is queued and run by the next worker to complete its current job.
     @param proc Worker procedure callback
     @param data Data parameter to the callback
-    @returns Zero if successful, otherwise a negative MPR error code.
+    @returns Zero if successful, otherwise a negative MPR error code. Returns MPR_ERR_BUSY if the job queue is full.
     @stability Internal
  */
 PUBLIC int mprStartWorker(MprWorkerProc proc, void *data);
 
+/**
+    Start a worker thread on a CPU
+    @description Start a worker thread executing the given worker procedure callback. An idle worker pinned to the
+        requested CPU is preferred. Otherwise a new worker is pinned to the CPU if the pool may grow. If not, any idle
+        worker is used.
+    @param proc Worker procedure callback
+    @param data Data parameter to the callback
+    @param cpu Preferred CPU. Set to -1 for any CPU.
+    @returns Zero if successful, otherwise a negative MPR error code. Returns MPR_ERR_BUSY if the job queue is full.
+    @stability Internal
+ */
+PUBLIC int mprStartWorkerOnCpu(MprWorkerProc proc, void *data, int cpu);
+
 /********************************** Crypto ************************************/
 /**
     Return a random number
@@ -128,6 +128,35 @@
     static ME_INLINE int findLastBit(size_t word);
 #endif
 
+/*
+    Sweeper helper thread state. Helpers are signalled via their cond when a sweep cycle has work for them.
+ */
+typedef struct MprSweeper {
+    MprThread           *thread;        /* Helper thread */
+    MprCond             *cond;          /* Signalled to start sweeping */
+    int                 work;           /* Set when a sweep cycle is pending for this helper */
+} MprSweeper;
+
+/*
+    Statistics accumulated while sweeping a region
+ */
+typedef struct SweepStats {
+    uint64              visited;        /* Blocks examined */
+    uint64              swept;          /* Blocks freed */
+    uint64              sweptBytes;     /* Bytes freed */
+    uint64              compacted;      /* Free blocks reclaimed for joining */
+    uint64              joins;          /* Blocks joined with their predecessor */
+} SweepStats;
+
+/*
+    Arena chunk header. Arena blocks follow the header, each with its own MprMem header.
+ */
+typedef struct MprArenaChunk {
+    struct MprArenaChunk *next;         /* Next (older) chunk */
+    char                *pos;           /* Next free byte */
+    char                *end;           /* End of the chunk */
+} MprArenaChunk;
+
 #define YIELDED_THREADS     0x1         /* Resume threads that are yielded (only) */
 #define WAITING_THREADS     0x2         /* Resume threads that are waiting for GC sweep to complete */
 
@@ -142,13 +171,15 @@ static int          padding[] = { 0, MPR_MANAGER_SIZE };
 /***************************** Forward Declarations ***************************/
 
 static ME_INLINE bool acquire(MprFreeQueue *freeq);
+static MprArenaChunk *allocArenaChunk(MprArena *arena, size_t size);
 static void allocException(int cause, size_t size);
 static MprMem *allocMem(size_t size);
 static ME_INLINE int cas(size_t *target, size_t expected, size_t value);
 static ME_INLINE bool claim(MprMem *mp);
 static ME_INLINE void clearbitmap(size_t *bitmap, int bindex);
 static void dummyManager(void *ptr, int flags);
-static void freeBlock(MprMem *mp);
+static void freeBlock(MprMem *mp, SweepStats *ss);
+static ME_INLINE uint64 gcClock(void);
 static void getSystemInfo(void);
 static MprMem *growHeap(size_t size);
 static void invokeAllDestructors(void);
@@ -158,16 +189,21 @@ static ME_INLINE void linkSpareBlock(char *ptr, size_t size);
 static ME_INLINE void initBlock(MprMem *mp, size_t size, int first);
 static int initQueues(void);
 static void invokeDestructors(void);
+static void manageArena(MprArena *arena, int flags);
 static void markAndSweep(void);
 static void markRoots(void);
 static int pauseThreads(void);
 static void printMemReport(void);
+static void recordPause(uint64 start, uint64 synced, uint64 marked);
 static ME_INLINE void release(MprFreeQueue *freeq);
 static void resumeThreads(int flags);
 static ME_INLINE void setbitmap(size_t *bitmap, int bindex);
 static ME_INLINE int sizetoq(size_t size);
 static void dontBusyWait(void);
 static void sweep(void);
+static void sweeperHelper(MprSweeper *sp, MprThread *tp);
+static void sweepRegion(MprRegion *region);
+static void sweepRegions(void);
 static void sweeperThread(void *unused, MprThread *tp);
 static ME_INLINE void triggerGC(int always);
 static ME_INLINE void unlinkBlock(MprMem *mp);
@@ -193,6 +229,13 @@ static void vmfree(void *ptr, size_t size);
 #else
     #define monitorStack()
 #endif
+#if ME_MPR_ALLOC_THREAD_CACHE
+    static MprMem *cacheAlloc(int qindex, size_t required);
+    static MprMem *carveThreadCache(MprThreadCache *cache, int qindex, size_t required);
+    static void flushThreadCache(MprThreadCache *cache);
+    static MprThreadCache *getThreadCache(void);
+    static void releaseThreadCache(void *data);
+#endif
 
 /************************************* Code ***********************************/
 
@@ -208,6 +251,12 @@ PUBLIC Mpr *mprCreateMemService(MprManager manager, int flags)
         return NULL;
     }
     memset(heap, 0, sizeof(MprHeap));
+#if ME_MPR_ALLOC_THREAD_CACHE
+    /* Must be created before the first allocation */
+    if (pthread_key_create(&heap->cacheKey, releaseThreadCache) != 0) {
+        return NULL;
+    }
+#endif
     heap->stats.cpuCores = memStats.cpuCores;
     heap->stats.pageSize = memStats.pageSize;
     heap->stats.maxHeap = (size_t) -1;
@@ -283,9 +332,17 @@ PUBLIC Mpr *mprCreateMemService(MprManager manager, int flags)
  */
 PUBLIC void mprDestroyMemService()
 {
-    MprRegion   *region, *next;
-    ssize       size;
+    MprRegion       *region, *next;
+    ssize           size;
+#if ME_MPR_ALLOC_THREAD_CACHE
+    MprThreadCache  *cache, *nextCache;
 
+    pthread_key_delete(heap->cacheKey);
+    for (cache = heap->caches; cache; cache = nextCache) {
+        nextCache = cache->next;
+        vmfree(cache, MPR_PAGE_ALIGN(sizeof(MprThreadCache), memStats.pageSize));
+    }
+#endif
     for (region = heap->regions; region; ) {
         next = region->next;
         mprVirtFree(region, region->size);
@@ -408,6 +465,155 @@ PUBLIC void *mprMemdupMem(cvoid *ptr, size_t usize)
 }
 
 
+PUBLIC MprArena *mprCreateArena(size_t chunkSize)
+{
+    MprArena    *arena;
+
+    if ((arena = mprAllocObj(MprArena, manageArena)) == 0) {
+        return 0;
+    }
+    arena->chunkSize = chunkSize > 0 ? chunkSize : MPR_ARENA_CHUNK;
+    return arena;
+}
+
+
+static void manageArena(MprArena *arena, int flags)
+{
+    MprArenaChunk   *chunk;
+
+    if (flags & MPR_MANAGE_MARK) {
+        for (chunk = arena->chunks; chunk; chunk = chunk->next) {
+            mprMark(chunk);
+        }
+    }
+}
+
+
+/*
+    Allocate a new chunk. Oversized requests get a dedicated chunk that is linked after the current chunk so that
+    small allocations continue to be served from the current chunk.
+ */
+static MprArenaChunk *allocArenaChunk(MprArena *arena, size_t size)
+{
+    MprArenaChunk   *chunk;
+    size_t          hdr, csize;
+    bool            dedicated;
+
+    hdr = MPR_ALLOC_ALIGN(sizeof(MprArenaChunk));
+    dedicated = size > (arena->chunkSize / 4);
+    csize = dedicated ? (hdr + size) : arena->chunkSize;
+    if ((chunk = mprAlloc(csize)) == 0) {
+        return 0;
+    }
+    chunk->pos = (char*) chunk + hdr;
+    chunk->end = (char*) chunk + csize;
+    if (dedicated && arena->chunks) {
+        chunk->next = arena->chunks->next;
+        arena->chunks->next = chunk;
+    } else {
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+    return chunk;
+}
+
+
+/*
+    Arena blocks are given a valid memory header so they can be safely passed to mprMark, mprRealloc and the
+    string routines. They are flagged eternal and are never seen by the sweeper which walks only the enclosing chunk.
+ */
+PUBLIC void *mprArenaAlloc(MprArena *arena, size_t usize)
+{
+    MprArenaChunk   *chunk;
+    MprMem          *mp;
+    size_t          size;
+
+    assert(arena);
+    size = MPR_ALLOC_ALIGN(usize + sizeof(MprMem));
+    chunk = arena->chunks;
+    if (!chunk || (size_t) (chunk->end - chunk->pos) < size) {
+        if ((chunk = allocArenaChunk(arena, size)) == 0) {
+            return 0;
+        }
+    }
+    mp = (MprMem*) chunk->pos;
+    chunk->pos += size;
+    initBlock(mp, size, 0);
+    mp->eternal = 1;
+    arena->allocated += size;
+    return GET_PTR(mp);
+}
+
+
+PUBLIC char *mprArenaClone(MprArena *arena, cchar *str)
+{
+    char    *ptr;
+    size_t  len;
+
+    if (str == 0) {
+        str = "";
+    }
+    len = slen(str);
+    if ((ptr = mprArenaAlloc(arena, len + 1)) != 0) {
+        memcpy(ptr, str, len);
+        ptr[len] = '\0';
+    }
+    return ptr;
+}
+
+
+PUBLIC bool mprArenaContains(MprArena *arena, cvoid *ptr)
+{
+    MprArenaChunk   *chunk;
+
+    if (arena && ptr) {
+        for (chunk = arena->chunks; chunk; chunk = chunk->next) {
+            if ((char*) ptr > (char*) chunk && (char*) ptr < chunk->pos) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+PUBLIC void *mprArenaPromote(MprArena *arena, cvoid *ptr)
+{
+    if (!mprArenaContains(arena, ptr)) {
+        return (void*) ptr;
+    }
+    return mprMemdup(ptr, GET_USIZE(GET_MEM(ptr)));
+}
+
+
+/*
+    Rewind the arena. The most recent standard size chunk is retained, all other chunks are released to the collector.
+ */
+PUBLIC void mprResetArena(MprArena *arena)
+{
+    MprArenaChunk   *chunk, *keep;
+    size_t          hdr;
+
+    if (arena == 0) {
+        return;
+    }
+    hdr = MPR_ALLOC_ALIGN(sizeof(MprArenaChunk));
+    for (keep = 0, chunk = arena->chunks; chunk; chunk = chunk->next) {
+        if (chunk->end == (char*) chunk + arena->chunkSize) {
+            keep = chunk;
+            break;
+        }
+    }
+    if (keep) {
+        keep->next = 0;
+        keep->pos = (char*) keep + hdr;
+        SCRIBBLE_RANGE(keep->pos, keep->end - keep->pos);
+    }
+    arena->chunks = keep;
+    arena->allocated = 0;
+}
+
+
 PUBLIC int mprMemcmp(cvoid *s1, size_t s1Len, cvoid *s2, size_t s2Len)
 {
     int         rc;
@@ -506,6 +712,11 @@ static MprMem *allocMem(size_t required)
     }
     baseQindex = qindex;
 
+#if ME_MPR_ALLOC_THREAD_CACHE
+    if (qindex >= 0 && qindex < MPR_ALLOC_CACHE_QUEUES && (mp = cacheAlloc(qindex, required)) != 0) {
+        return mp;
+    }
+#endif
     if (qindex >= 0) {
         heap->workDone += required;
     retry:
@@ -673,23 +884,246 @@ static MprMem *growHeap(size_t required)
 }
 
 
+#if ME_MPR_ALLOC_THREAD_CACHE
+/*
+    Allocate a block from the current thread's cache. An empty cache bin is refilled with a batch of blocks from the
+    corresponding heap free queue. If that queue is empty, a batch is carved from one larger block allocated from
+    the heap. Returns null if the cache cannot be refilled so the caller can search the other queues.
+    Cached blocks are eternal and not free, so the sweeper ignores them.
+ */
+static MprMem *cacheAlloc(int qindex, size_t required)
+{
+    MprThreadCache  *cache;
+    MprFreeQueue    *freeq;
+    MprFreeMem      *fp;
+    MprMem          *mp;
+    size_t          bytes;
+    int             count;
+
+    if ((cache = getThreadCache()) == 0) {
+        return 0;
+    }
+    if (cache->generation != heap->cacheGeneration) {
+        flushThreadCache(cache);
+        cache->generation = heap->cacheGeneration;
+    }
+    if (cache->bins[qindex] == 0) {
+        freeq = &heap->freeq[qindex];
+        if (freeq->count == 0) {
+            return carveThreadCache(cache, qindex, required);
+        }
+        ATOMIC_INC(trys);
+        if (!acquire(freeq)) {
+            ATOMIC_INC(tryFails);
+            cache->misses++;
+            return 0;
+        }
+        /*
+            Take a batch of blocks while the queue is acquired. The sweeper claims blocks under the queue lock and checks
+            qindex, so it cannot race for these blocks. Must set eternal before clearing the free bit.
+         */
+        bytes = 0;
+        for (count = 0; count < MPR_ALLOC_CACHE_BATCH && freeq->next != (MprFreeMem*) freeq; count++) {
+            fp = freeq->next;
+            fp->prev->next = fp->next;
+            fp->next->prev = fp->prev;
+            fp->blk.qindex = 0;
+            fp->blk.eternal = 1;
+            assert(fp->blk.free == 1);
+            fp->blk.free = 0;
+            bytes += fp->blk.size;
+            fp->next = cache->bins[qindex];
+            cache->bins[qindex] = fp;
+        }
+        freeq->count -= count;
+        if (freeq->count == 0) {
+            clearbitmap(&heap->bitmap[qindex / MPR_ALLOC_BITMAP_BITS], qindex % MPR_ALLOC_BITMAP_BITS);
+        }
+        release(freeq);
+        if (count == 0) {
+            cache->misses++;
+            return 0;
+        }
+        mprAtomicAdd64((int64*) &heap->stats.bytesFree, -(int64) bytes);
+        cache->counts[qindex] += count;
+        cache->bytes += bytes;
+        cache->refills++;
+    }
+    fp = cache->bins[qindex];
+    cache->bins[qindex] = fp->next;
+    cache->counts[qindex]--;
+    mp = (MprMem*) fp;
+    cache->bytes -= mp->size;
+    cache->hits++;
+    mp->mark = heap->mark;
+
+    if (mp->size >= (size_t) (required + MPR_ALLOC_MIN_SPLIT)) {
+        linkSpareBlock(((char*) mp) + required, mp->size - required);
+        mp->size = (MprMemSize) required;
+        ATOMIC_INC(splits);
+    }
+    heap->workDone += required;
+    if (!heap->gcRequested && heap->workDone > heap->workQuota) {
+        triggerGC(0);
+    }
+    ATOMIC_INC(reuse);
+    return mp;
+}
+
+
+/*
+    Refill an empty cache bin by splitting one heap block into a batch of blocks of the queue's minimum size.
+    All requests mapped to the queue fit in a block of that size. Return the first block for the caller.
+ */
+static MprMem *carveThreadCache(MprThreadCache *cache, int qindex, size_t required)
+{
+    MprFreeMem  *fp;
+    MprMem      *chunk, *mp;
+    size_t      size, extra;
+    int         count, first, i;
+
+    size = heap->freeq[qindex].minSize;
+    assert(size >= required);
+    count = (int) max(2, MPR_ALLOC_CACHE_CARVE / size);
+    assert(sizetoq(size * count) >= MPR_ALLOC_CACHE_QUEUES);
+
+    if ((chunk = allocMem(size * count)) == NULL) {
+        cache->misses++;
+        return 0;
+    }
+    /* Don't count the work twice. It is counted as blocks are allocated from the cache */
+    heap->workDone -= min(heap->workDone, size * count);
+
+    /* The chunk may be slightly larger if the remainder was too small to split. The last block takes the extra. */
+    extra = chunk->size - (size * count);
+    first = chunk->first;
+    for (i = count - 1; i > 0; i--) {
+        mp = (MprMem*) ((char*) chunk + (i * size));
+        initBlock(mp, (i == count - 1) ? size + extra : size, 0);
+        mp->eternal = 1;
+        fp = (MprFreeMem*) mp;
+        fp->next = cache->bins[qindex];
+        cache->bins[qindex] = fp;
+    }
+    initBlock(chunk, size, first);
+    chunk->eternal = 1;
+    cache->counts[qindex] += count - 1;
+    cache->bytes += (size * (count - 1)) + extra;
+    cache->refills++;
+    cache->hits++;
+    heap->workDone += required;
+    return chunk;
+}
+
+
+/*
+    Return all cached blocks to the heap free queues. Each bin is linked in one batch with its queue acquired.
+    Must set the free bit before clearing eternal so the sweeper never sees an unreferenced block that is not free.
+ */
+static void flushThreadCache(MprThreadCache *cache)
+{
+    MprFreeQueue    *freeq;
+    MprFreeMem      *fp, *next;
+    size_t          bytes;
+    int             qindex;
+
+    if (cache->bytes == 0) {
+        return;
+    }
+    for (qindex = 0; qindex < MPR_ALLOC_CACHE_QUEUES; qindex++) {
+        if ((fp = cache->bins[qindex]) == 0) {
+            continue;
+        }
+        freeq = &heap->freeq[qindex];
+        while (!acquire(freeq)) {
+            dontBusyWait();
+        }
+        bytes = 0;
+        for (; fp; fp = next) {
+            next = fp->next;
+            fp->blk.qindex = qindex;
+            fp->blk.hasManager = 0;
+            fp->next = freeq->next;
+            fp->prev = (MprFreeMem*) freeq;
+            freeq->next->prev = fp;
+            freeq->next = fp;
+            fp->blk.free = 1;
+            mprAtomicBarrier();
+            fp->blk.eternal = 0;
+            bytes += fp->blk.size;
+        }
+        freeq->count += cache->counts[qindex];
+        setbitmap(&heap->bitmap[qindex / MPR_ALLOC_BITMAP_BITS], qindex % MPR_ALLOC_BITMAP_BITS);
+        release(freeq);
+        mprAtomicAdd64((int64*) &heap->stats.bytesFree, bytes);
+        cache->bins[qindex] = 0;
+        cache->counts[qindex] = 0;
+    }
+    cache->bytes = 0;
+    cache->flushes++;
+}
+
+
+/*
+    Get the allocation cache for the current thread. Caches released by exited threads are reused before creating
+    a new cache.
+ */
+static MprThreadCache *getThreadCache()
+{
+    MprThreadCache  *cache;
+
+    if ((cache = pthread_getspecific(heap->cacheKey)) != 0) {
+        return cache;
+    }
+    for (cache = heap->caches; cache; cache = cache->next) {
+        if (!cache->owned && cas(&cache->owned, 0, 1)) {
+            break;
+        }
+    }
+    if (!cache) {
+        if ((cache = vmalloc(MPR_PAGE_ALIGN(sizeof(MprThreadCache), memStats.pageSize),
+                MPR_MAP_READ | MPR_MAP_WRITE)) == 0) {
+            return 0;
+        }
+        memset(cache, 0, sizeof(MprThreadCache));
+        cache->owned = 1;
+        mprAtomicListInsert((void**) &heap->caches, (void**) &cache->next, cache);
+    }
+    cache->generation = heap->cacheGeneration;
+    pthread_setspecific(heap->cacheKey, cache);
+    return cache;
+}
+
+
+/*
+    Thread exit destructor for the thread cache
+ */
+static void releaseThreadCache(void *data)
+{
+    MprThreadCache  *cache;
+
+    if ((cache = data) == 0 || !heap) {
+        return;
+    }
+    flushThreadCache(cache);
+    mprAtomicBarrier();
+    cache->owned = 0;
+}
+#endif /* ME_MPR_ALLOC_THREAD_CACHE */
+
+
 /*
     Free a memory block back onto the freelists
  */
-static void freeBlock(MprMem *mp)
+static void freeBlock(MprMem *mp, SweepStats *ss)
 {
     MprRegion   *region;
 
     assert(!mp->free);
     SCRIBBLE(mp);
-#if ME_DEBUG || ME_MPR_ALLOC_STATS
-    heap->stats.swept++;
-    heap->stats.sweptBytes += mp->size;
-#endif
+    ss->swept++;
+    ss->sweptBytes += mp->size;
     heap->freedBlocks = 1;
-#if ME_MPR_ALLOC_STATS
-    heap->stats.freed += mp->size;
-#endif
     /*
         If memory block is first in the region, check if the entire region is free
      */
@@ -948,6 +1382,7 @@ PUBLIC void mprStartGCService()
         } else {
             mprStartThread(heap->sweeper);
         }
+        mprSetGCSweepers(ME_MPR_GC_SWEEPERS ? ME_MPR_GC_SWEEPERS : max(heap->stats.cpuCores / 8, 1));
     }
 }
 
@@ -997,6 +1432,12 @@ PUBLIC int mprGC(int flags)
          */
         mprYield(MPR_YIELD_STICKY);
     }
+#if ME_MPR_ALLOC_THREAD_CACHE
+    if (flags & MPR_GC_COMPLETE) {
+        /* Return cached blocks to the free queues on each thread's next allocation */
+        heap->cacheGeneration++;
+    }
+#endif
     if ((flags & (MPR_GC_FORCE | MPR_GC_COMPLETE)) || (heap->workDone > heap->workQuota)) {
         triggerGC(flags & (MPR_GC_FORCE | MPR_GC_COMPLETE));
     }
@@ -1059,7 +1500,15 @@ PUBLIC void mprYield(int flags)
             mprWaitForCond(tp->cond, -1);
             lock(ts->threads);
             tp->waiting = 0;
-            if (tp->yielded && !tp->stickyYield) {
+            if (!tp->yielded) {
+                /*
+                    Resumed by the marker. Do not wait again if another collection has already been requested.
+                    Under heavy allocation that can happen before this thread is scheduled, and the thread would
+                    never run. The next collection cannot mark until this thread yields again.
+                 */
+                break;
+            }
+            if (!tp->stickyYield) {
                 /*
                     WARNING: this wait above may return without tp->yielded having been cleared.
                     This can happen because the cond may have already been triggered by a
@@ -1237,6 +1686,9 @@ static void sweeperThread(void *unused, MprThread *tp)
  */
 static void markAndSweep()
 {
+    uint64      start, synced;
+
+    start = gcClock();
     if (!pauseThreads()) {
 #if ME_MPR_ALLOC_STATS && ME_MPR_ALLOC_DEBUG && MPR_ALLOC_TRACE
         static int warnOnce = 0;
@@ -1255,6 +1707,7 @@ static void markAndSweep()
         Assert global lock around marking and changing heap->mark so that routines in foreign threads (like httpCreateEvent)
         can stop GC when creating events.
      */
+    synced = gcClock();
     mprGlobalLock();
     heap->mark = !heap->mark;
     markRoots();
@@ -1269,6 +1722,7 @@ static void markAndSweep()
     heap->sweeping = 1;
 
     resumeThreads(YIELDED_THREADS);
+    recordPause(start, synced, gcClock());
 
     sweep();
     heap->sweeping = 0;
@@ -1280,14 +1734,61 @@ static void markAndSweep()
 }
 
 
+/*
+    Record the time user threads were stopped for marking. This is the time to synchronize all threads at a yield
+    point plus the time to mark. Only called by the GC thread.
+ */
+static void recordPause(uint64 start, uint64 synced, uint64 marked)
+{
+    MprMemStats     *sp;
+    uint64          pause;
+    int             bucket;
+
+    sp = &heap->stats;
+    pause = marked - start;
+    sp->gcPauses++;
+    sp->gcPauseTotal += pause;
+    sp->gcPauseLast = pause;
+    sp->gcPauseMax = max(sp->gcPauseMax, pause);
+    sp->gcSyncMax = max(sp->gcSyncMax, synced - start);
+    sp->gcMarkMax = max(sp->gcMarkMax, marked - synced);
+    for (bucket = 0; bucket < MPR_GC_PAUSE_BUCKETS - 1 && pause >= ((uint64) 128 << bucket); bucket++) {}
+    sp->gcPauseHistogram[bucket]++;
+}
+
+
+/*
+    Microsecond clock for GC pause measurement
+ */
+static ME_INLINE uint64 gcClock()
+{
+#if ME_UNIX_LIKE
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    return (uint64) mprGetTicks() * 1000;
+#endif
+}
+
+
 static void markRoots()
 {
+    int     i;
+
 #if ME_MPR_ALLOC_STATS
     heap->stats.markVisited = 0;
     heap->stats.marked = 0;
 #endif
     mprMark(heap->roots);
     mprMark(heap->gcCond);
+    if (heap->sweepers) {
+        mprMark(heap->sweepDone);
+        for (i = 0; i < MPR_MAX_SWEEPERS; i++) {
+            mprMark(heap->sweepers[i].cond);
+        }
+    }
 }
 
 
@@ -1382,16 +1883,20 @@ static ME_INLINE bool claim(MprMem *mp)
 
 /*
     Sweep up the garbage. The sweeper runs in parallel with the program. Dead blocks will have (MprMem.mark != heap->mark).
+    The heap regions are shared with sweeper helper threads which claim regions one at a time. Only this thread
+    unlinks and frees regions once all helpers have completed.
 */
 static void sweep()
 {
     MprRegion   *region, *nextRegion, *prior, *rp;
-    MprMem      *mp, *next;
-    int         joinBlocks, rcount;
+    MprSweeper  *sp;
+    uint64      start;
+    int         count, helpers, i, rcount;
 
     if (!heap->gcEnabled) {
         return;
     }
+    start = gcClock();
 #if ME_MPR_ALLOC_STATS
     heap->priorFree = heap->stats.bytesFree;
     heap->stats.sweepVisited = 0;
@@ -1410,80 +1915,51 @@ static void sweep()
 
     /*
         RACE: Racing with growHeap. This traverses the region list lock-free. growHeap() will insert new regions to
-        the front of heap->regions. This code is the only code that frees regions.
+        the front of heap->regions. This code is the only code that frees regions. So the list from the current head
+        is stable for this sweep.
      */
+    for (count = 0, region = heap->regions; region; region = region->next) {
+        count++;
+    }
+    if (count > heap->sweepMax) {
+        if ((heap->sweepList = realloc(heap->sweepList, count * 2 * sizeof(MprRegion*))) == 0) {
+            heap->sweepMax = 0;
+            count = 0;
+        } else {
+            heap->sweepMax = count * 2;
+        }
+    }
+    for (i = 0, region = heap->regions; region && i < count; region = region->next) {
+        heap->sweepList[i++] = region;
+    }
+    heap->sweepCount = i;
+    heap->sweepNext = 0;
+
+    helpers = min(heap->sweepHelpers, heap->sweepCount - 1);
+    heap->sweepPending = max(helpers, 0);
+    for (i = 0; i < helpers; i++) {
+        sp = &heap->sweepers[i];
+        sp->work = 1;
+        mprSignalCond(sp->cond);
+    }
+    sweepRegions();
+    while (heap->sweepPending > 0) {
+        if (mprIsDestroyed()) {
+            return;
+        }
+        mprWaitForCond(heap->sweepDone, 10);
+    }
+    if (heap->sweepCount == 0) {
+        /* Could not allocate the region list. Sweep serially. */
+        for (region = heap->regions; region; region = region->next) {
+            sweepRegion(region);
+        }
+    }
+
     prior = NULL;
     rcount = 0;
-    for (region = heap->regions; region; region = nextRegion) {
+    for (region = heap->sweepCount ? heap->sweepList[0] : heap->regions; region; region = nextRegion) {
         nextRegion = region->next;
-        joinBlocks = heap->stats.bytesFree >= heap->stats.cacheHeap;
-
-        for (mp = region->start; mp < region->end; mp = next) {
-            assert(mp->size > 0);
-            next = GET_NEXT(mp);
-            assert(next != mp);
-            CHECK(mp);
-            INC(sweepVisited);
-
-            /*
-                Racing with the allocator. Be conservative. The sweeper is the only place that mp->free is cleared.
-                The allocator is the only place that sets mp->free. If mp->free is zero, we can be sure the block is
-                not free and not on a freeq. If mp->free is set, we could be racing with the allocator for the block.
-             */
-            if (mp->eternal) {
-                assert(!region->freeable);
-                continue;
-            }
-            if (mp->free && joinBlocks) {
-                /*
-                    Coalesce already free blocks if the next is unreferenced and we can claim the block (racing with allocator).
-                    Claim the block and then mark it as unreferenced. Then the code below will join the blocks.
-                 */
-                if (next < region->end && !next->free && next->mark != heap->mark && claim(mp)) {
-                    mp->mark = !heap->mark;
-                    INC(compacted);
-                }
-            }
-            if (!mp->free && mp->mark != heap->mark) {
-                freeLocation(mp);
-                if (joinBlocks) {
-                    /*
-                        Try to join this block with successors
-                     */
-                    while (next < region->end && !next->eternal) {
-                        if (next->free) {
-                            /*
-                                Block is free and on a freeq - must claim as racing with the allocator for the block
-                             */
-                            if (!claim(next)) {
-                                break;
-                            }
-                            mp->size += next->size;
-                            freeLocation(next);
-                            assert(!next->free);
-                            SCRIBBLE_RANGE(next, MPR_ALLOC_MIN_BLOCK);
-                            INC(joins);
-
-                        } else if (next->mark != heap->mark) {
-                            /*
-                                Block not in use and NOT on a freeq - no need to claim
-                             */
-                            assert(!next->free);
-                            assert(next->qindex == 0);
-                            mp->size += next->size;
-                            freeLocation(next);
-                            SCRIBBLE_RANGE(next, MPR_ALLOC_MIN_BLOCK);
-                            INC(joins);
-
-                        } else {
-                            break;
-                        }
-                        next = GET_NEXT(mp);
-                    }
-                }
-                freeBlock(mp);
-            }
-        }
         if (region->freeable) {
             if (prior) {
                 prior->next = nextRegion;
@@ -1507,6 +1983,26 @@ static void sweep()
     }
     heap->stats.heapRegions = rcount;
     heap->stats.sweeps++;
+    heap->stats.sweepers = helpers + 1;
+    heap->stats.sweepTime = gcClock() - start;
+    heap->stats.sweepTimeTotal += heap->stats.sweepTime;
+#if ME_MPR_ALLOC_THREAD_CACHE
+    {
+        MprThreadCache  *cache;
+        uint64          cached;
+
+        for (cached = 0, cache = heap->caches; cache; cache = cache->next) {
+            cached += cache->bytes;
+        }
+        if (cached > heap->stats.bytesFree) {
+            /*
+                More free memory is idle in thread caches than in the free queues. Ask threads to return their
+                cached blocks so they can be shared and coalesced.
+             */
+            heap->cacheGeneration++;
+        }
+    }
+#endif
 #if ME_MPR_ALLOC_STATS && ME_MPR_ALLOC_DEBUG && MPR_ALLOC_TRACE
     printf("GC: Marked %lld / %lld, Swept %lld / %lld, freed %lld, bytesFree %lld (prior %lld)\n"
                  "    WeightedCount %d / %d, allocated blocks %lld allocated bytes %lld\n"
@@ -1524,6 +2020,169 @@ static void sweep()
 }
 
 
+/*
+    Claim and sweep regions from the current sweep list until none remain. Called by the GC thread and by helpers.
+ */
+static void sweepRegions()
+{
+    size_t  index;
+
+    while (1) {
+        do {
+            index = heap->sweepNext;
+            if (index >= (size_t) heap->sweepCount) {
+                return;
+            }
+        } while (!cas(&heap->sweepNext, index, index + 1));
+        sweepRegion(heap->sweepList[index]);
+    }
+}
+
+
+/*
+    Sweep a single region. Blocks are only joined with successors in the same region, so regions can be swept
+    concurrently. Statistics are accumulated locally and merged once per region.
+ */
+static void sweepRegion(MprRegion *region)
+{
+    SweepStats  ss;
+    MprMem      *mp, *next;
+    int         joinBlocks;
+
+    memset(&ss, 0, sizeof(ss));
+    joinBlocks = heap->stats.bytesFree >= heap->stats.cacheHeap;
+
+    for (mp = region->start; mp < region->end; mp = next) {
+        assert(mp->size > 0);
+        next = GET_NEXT(mp);
+        assert(next != mp);
+        CHECK(mp);
+        ss.visited++;
+
+        /*
+            Racing with the allocator. Be conservative. The sweeper is the only place that mp->free is cleared.
+            The allocator is the only place that sets mp->free. If mp->free is zero, we can be sure the block is
+            not free and not on a freeq. If mp->free is set, we could be racing with the allocator for the block.
+         */
+        if (mp->eternal) {
+            assert(!region->freeable);
+            continue;
+        }
+        if (mp->free && joinBlocks) {
+            /*
+                Coalesce already free blocks if the next is unreferenced and we can claim the block (racing with allocator).
+                Claim the block and then mark it as unreferenced. Then the code below will join the blocks.
+             */
+            if (next < region->end && !next->free && next->mark != heap->mark && claim(mp)) {
+                mp->mark = !heap->mark;
+                ss.compacted++;
+            }
+        }
+        if (!mp->free && mp->mark != heap->mark) {
+            freeLocation(mp);
+            if (joinBlocks) {
+                /*
+                    Try to join this block with successors
+                 */
+                while (next < region->end && !next->eternal) {
+                    if (next->free) {
+                        /*
+                            Block is free and on a freeq - must claim as racing with the allocator for the block
+                         */
+                        if (!claim(next)) {
+                            break;
+                        }
+                        mp->size += next->size;
+                        freeLocation(next);
+                        assert(!next->free);
+                        SCRIBBLE_RANGE(next, MPR_ALLOC_MIN_BLOCK);
+                        ss.joins++;
+
+                    } else if (next->mark != heap->mark) {
+                        /*
+                            Block not in use and NOT on a freeq - no need to claim
+                         */
+                        assert(!next->free);
+                        assert(next->qindex == 0);
+                        mp->size += next->size;
+                        freeLocation(next);
+                        SCRIBBLE_RANGE(next, MPR_ALLOC_MIN_BLOCK);
+                        ss.joins++;
+
+                    } else {
+                        break;
+                    }
+                    next = GET_NEXT(mp);
+                }
+            }
+            freeBlock(mp, &ss);
+        }
+    }
+#if ME_DEBUG || ME_MPR_ALLOC_STATS
+    ATOMIC_ADD(swept, ss.swept);
+    ATOMIC_ADD(sweptBytes, ss.sweptBytes);
+#endif
+#if ME_MPR_ALLOC_STATS
+    ATOMIC_ADD(freed, ss.sweptBytes);
+    ATOMIC_ADD(sweepVisited, ss.visited);
+    ATOMIC_ADD(compacted, ss.compacted);
+    ATOMIC_ADD(joins, ss.joins);
+#endif
+    ATOMIC_ADD(sweptBytesTotal, ss.sweptBytes);
+    ATOMIC_ADD(sweepScanned, region->size);
+}
+
+
+/*
+    Sweeper helper thread. Helpers are sticky yielded so they never delay the mark phase.
+ */
+static void sweeperHelper(MprSweeper *sp, MprThread *tp)
+{
+    tp->stickyYield = 1;
+    tp->yielded = 1;
+
+    while (!mprIsDestroyed()) {
+        mprWaitForCond(sp->cond, -1);
+        if (sp->work) {
+            sp->work = 0;
+            sweepRegions();
+            mprAtomicAdd(&heap->sweepPending, -1);
+            mprSignalCond(heap->sweepDone);
+        }
+    }
+}
+
+
+PUBLIC void mprSetGCSweepers(int count)
+{
+    MprSweeper  *sp;
+    int         helpers;
+
+    helpers = max(0, min(count, MPR_MAX_SWEEPERS) - 1);
+    if (helpers > 0 && !heap->sweepers) {
+        if ((heap->sweepers = calloc(MPR_MAX_SWEEPERS, sizeof(MprSweeper))) == 0) {
+            return;
+        }
+        heap->sweepDone = mprCreateCond();
+    }
+    while (heap->sweepHelpers < helpers) {
+        sp = &heap->sweepers[heap->sweepHelpers];
+        if (!sp->thread) {
+            sp->cond = mprCreateCond();
+            if ((sp->thread = mprCreateThread(sfmt("sweeper-%d", heap->sweepHelpers + 1), sweeperHelper, sp, 0)) == 0) {
+                mprLog("error mpr memory", 0, "Cannot create sweeper helper thread");
+                break;
+            }
+            mprStartThread(sp->thread);
+        }
+        heap->sweepHelpers++;
+    }
+    if (helpers < heap->sweepHelpers) {
+        heap->sweepHelpers = helpers;
+    }
+}
+
+
 /*
     Permanent allocation. Immune to garbage collector.
  */
@@ -1796,6 +2455,10 @@ static void printGCStats()
     printf("  Active:  %8d blocks, %6.1f MB\n", activeCount, activeBytes / mb);
     printf("  Eternal: %8d blocks, %6.1f MB\n", eternalCount, eternalBytes / mb);
     printf("  Free:    %8d blocks, %6.1f MB\n", freeCount, freeBytes / mb);
+    printf("  Sweep:   %8d threads, last %lld usec, %.1f MB/sec scanned, %.1f MB/sec freed\n",
+        (int) heap->stats.sweepers, (int64) heap->stats.sweepTime,
+        heap->stats.sweepScanned / mb / max(heap->stats.sweepTimeTotal / 1000000.0, 0.000001),
+        heap->stats.sweptBytesTotal / mb / max(heap->stats.sweepTimeTotal / 1000000.0, 0.000001));
 }
 #endif /* ME_MPR_ALLOC_STATS */
 
@@ -1812,6 +2475,7 @@ static void printMemReport()
 {
     MprMemStats     *ap;
     double          mb;
+    int             bucket;
 
     ap = mprGetMemStats();
     mb = 1024.0 * 1024;
@@ -1835,6 +2499,41 @@ static void printMemReport()
     printf("  CPU cores       %12d\n", (int) ap->cpuCores);
     printf("\n");
 
+    printf("GC Pauses:\n");
+    printf("  Pauses          %12lld\n", (int64) ap->gcPauses);
+    printf("  Average         %12.1f usec\n", ap->gcPauseTotal / (double) max(ap->gcPauses, 1));
+    printf("  Last            %12lld usec\n", (int64) ap->gcPauseLast);
+    printf("  Max             %12lld usec (sync %lld, mark %lld)\n", (int64) ap->gcPauseMax,
+        (int64) ap->gcSyncMax, (int64) ap->gcMarkMax);
+    for (bucket = 0; bucket < MPR_GC_PAUSE_BUCKETS; bucket++) {
+        if (ap->gcPauseHistogram[bucket]) {
+            printf("  %s %7d usec %12lld\n", bucket < MPR_GC_PAUSE_BUCKETS - 1 ? "< " : ">=",
+                128 << min(bucket, MPR_GC_PAUSE_BUCKETS - 2), (int64) ap->gcPauseHistogram[bucket]);
+        }
+    }
+    printf("\n");
+
+#if ME_MPR_ALLOC_THREAD_CACHE
+    {
+        MprThreadCache  *cache;
+        int             index;
+
+        printf("Thread Caches:\n");
+        printf("  Caches          %12d\n", (int) ap->threadCaches);
+        printf("  Cached          %12.1f MB\n", ap->threadCacheBytes / mb);
+        printf("  Hits            %12.2f %% (%lld)\n", ap->threadCacheHits * 100.0 /
+            max(ap->threadCacheHits + ap->threadCacheMisses, 1), (int64) ap->threadCacheHits);
+        printf("  Refills         %12lld\n", (int64) ap->threadCacheRefills);
+        printf("  Flushes         %12lld\n", (int64) ap->threadCacheFlushes);
+        for (index = 0, cache = heap->caches; cache; cache = cache->next, index++) {
+            printf("  Cache %2d %s: %8lld bytes, hits %lld, misses %lld, refills %lld\n", index,
+                cache->owned ? "active" : "idle  ", (int64) cache->bytes, (int64) cache->hits,
+                (int64) cache->misses, (int64) cache->refills);
+        }
+        printf("\n");
+    }
+#endif
+
 #if ME_MPR_ALLOC_STATS
     printf("Allocator Stats:\n");
     printf("  Memory requests %12d\n",                (int) ap->requests);
@@ -2197,6 +2896,25 @@ PUBLIC MprMemStats *mprGetMemStats()
 #endif
     heap->stats.rss = mprGetMem();
     heap->stats.cpuUsage = mprGetCPU();
+#if ME_MPR_ALLOC_THREAD_CACHE
+    {
+        MprThreadCache  *cache;
+
+        heap->stats.threadCaches = 0;
+        heap->stats.threadCacheBytes = heap->stats.threadCacheHits = heap->stats.threadCacheMisses = 0;
+        heap->stats.threadCacheRefills = heap->stats.threadCacheFlushes = 0;
+        for (cache = heap->caches; cache; cache = cache->next) {
+            if (cache->owned) {
+                heap->stats.threadCaches++;
+            }
+            heap->stats.threadCacheBytes += cache->bytes;
+            heap->stats.threadCacheHits += cache->hits;
+            heap->stats.threadCacheMisses += cache->misses;
+            heap->stats.threadCacheRefills += cache->refills;
+            heap->stats.threadCacheFlushes += cache->flushes;
+        }
+    }
+#endif
     return &heap->stats;
 }
 
@@ -4066,6 +4784,41 @@ PUBLIC void mprAtomicAdd(volatile int *ptr, int value)
 }
 
 
+PUBLIC int mprAtomicAddFetch(volatile int *ptr, int value)
+{
+    #if ME_WIN_LIKE
+        return InterlockedExchangeAdd(ptr, value) + value;
+
+    #elif ME_COMPILER_HAS_ATOMIC
+        return __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+
+    #elif ME_COMPILER_HAS_SYNC_CAS
+        return __sync_add_and_fetch(ptr, value);
+
+    #elif VXWORKS && _VX_ATOMIC_INIT
+        return vxAtomicAdd(ptr, value) + value;
+
+    #elif __GNUC__ && (ME_CPU_ARCH == ME_CPU_X86 || ME_CPU_ARCH == ME_CPU_X64) && !VXWORKS
+        int     prior;
+
+        prior = value;
+        asm volatile("lock; xaddl %0,%1"
+            : "+r" (prior), "+m" (*ptr)
+            :
+            : "memory", "cc");
+        return prior + value;
+    #else
+        int     result;
+
+        mprSpinLock(atomicSpin);
+        result = *ptr += value;
+        mprSpinUnlock(atomicSpin);
+        return result;
+
+    #endif
+}
+
+
 /*
     On some platforms, this operation is only atomic with respect to other calls to mprAtomicAdd64
  */
@@ -9549,7 +10302,8 @@ static void releaseDispatcher(MprDispatcher *dispatcher);
 #define isRunning(dispatcher) (dispatcher->parent == dispatcher->service->runQ)
 #define isReady(dispatcher) (dispatcher->parent == dispatcher->service->readyQ)
 #define isWaiting(dispatcher) (dispatcher->parent == dispatcher->service->waitQ)
-#define isEmpty(dispatcher) (dispatcher->eventQ->next == dispatcher->eventQ)
+#define isEmpty(dispatcher) (dispatcher->eventQ->next == dispatcher->eventQ && dispatcher->inbox == 0)
+#define hasTimers(dispatcher) (dispatcher->timerQ->next != dispatcher->timerQ)
 
 #if ME_DEBUG
 static bool isReservedDispatcher(MprDispatcher *dispatcher);
@@ -9650,6 +10404,15 @@ PUBLIC void mprSetDispatcherImmediate(MprDispatcher *dispatcher)
 }
 
 
+/*
+    Bind the dispatcher to a CPU from the worker affinity set
+ */
+PUBLIC void mprSetDispatcherCpu(MprDispatcher *dispatcher, int cpu)
+{
+    dispatcher->cpu = mprSelectWorkerCpu(cpu);
+}
+
+
 static MprDispatcher *createQhead(cchar *name)
 {
     MprDispatcher       *dispatcher;
@@ -9678,7 +10441,9 @@ PUBLIC MprDispatcher *mprCreateDispatcher(cchar *name, int flags)
     dispatcher->name = name;
     dispatcher->cond = mprCreateCond();
     dispatcher->eventQ = mprCreateEventQueue();
+    dispatcher->timerQ = mprCreateEventQueue();
     dispatcher->currentQ = mprCreateEventQueue();
+    dispatcher->cpu = -1;
     queueDispatcher(es->idleQ, dispatcher);
     return dispatcher;
 }
@@ -9703,6 +10468,26 @@ static void freeEvents(MprEvent *q)
 }
 
 
+/*
+    Release events posted to the inbox of a dispatcher that is being freed
+ */
+static void freeInbox(MprDispatcher *dispatcher)
+{
+    MprEvent    *event, *next;
+
+    for (event = dispatcher->inbox; event; event = next) {
+        next = (event->inboxNext == event) ? 0 : event->inboxNext;
+        event->inboxNext = 0;
+        event->dispatcher = 0;
+        if (event->cond) {
+            mprSignalCond(event->cond);
+        }
+        mprRelease(event);
+    }
+    dispatcher->inbox = 0;
+}
+
+
 PUBLIC void mprDestroyDispatcher(MprDispatcher *dispatcher)
 {
     MprEventService     *es;
@@ -9711,7 +10496,9 @@ PUBLIC void mprDestroyDispatcher(MprDispatcher *dispatcher)
         es = dispatcher->service;
         assert(es == MPR->eventService);
         lock(es);
+        mprDrainInbox(dispatcher);
         freeEvents(dispatcher->eventQ);
+        freeEvents(dispatcher->timerQ);
         freeEvents(dispatcher->currentQ);
         dequeueDispatcher(dispatcher);
         dispatcher->flags |= MPR_DISPATCHER_DESTROYED;
@@ -9726,6 +10513,7 @@ static void manageDispatcher(MprDispatcher *dispatcher, int flags)
 
     if (flags & MPR_MANAGE_MARK) {
         mprMark(dispatcher->eventQ);
+        mprMark(dispatcher->timerQ);
         mprMark(dispatcher->currentQ);
         mprMark(dispatcher->cond);
         mprMark(dispatcher->parent);
@@ -9737,16 +10525,31 @@ static void manageDispatcher(MprDispatcher *dispatcher, int flags)
                 mprMark(event);
             }
         }
+        if ((q = dispatcher->timerQ) != 0) {
+            for (event = q->next; event != q; event = next) {
+                next = event->next;
+                mprMark(event);
+            }
+        }
         if ((q = dispatcher->currentQ) != 0) {
             for (event = q->next; event != q; event = next) {
                 next = event->next;
                 mprMark(event);
             }
         }
+        /*
+            Posting only pushes onto the head, so the inbox links are stable while walking
+         */
+        for (event = dispatcher->inbox; event; event = (event->inboxNext == event) ? 0 : event->inboxNext) {
+            mprMark(event);
+        }
 
     } else if (flags & MPR_MANAGE_FREE) {
+        /* Events may be posted after the dispatcher is destroyed */
+        freeInbox(dispatcher);
         if (!(dispatcher->flags & MPR_DISPATCHER_DESTROYED)) {
             freeEvents(dispatcher->eventQ);
+            freeEvents(dispatcher->timerQ);
             freeEvents(dispatcher->currentQ);
         }
     }
@@ -9804,7 +10607,7 @@ PUBLIC int mprServiceEvents(MprTicks timeout, int flags)
             if (dp->flags & MPR_DISPATCHER_IMMEDIATE) {
                 dispatchEventsHelper(dp);
             } else {
-                if (mprStartWorker((MprWorkerProc) dispatchEventsHelper, dp) < 0) {
+                if (mprStartWorkerOnCpu((MprWorkerProc) dispatchEventsHelper, dp, dp->cpu) < 0) {
                     releaseDispatcher(dp);
                     queueDispatcher(es->pendingQ, dp);
                     break;
@@ -9982,7 +10785,7 @@ PUBLIC int mprDispatchersAreIdle()
     runQ = es->runQ;
     lock(es);
     dispatcher = runQ->next;
-    idle = (dispatcher == runQ) ? 1 : (dispatcher->eventQ == dispatcher->eventQ->next);
+    idle = (dispatcher == runQ) ? 1 : isEmpty(dispatcher);
     unlock(es);
     return idle;
 }
@@ -10024,14 +10827,13 @@ PUBLIC int mprStopDispatcher(MprDispatcher *dispatcher)
 
 
 /*
-    Schedule a dispatcher to run but don't disturb an already running dispatcher. If the event queue is empty,
-    the dispatcher is moved to the idleQ. If there is a past-due event, it is moved to the readyQ. If there is a future
-    event pending, it is put on the waitQ.
+    Schedule a dispatcher to run but don't disturb an already running dispatcher. If there is a due event, the
+    dispatcher is moved to the readyQ. If there are only future timers pending, it is put on the waitQ. Otherwise
+    it is moved to the idleQ. The timer wheel determines when waiting dispatchers become ready.
  */
 PUBLIC void mprScheduleDispatcher(MprDispatcher *dispatcher)
 {
     MprEventService     *es;
-    MprEvent            *event;
     int                 mustWakeWaitService, mustWakeCond;
 
     assert(dispatcher);
@@ -10049,23 +10851,19 @@ PUBLIC void mprScheduleDispatcher(MprDispatcher *dispatcher)
         mustWakeCond = dispatcher->flags & MPR_DISPATCHER_WAITING;
 
     } else if (isEmpty(dispatcher)) {
-        queueDispatcher(es->idleQ, dispatcher);
-        mustWakeCond = dispatcher->flags & MPR_DISPATCHER_WAITING;
-
-    } else {
-        event = dispatcher->eventQ->next;
-        mustWakeWaitService = mustWakeCond = 0;
-        if (event->due > es->now) {
+        if (hasTimers(dispatcher)) {
+            /* mprQueueEvent wakes the event service if a new timer is due before it will awake */
             queueDispatcher(es->waitQ, dispatcher);
-            if (event->due < es->willAwake) {
-                mustWakeWaitService = 1;
-                mustWakeCond = dispatcher->flags & MPR_DISPATCHER_WAITING;
-            }
+            mustWakeWaitService = 0;
         } else {
-            queueDispatcher(es->readyQ, dispatcher);
-            mustWakeWaitService = es->waiting;
-            mustWakeCond = dispatcher->flags & MPR_DISPATCHER_WAITING;
+            queueDispatcher(es->idleQ, dispatcher);
         }
+        mustWakeCond = dispatcher->flags & MPR_DISPATCHER_WAITING;
+
+    } else {
+        queueDispatcher(es->readyQ, dispatcher);
+        mustWakeWaitService = es->waiting;
+        mustWakeCond = dispatcher->flags & MPR_DISPATCHER_WAITING;
     }
     unlock(es);
     if (mustWakeCond) {
@@ -10203,30 +11001,19 @@ PUBLIC void mprWakePendingDispatchers()
  */
 static MprDispatcher *getNextReadyDispatcher(MprEventService *es)
 {
-    MprDispatcher   *dp, *next, *pendingQ, *readyQ, *waitQ, *dispatcher;
-    MprEvent        *event;
+    MprDispatcher   *pendingQ, *readyQ, *dispatcher;
 
-    waitQ = es->waitQ;
     readyQ = es->readyQ;
     pendingQ = es->pendingQ;
     dispatcher = 0;
 
     lock(es);
+    /*
+        Expire due timers. This moves their dispatchers from the waitQ onto the readyQ.
+     */
+    mprExpireTimers(es);
     if (pendingQ->next != pendingQ && mprAvailableWorkers() > 0) {
         dispatcher = pendingQ->next;
-
-    } else if (readyQ->next == readyQ) {
-        /*
-            ReadyQ is empty, try to transfer a dispatcher with due events onto the readyQ
-         */
-        for (dp = waitQ->next; dp != waitQ; dp = next) {
-            next = dp->next;
-            event = dp->eventQ->next;
-            if (event->due <= es->now) {
-                queueDispatcher(es->readyQ, dp);
-                break;
-            }
-        }
     }
     if (!dispatcher && readyQ->next != readyQ) {
         dispatcher = readyQ->next;
@@ -10244,11 +11031,9 @@ static MprDispatcher *getNextReadyDispatcher(MprEventService *es)
  */
 static MprTicks getIdleTicks(MprEventService *es, MprTicks timeout)
 {
-    MprDispatcher   *readyQ, *waitQ, *dp;
-    MprEvent        *event;
+    MprDispatcher   *readyQ;
     MprTicks        delay;
 
-    waitQ = es->waitQ;
     readyQ = es->readyQ;
 
     if (readyQ->next != readyQ) {
@@ -10256,19 +11041,8 @@ static MprTicks getIdleTicks(MprEventService *es, MprTicks timeout)
     } else if (mprIsStopping()) {
         delay = 10;
     } else {
-        /*
-            Examine all the dispatchers on the waitQ
-         */
         delay = es->delay ? es->delay : MPR_MAX_TIMEOUT;
-        for (dp = waitQ->next; dp != waitQ; dp = dp->next) {
-            event = dp->eventQ->next;
-            if (event != dp->eventQ) {
-                delay = min(delay, (event->due - es->now));
-                if (delay <= 0) {
-                    break;
-                }
-            }
-        }
+        delay = min(delay, mprGetTimerDelay(es));
         delay = min(delay, timeout);
         es->delay = 0;
     }
@@ -10296,11 +11070,10 @@ static MprTicks getDispatcherIdleTicks(MprDispatcher *dispatcher, MprTicks timeo
     } else {
         next = dispatcher->eventQ->next;
         delay = MPR_MAX_TIMEOUT;
-        if (next != dispatcher->eventQ) {
-            delay = (next->due - dispatcher->service->now);
-            if (delay < 0) {
-                delay = 0;
-            }
+        if (next != dispatcher->eventQ || dispatcher->inbox) {
+            delay = 0;
+        } else if (hasTimers(dispatcher)) {
+            delay = mprGetTimerDelay(es);
         }
         expires = timeout < 0 ? MPR_MAX_TIMEOUT : (es->now + timeout);
         if (expires < 0) {
@@ -10445,7 +11218,7 @@ PUBLIC bool mprDispatcherHasEvents(MprDispatcher *dispatcher)
     if (dispatcher == 0) {
         return 0;
     }
-    return !isEmpty(dispatcher);
+    return !isEmpty(dispatcher) || hasTimers(dispatcher);
 }
 
 /*
@@ -11154,10 +11927,14 @@ void epollDummy() {}
 
 /***************************** Forward Declarations ***************************/
 
+static void addTimer(MprEventService *es, MprEvent *event);
 static MprEvent *createEvent(MprDispatcher *dispatcher, cchar *name, MprTicks period, void *proc, void *data, int flags);
+static void fileTimers(MprEventService *es, int slot);
 static void initEventQ(MprEvent *q, cchar *name);
 static void manageEvent(MprEvent *event, int flags);
+static void postEvent(MprDispatcher *dispatcher, MprEvent *event);
 static void queueEvent(MprEvent *prior, MprEvent *event);
+static void unlinkTimer(MprEventService *es, MprEvent *event);
 
 /************************************* Code ***********************************/
 /*
@@ -11288,6 +12065,15 @@ static void manageEvent(MprEvent *event, int flags)
         mprMark(event->cond);
 
     } else if (flags & MPR_MANAGE_FREE) {
+        if (event->wheel) {
+            /*
+                Only reachable if the dispatcher was collected without being destroyed. Neighbours in the wheel slot
+                may belong to other dispatchers, so the event must not be left linked.
+             */
+            lock(MPR->eventService);
+            unlinkTimer(MPR->eventService, event);
+            unlock(MPR->eventService);
+        }
         if (!event->hasRun && (event->flags & MPR_EVENT_ALWAYS)) {
             (event->proc)(event->data, NULL);
         }
@@ -11295,35 +12081,106 @@ static void manageEvent(MprEvent *event, int flags)
 }
 
 
-PUBLIC void mprQueueEvent(MprDispatcher *dispatcher, MprEvent *event)
+/*
+    Queue an event. Immediate events are posted to the dispatcher inbox without locking. Other due events are
+    appended to the dispatcher event queue without any searching. Future events are put on the dispatcher timerQ and
+    filed in the event service timer wheel, both in constant time.
+ */
+PUBLIC void mprQueueEvent(MprDispatcher *dispatcher, MprEvent *event)
+{
+    MprEventService     *es;
+    int                 mustWake;
+
+    assert(dispatcher);
+    assert(event);
+    assert(event->timestamp);
+
+    if (event->due <= event->timestamp && !event->next && !event->inboxNext) {
+        if (!(dispatcher->flags & MPR_DISPATCHER_DESTROYED)) {
+            postEvent(dispatcher, event);
+        }
+        return;
+    }
+    es = dispatcher->service;
+    mustWake = 0;
+    lock(es);
+    if (!(dispatcher->flags & MPR_DISPATCHER_DESTROYED)) {
+        if (event->due <= event->timestamp || event->due <= es->now) {
+            /* Drain first so events run in the order they were queued */
+            mprDrainInbox(dispatcher);
+            queueEvent(dispatcher->eventQ->prev, event);
+        } else {
+            if (es->timerCount == 0 && es->now > es->wheelTime) {
+                /* Empty wheel, so skip forward rather than turning through idle ticks */
+                es->wheelTime = es->now;
+            }
+            queueEvent(dispatcher->timerQ, event);
+            addTimer(es, event);
+            mustWake = es->waiting && event->due < es->willAwake;
+        }
+        event->dispatcher = dispatcher;
+        es->eventCount++;
+        mprScheduleDispatcher(dispatcher);
+    }
+    unlock(es);
+    if (mustWake) {
+        mprWakeEventService();
+    }
+}
+
+
+/*
+    Push an immediate event onto the dispatcher inbox. This is lock-free except when the inbox was empty. Then the
+    dispatcher is scheduled to wake the thread that will service it. Later posts are found when the inbox is drained.
+ */
+static void postEvent(MprDispatcher *dispatcher, MprEvent *event)
 {
     MprEventService     *es;
-    MprEvent            *prior, *q;
-
-    assert(dispatcher);
-    assert(event);
-    assert(event->timestamp);
+    MprEvent            *head;
 
-    es = dispatcher->service;
-    lock(es);
-    if (!(dispatcher->flags & MPR_DISPATCHER_DESTROYED)) {
-        q = dispatcher->eventQ;
-        for (prior = q->prev; prior != q; prior = prior->prev) {
-            if (event->due > prior->due) {
-                break;
-            } else if (event->due == prior->due) {
-                break;
-            }
-        }
-        assert(prior->next);
-        assert(prior->prev);
+    event->dispatcher = dispatcher;
+    do {
+        head = dispatcher->inbox;
+        event->inboxNext = head ? head : event;
+    } while (!mprAtomicCas((void**) &dispatcher->inbox, head, event));
 
-        queueEvent(prior, event);
-        event->dispatcher = dispatcher;
+    if (head == 0) {
+        es = dispatcher->service;
+        lock(es);
         es->eventCount++;
         mprScheduleDispatcher(dispatcher);
+        unlock(es);
+    }
+}
+
+
+/*
+    Move events posted to the dispatcher inbox onto the end of its event queue in the order they were posted.
+    Must be locked when called.
+ */
+PUBLIC void mprDrainInbox(MprDispatcher *dispatcher)
+{
+    MprEvent    *event, *next, *first;
+
+    do {
+        if ((event = dispatcher->inbox) == 0) {
+            return;
+        }
+    } while (!mprAtomicCas((void**) &dispatcher->inbox, event, NULL));
+
+    /*
+        The inbox is a stack, so reverse it to run events first-in first-out
+     */
+    for (first = 0; event; event = next) {
+        next = (event->inboxNext == event) ? 0 : event->inboxNext;
+        event->inboxNext = first;
+        first = event;
+    }
+    for (event = first; event; event = next) {
+        next = event->inboxNext;
+        event->inboxNext = 0;
+        queueEvent(dispatcher->eventQ->prev, event);
     }
-    unlock(es);
 }
 
 
@@ -11339,14 +12196,18 @@ PUBLIC void mprRemoveEvent(MprEvent *event)
     if (dispatcher) {
         es = dispatcher->service;
         lock(es);
+        if (event->inboxNext) {
+            mprDrainInbox(dispatcher);
+        }
+        /*
+            If this was the last timer, the dispatcher stays on the waitQ until next scheduled. Nothing scans the
+            waitQ, so this avoids waking the event service just to move it to the idleQ.
+         */
         if (event->next && !(event->flags & MPR_EVENT_RUNNING)) {
             mprDequeueEvent(event);
         }
         event->dispatcher = 0;
         event->flags &= ~MPR_EVENT_CONTINUOUS;
-        if (event->due == es->willAwake && dispatcher->eventQ->next != dispatcher->eventQ) {
-            mprScheduleDispatcher(dispatcher);
-        }
         if (event->cond) {
             mprSignalCond(event->cond);
         }
@@ -11370,6 +12231,9 @@ PUBLIC void mprRescheduleEvent(MprEvent *event, MprTicks period)
     event->period = period;
     event->timestamp = es->now;
     event->due = event->timestamp + period;
+    if (event->inboxNext) {
+        mprDrainInbox(dispatcher);
+    }
     if (event->next) {
         continuous = event->flags & MPR_EVENT_CONTINUOUS;
         mprRemoveEvent(event);
@@ -11421,15 +12285,15 @@ PUBLIC MprEvent *mprGetNextEvent(MprDispatcher *dispatcher)
     }
     event = 0;
     lock(es);
+    mprExpireTimers(es);
+    mprDrainInbox(dispatcher);
     next = dispatcher->eventQ->next;
     if (next != dispatcher->eventQ) {
-        if (next->due <= es->now) {
-            /*
-                Hold event while executing in the current queue
-             */
-            event = next;
-            queueEvent(dispatcher->currentQ, event);
-        }
+        /*
+            Hold event while executing in the current queue
+         */
+        event = next;
+        queueEvent(dispatcher->currentQ, event);
     }
     unlock(es);
     return event;
@@ -11445,15 +12309,156 @@ PUBLIC int mprGetEventCount(MprDispatcher *dispatcher)
     es = dispatcher->service;
 
     lock(es);
+    mprDrainInbox(dispatcher);
     count = 0;
     for (event = dispatcher->eventQ->next; event != dispatcher->eventQ; event = event->next) {
         count++;
     }
+    for (event = dispatcher->timerQ->next; event != dispatcher->timerQ; event = event->next) {
+        count++;
+    }
     unlock(es);
     return count;
 }
 
 
+/*
+    Expire timers up to the current time. Due timers are moved to the end of their dispatcher event queue and the
+    dispatcher is scheduled. Must be locked when called.
+ */
+PUBLIC void mprExpireTimers(MprEventService *es)
+{
+    MprTicks    now, when;
+    int         level;
+
+    if (es->timerCount == 0) {
+        return;
+    }
+    now = es->now = mprGetTicks();
+    while (es->wheelTime < now && es->timerCount > 0) {
+        when = ++es->wheelTime;
+        for (level = 1; level < MPR_TIMER_LEVELS; level++) {
+            if (when & (((MprTicks) 1 << (level * MPR_TIMER_BITS)) - 1)) {
+                break;
+            }
+            fileTimers(es, level * MPR_TIMER_SLOTS + (int) ((when >> (level * MPR_TIMER_BITS)) & (MPR_TIMER_SLOTS - 1)));
+        }
+        fileTimers(es, (int) (when & (MPR_TIMER_SLOTS - 1)));
+    }
+    if (es->timerCount == 0 && es->wheelTime < now) {
+        es->wheelTime = now;
+    }
+}
+
+
+/*
+    Return the time to wait till the next timer may be due. Slots above the lowest level are only bounded by the time
+    they next cascade, so the result may be early but is never late. Must be locked when called.
+ */
+PUBLIC MprTicks mprGetTimerDelay(MprEventService *es)
+{
+    MprTicks    base, due, when;
+    int         level, shift, i;
+
+    if (es->timerCount == 0) {
+        return MPR_MAX_TIMEOUT;
+    }
+    due = MPR_MAX_TIMEOUT;
+    for (level = 0; level < MPR_TIMER_LEVELS; level++) {
+        shift = level * MPR_TIMER_BITS;
+        base = es->wheelTime >> shift;
+        if (((base + 1) << shift) >= due) {
+            break;
+        }
+        for (i = 1; i <= MPR_TIMER_SLOTS; i++) {
+            if (es->wheel[level * MPR_TIMER_SLOTS + (int) ((base + i) & (MPR_TIMER_SLOTS - 1))]) {
+                when = (base + i) << shift;
+                due = min(due, when);
+                break;
+            }
+        }
+    }
+    return due > es->now ? due - es->now : 0;
+}
+
+
+/*
+    File a future event into the timer wheel. Timers due within MPR_TIMER_SLOTS ticks go into the lowest level.
+    Later timers go into the level whose slots span the delay and are cascaded down as the wheel turns.
+    Timers beyond the last level are parked in its furthest slot and re-filed when it cascades.
+ */
+static void addTimer(MprEventService *es, MprEvent *event)
+{
+    MprEvent    **head;
+    MprTicks    due, delta, horizon;
+    int         level, slot;
+
+    due = max(event->due, es->wheelTime + 1);
+    delta = due - es->wheelTime;
+    for (level = 0; level < MPR_TIMER_LEVELS - 1; level++) {
+        if (delta < ((MprTicks) 1 << ((level + 1) * MPR_TIMER_BITS))) {
+            break;
+        }
+    }
+    horizon = (MprTicks) 1 << (MPR_TIMER_LEVELS * MPR_TIMER_BITS);
+    if (delta >= horizon) {
+        due = es->wheelTime + horizon - 1;
+    }
+    slot = level * MPR_TIMER_SLOTS + (int) ((due >> (level * MPR_TIMER_BITS)) & (MPR_TIMER_SLOTS - 1));
+    head = &es->wheel[slot];
+    event->timerPrev = 0;
+    event->timerNext = *head;
+    if (*head) {
+        (*head)->timerPrev = event;
+    }
+    *head = event;
+    event->wheel = slot + 1;
+    es->timerCount++;
+}
+
+
+/*
+    Empty a wheel slot. Due timers are expired and the rest are re-filed into lower levels.
+ */
+static void fileTimers(MprEventService *es, int slot)
+{
+    MprDispatcher   *dispatcher;
+    MprEvent        *event, *next;
+
+    next = es->wheel[slot];
+    es->wheel[slot] = 0;
+    while ((event = next) != 0) {
+        next = event->timerNext;
+        event->timerNext = event->timerPrev = 0;
+        event->wheel = 0;
+        es->timerCount--;
+        if (event->due <= es->wheelTime) {
+            dispatcher = event->dispatcher;
+            queueEvent(dispatcher->eventQ->prev, event);
+            mprScheduleDispatcher(dispatcher);
+        } else {
+            addTimer(es, event);
+        }
+    }
+}
+
+
+static void unlinkTimer(MprEventService *es, MprEvent *event)
+{
+    if (event->timerPrev) {
+        event->timerPrev->timerNext = event->timerNext;
+    } else {
+        es->wheel[event->wheel - 1] = event->timerNext;
+    }
+    if (event->timerNext) {
+        event->timerNext->timerPrev = event->timerPrev;
+    }
+    event->timerNext = event->timerPrev = 0;
+    event->wheel = 0;
+    es->timerCount--;
+}
+
+
 static void initEventQ(MprEvent *q, cchar *name)
 {
     assert(q);
@@ -11493,6 +12498,9 @@ PUBLIC void mprDequeueEvent(MprEvent *event)
 {
     assert(event);
 
+    if (event->wheel) {
+        unlinkTimer(MPR->eventService, event);
+    }
     /* If a continuous event is removed, next may already be null */
     if (event->next) {
         event->next->prev = event->prev;
@@ -22259,7 +23267,7 @@ PUBLIC Socket mprListenOnSocket(MprSocket *sp, cchar *ip, int port, int flags)
     sp->fd = INVALID_SOCKET;
     sp->port = port;
     sp->flags = (flags & (MPR_SOCKET_BROADCAST | MPR_SOCKET_DATAGRAM | MPR_SOCKET_BLOCK |
-         MPR_SOCKET_NOREUSE | MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD));
+         MPR_SOCKET_NOREUSE | MPR_SOCKET_NODELAY | MPR_SOCKET_THREAD | MPR_SOCKET_REUSEPORT));
     datagram = sp->flags & MPR_SOCKET_DATAGRAM;
 
     /*
@@ -22291,11 +23299,15 @@ PUBLIC Socket mprListenOnSocket(MprSocket *sp, cchar *ip, int port, int flags)
         if (setsockopt(sp->fd, SOL_SOCKET, SO_REUSEADDR, (char*) &enable, sizeof(enable)) != 0) {
             mprLog("error mpr socket", 3, "Cannot set reuseaddr, errno %d", errno);
         }
-#if defined(SO_REUSEPORT) && MULTIPLE_SERVERS
+#if defined(SO_REUSEPORT)
+    #if MULTIPLE_SERVERS
+        sp->flags |= MPR_SOCKET_REUSEPORT;
+    #endif
         /*
-            This permits multiple servers listening on the same endpoint
+            This permits multiple servers listening on the same endpoint. The kernel balances connections over them.
          */
-        if (setsockopt(sp->fd, SOL_SOCKET, SO_REUSEPORT, (char*) &enable, sizeof(enable)) != 0) {
+        if ((sp->flags & MPR_SOCKET_REUSEPORT) &&
+                setsockopt(sp->fd, SOL_SOCKET, SO_REUSEPORT, (char*) &enable, sizeof(enable)) != 0) {
             mprLog("error mpr socket", 3, "Cannot set reuseport, errno %d", errno);
         }
 #endif
@@ -23196,6 +24208,24 @@ PUBLIC Socket mprGetSocketHandle(MprSocket *sp)
 }
 
 
+/*
+    Get the CPU that processed incoming packets for the socket. With RSS, this is the core servicing the receive queue.
+ */
+PUBLIC int mprGetSocketCpu(MprSocket *sp)
+{
+#ifdef SO_INCOMING_CPU
+    Socklen     len;
+    int         cpu;
+
+    len = sizeof(cpu);
+    if (sp && sp->fd != INVALID_SOCKET && getsockopt(sp->fd, SOL_SOCKET, SO_INCOMING_CPU, (char*) &cpu, &len) == 0) {
+        return cpu;
+    }
+#endif
+    return -1;
+}
+
+
 PUBLIC Socket mprStealSocketHandle(MprSocket *sp)
 {
     Socket  fd;
@@ -25184,15 +26214,28 @@ PUBLIC void serase(char *str)
 
 
 
+/*********************************** Locals ***********************************/
+/*
+    Job waiting in the worker service queue for a busy worker to complete
+ */
+typedef struct MprWorkerJob {
+    MprWorkerProc       proc;           /* Procedure to run */
+    void                *data;          /* Data parameter to the procedure */
+    MprTicks            queued;         /* Time the job was queued */
+} MprWorkerJob;
+
 /*************************** Forward Declarations ****************************/
 
 static void changeState(MprWorker *worker, int state);
 static MprWorker *createWorker(MprWorkerService *ws, ssize stackSize);
+static bool dequeueJob(MprWorkerService *ws, MprWorker *worker);
+static MprWorker *getIdleWorker(MprWorkerService *ws, int cpu);
 static int getNextThreadNum(MprWorkerService *ws);
 static void manageThreadService(MprThreadService *ts, int flags);
 static void manageThread(MprThread *tp, int flags);
 static void manageWorker(MprWorker *worker, int flags);
 static void manageWorkerService(MprWorkerService *ws, int flags);
+static void pinThread(int cpu);
 static void pruneWorkers(MprWorkerService *ws, MprEvent *timer);
 static void threadProc(MprThread *tp);
 static void workerMain(MprWorker *worker, MprThread *tp);
@@ -25707,17 +26750,28 @@ PUBLIC MprWorkerService *mprCreateWorkerService()
     mprSetListLimits(ws->idleThreads, ws->maxThreads, -1);
     ws->busyThreads = mprCreateList(0, 0);
     mprSetListLimits(ws->busyThreads, ws->maxThreads, -1);
+    if (ME_MPR_WORKER_QUEUE > 0) {
+        ws->queue = mprAllocZeroed(ME_MPR_WORKER_QUEUE * sizeof(MprWorkerJob));
+        ws->queueSize = ME_MPR_WORKER_QUEUE;
+    }
     return ws;
 }
 
 
 static void manageWorkerService(MprWorkerService *ws, int flags)
 {
+    int     i;
+
     if (flags & MPR_MANAGE_MARK) {
         mprMark(ws->busyThreads);
         mprMark(ws->idleThreads);
         mprMark(ws->mutex);
         mprMark(ws->pruneTimer);
+        mprMark(ws->queue);
+        mprMark(ws->cpus);
+        for (i = 0; i < ws->queueCount; i++) {
+            mprMark(ws->queue[(ws->queueHead + i) % ws->queueSize].data);
+        }
     }
 }
 
@@ -25754,6 +26808,13 @@ PUBLIC void mprStopWorkers()
     for (next = -1; (worker = (MprWorker*) mprGetPrevItem(ws->idleThreads, &next)) != 0; ) {
         changeState(worker, MPR_WORKER_BUSY);
     }
+    /*
+        Discard queued jobs. Busy workers exit rather than take another job once stopping.
+     */
+    if (ws->queueCount > 0) {
+        memset(ws->queue, 0, ws->queueSize * sizeof(MprWorkerJob));
+        ws->queueHead = ws->queueCount = 0;
+    }
     unlock(ws);
 }
 
@@ -25774,6 +26835,7 @@ PUBLIC void mprSetMinWorkers(int n)
     }
     while (ws->numThreads < ws->minThreads) {
         worker = createWorker(ws, ws->stackSize);
+        worker->cpu = mprSelectWorkerCpu(-1);
         ws->numThreads++;
         ws->maxUsedThreads = max(ws->numThreads, ws->maxUsedThreads);
         changeState(worker, MPR_WORKER_BUSY);
@@ -25811,6 +26873,37 @@ PUBLIC int mprGetMaxWorkers()
 }
 
 
+/*
+    Define the size of the queue of jobs waiting for a worker. The queue is never shrunk below the jobs it holds.
+ */
+PUBLIC void mprSetWorkerQueueLimit(int n)
+{
+    MprWorkerService    *ws;
+    MprWorkerJob        *queue;
+    int                 i;
+
+    if ((ws = MPR->workerService) == 0) {
+        return;
+    }
+    lock(ws);
+    n = max(n, ws->queueCount);
+    if (n != ws->queueSize) {
+        queue = 0;
+        if (n > 0 && (queue = mprAllocZeroed(n * sizeof(MprWorkerJob))) == 0) {
+            unlock(ws);
+            return;
+        }
+        for (i = 0; i < ws->queueCount; i++) {
+            queue[i] = ws->queue[(ws->queueHead + i) % ws->queueSize];
+        }
+        ws->queue = queue;
+        ws->queueSize = n;
+        ws->queueHead = 0;
+    }
+    unlock(ws);
+}
+
+
 /*
     Return the current worker thread object
  */
@@ -25882,6 +26975,13 @@ PUBLIC void mprGetWorkerStats(MprWorkerStats *stats)
          */
         stats->yielded += (wp->thread->yielded && wp->running);
     }
+    stats->queued = ws->queueCount;
+    stats->maxQueued = ws->maxQueued;
+    stats->queueLimit = ws->queueSize;
+    stats->totalQueued = ws->totalQueued;
+    stats->rejected = ws->rejected;
+    stats->queueWait = (int) (ws->queueWait / max(ws->totalQueued - ws->queueCount, 1));
+    stats->queueWaitMax = (int) ws->queueWaitMax;
     unlock(ws);
 }
 
@@ -25920,10 +27020,136 @@ PUBLIC int mprAvailableWorkers()
 }
 
 
+/*
+    Define the CPUs to pin workers to. Format is a comma separated list of CPU numbers and ranges: "0-3,6".
+ */
+PUBLIC int mprSetWorkerAffinity(cchar *cpus)
+{
+    MprWorkerService    *ws;
+    char                *tok, *next, *dash;
+    int                 *set, count, ncpu, lo, hi, cpu;
+
+    if ((ws = MPR->workerService) == 0) {
+        return MPR_ERR_BAD_STATE;
+    }
+    if (cpus == 0 || *cpus == '\0' || smatch(cpus, "none")) {
+        lock(ws);
+        ws->cpus = 0;
+        ws->numCpus = 0;
+        unlock(ws);
+        return 0;
+    }
+    set = 0;
+    count = 0;
+    if (smatch(cpus, "all")) {
+        ncpu = max((int) MPR->heap->stats.cpuCores, 1);
+        if ((set = mprAlloc(ncpu * sizeof(int))) == 0) {
+            return MPR_ERR_MEMORY;
+        }
+        for (cpu = 0; cpu < ncpu; cpu++) {
+            set[count++] = cpu;
+        }
+    } else {
+        for (tok = stok(sclone(cpus), ", \t", &next); tok; tok = stok(NULL, ", \t", &next)) {
+            if (!isdigit((uchar) *tok)) {
+                return MPR_ERR_BAD_ARGS;
+            }
+            lo = hi = (int) stoi(tok);
+            if ((dash = schr(tok, '-')) != 0) {
+                if (!isdigit((uchar) dash[1])) {
+                    return MPR_ERR_BAD_ARGS;
+                }
+                hi = (int) stoi(&dash[1]);
+            }
+            if (lo > hi || hi >= MPR_MAX_CPU) {
+                return MPR_ERR_BAD_ARGS;
+            }
+            if ((set = mprRealloc(set, (count + hi - lo + 1) * sizeof(int))) == 0) {
+                return MPR_ERR_MEMORY;
+            }
+            for (cpu = lo; cpu <= hi; cpu++) {
+                set[count++] = cpu;
+            }
+        }
+        if (count == 0) {
+            return MPR_ERR_BAD_ARGS;
+        }
+    }
+    lock(ws);
+    ws->cpus = set;
+    ws->numCpus = count;
+    ws->nextCpu = 0;
+    unlock(ws);
+    return 0;
+}
+
+
+/*
+    Map a CPU hint onto the affinity set. Returns -1 if affinity is not enabled.
+ */
+PUBLIC int mprSelectWorkerCpu(int hint)
+{
+    MprWorkerService    *ws;
+    int                 *cpus, count, i;
+
+    ws = MPR->workerService;
+    if (!ws || (cpus = ws->cpus) == 0 || (count = ws->numCpus) <= 0) {
+        return -1;
+    }
+    if (hint < 0) {
+        i = mprAtomicAddFetch(&ws->nextCpu, 1) - 1;
+        return cpus[(uint) i % count];
+    }
+    for (i = 0; i < count; i++) {
+        if (cpus[i] == hint) {
+            return hint;
+        }
+    }
+    return cpus[hint % count];
+}
+
+
 PUBLIC int mprStartWorker(MprWorkerProc proc, void *data)
+{
+    return mprStartWorkerOnCpu(proc, data, -1);
+}
+
+
+/*
+    Get an idle worker. Prefer a worker pinned to the requested CPU. If none, return null if a new pinned worker
+    can be created and the CPU has fewer than MPR_WORKERS_PER_CPU workers. Otherwise, use the most recently used
+    idle worker even if it is pinned to another CPU. Must be called locked.
+ */
+static MprWorker *getIdleWorker(MprWorkerService *ws, int cpu)
+{
+    MprWorker   *worker;
+    int         count, next;
+
+    if (cpu >= 0) {
+        for (next = -1; (worker = (MprWorker*) mprGetPrevItem(ws->idleThreads, &next)) != 0; ) {
+            if (worker->cpu == cpu) {
+                return worker;
+            }
+        }
+        if (ws->numThreads < ws->maxThreads && mprAvailableWorkers() > 0) {
+            count = 0;
+            for (ITERATE_ITEMS(ws->busyThreads, worker, next)) {
+                count += (worker->cpu == cpu);
+            }
+            if (count < MPR_WORKERS_PER_CPU || mprGetListLength(ws->idleThreads) == 0) {
+                return 0;
+            }
+        }
+    }
+    return mprGetLastItem(ws->idleThreads);
+}
+
+
+PUBLIC int mprStartWorkerOnCpu(MprWorkerProc proc, void *data, int cpu)
 {
     MprWorkerService    *ws;
     MprWorker           *worker;
+    MprWorkerJob        *job;
 
     if ((ws = MPR->workerService) == 0) {
         return MPR_ERR_BAD_ARGS;
@@ -25937,9 +27163,10 @@ PUBLIC int mprStartWorker(MprWorkerProc proc, void *data)
         Try to find an idle thread and wake it up. It will wakeup in workerMain(). If not any available, then add
         another thread to the worker. Must account for workers we've already created but have not yet gone to work
         and inserted themselves in the idle/busy queues. Get most recently used idle worker so we tend to reuse
-        active threads. This lets the pruner trim idle workers.
+        active threads. This lets the pruner trim idle workers. If the pool is at its maximum size, queue the job
+        for the next worker to complete its current job. Workers only go idle when the queue is empty.
      */
-    worker = mprGetLastItem(ws->idleThreads);
+    worker = getIdleWorker(ws, cpu);
     if (worker) {
         worker->data = data;
         worker->proc = proc;
@@ -25951,6 +27178,7 @@ PUBLIC int mprStartWorker(MprWorkerProc proc, void *data)
             return MPR_ERR_BUSY;
         }
         worker = createWorker(ws, ws->stackSize);
+        worker->cpu = (cpu >= 0) ? cpu : mprSelectWorkerCpu(-1);
         ws->numThreads++;
         ws->maxUsedThreads = max(ws->numThreads, ws->maxUsedThreads);
         worker->data = data;
@@ -25958,7 +27186,17 @@ PUBLIC int mprStartWorker(MprWorkerProc proc, void *data)
         changeState(worker, MPR_WORKER_BUSY);
         mprStartThread(worker->thread);
 
+    } else if (ws->queueCount < ws->queueSize) {
+        job = &ws->queue[(ws->queueHead + ws->queueCount) % ws->queueSize];
+        job->proc = proc;
+        job->data = data;
+        job->queued = mprGetTicks();
+        ws->queueCount++;
+        ws->maxQueued = max(ws->queueCount, ws->maxQueued);
+        ws->totalQueued++;
+
     } else {
+        ws->rejected += (ws->queueSize > 0);
         unlock(ws);
         return MPR_ERR_BUSY;
     }
@@ -26040,6 +27278,7 @@ static MprWorker *createWorker(MprWorkerService *ws, ssize stackSize)
     }
     worker->workerService = ws;
     worker->idleCond = mprCreateCond();
+    worker->cpu = -1;
 
     fmt(name, sizeof(name), "worker.%u", getNextThreadNum(ws));
     mprLog("info mpr thread", 5, "Create %s, pool has %d workers. Limits %d-%d.", name, ws->numThreads + 1,
@@ -26069,6 +27308,9 @@ static void workerMain(MprWorker *worker, MprThread *tp)
     assert(worker->state == MPR_WORKER_BUSY);
     assert(!worker->idleCond->triggered);
 
+    if (worker->cpu >= 0) {
+        pinThread(worker->cpu);
+    }
     if (ws->startWorker) {
         (*ws->startWorker)(worker->data, worker);
     }
@@ -26092,8 +27334,20 @@ static void workerMain(MprWorker *worker, MprThread *tp)
         }
         worker->proc = 0;
         worker->data = 0;
+        if (dequeueJob(ws, worker)) {
+            if (mprNeedYield()) {
+                mprYield(0);
+            }
+            continue;
+        }
         changeState(worker, MPR_WORKER_IDLE);
 
+        /*
+            A job may have been queued after the queue was checked and before this worker became idle
+         */
+        if (dequeueJob(ws, worker)) {
+            continue;
+        }
         /*
             Sleep till there is more work to do. Yield for GC first.
          */
@@ -26110,6 +27364,61 @@ static void workerMain(MprWorker *worker, MprThread *tp)
 }
 
 
+/*
+    Pin the current thread to a CPU. Only supported on Linux.
+ */
+static void pinThread(int cpu)
+{
+#if LINUX
+    cpu_set_t   set;
+    int         rc;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if ((rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) != 0) {
+        mprLog("warn mpr thread", 2, "Cannot pin worker to CPU %d, errno %d", cpu, rc);
+    }
+#endif
+}
+
+
+/*
+    Assign the oldest queued job to a worker that has completed its job. If the worker has gone idle, it is made
+    busy again without waking. Return true if a job was assigned.
+ */
+static bool dequeueJob(MprWorkerService *ws, MprWorker *worker)
+{
+    MprWorkerJob    *job;
+    MprTicks        elapsed;
+
+    if (ws->queueCount == 0) {
+        return 0;
+    }
+    lock(ws);
+    if (ws->queueCount == 0 || worker->proc || mprIsStopping() ||
+            (worker->state != MPR_WORKER_BUSY && worker->state != MPR_WORKER_IDLE)) {
+        unlock(ws);
+        return 0;
+    }
+    job = &ws->queue[ws->queueHead];
+    worker->proc = job->proc;
+    worker->data = job->data;
+    elapsed = mprGetElapsedTicks(job->queued);
+    job->proc = 0;
+    job->data = 0;
+    ws->queueHead = (ws->queueHead + 1) % ws->queueSize;
+    ws->queueCount--;
+    ws->queueWait += elapsed;
+    ws->queueWaitMax = max(elapsed, ws->queueWaitMax);
+    if (worker->state == MPR_WORKER_IDLE) {
+        changeState(worker, MPR_WORKER_BUSY);
+        mprResetCond(worker->idleCond);
+    }
+    unlock(ws);
+    return 1;
+}
+
+
 static void changeState(MprWorker *worker, int state)
 {
     MprWorkerService    *ws;
@@ -319,6 +319,7 @@ PUBLIC void httpAddStream(HttpNet *net, HttpStream *stream)
 {
     mprAddItem(net->streams, stream);
     stream->net = net;
+    httpUpdateDeadline(stream);
 }
 
 
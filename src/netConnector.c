@@ -22,6 +22,7 @@ static HttpPacket *getPacket(HttpNet *net, ssize *size);
 static void netOutgoing(HttpQueue *q, HttpPacket *packet);
 static void netOutgoingService(HttpQueue *q);
 static HttpPacket *readPacket(HttpNet *net);
+static void refuseConnection(HttpNet *net, HttpRate *rate, MprTicks wait);
 static void resumeEvents(HttpNet *net, MprEvent *event);
 static int sleuthProtocol(HttpNet *net, HttpPacket *packet);
 
@@ -52,7 +53,9 @@ PUBLIC HttpNet *httpAccept(HttpEndpoint *endpoint, MprEvent *event)
     HttpNet     *net;
     HttpAddress *address;
     HttpLimits  *limits;
+    HttpRate    *rate;
     MprSocket   *sock;
+    MprTicks    wait;
     int64       value;
 
     assert(event);
@@ -102,6 +105,20 @@ PUBLIC HttpNet *httpAccept(HttpEndpoint *endpoint, MprEvent *event)
         }
     }
 #endif
+    rate = net->http->connectionRate;
+    if (rate && address && (wait = httpCheckRate(rate, &address->connectionTat, net->http->now, rate->defer)) > 0) {
+        if (wait > rate->defer) {
+            refuseConnection(net, rate, wait);
+            return 0;
+        }
+        /*
+            A token is reserved. Defer reading from the connection until then.
+         */
+        httpLog(net->trace, "monitor.rate.defer", "context", "client:'%s', delay:%lld", net->ip, wait);
+        net->delay = (int) wait;
+        mprCreateEvent(net->dispatcher, "deferConn", wait, resumeEvents, net, 0);
+        return net;
+    }
     event->mask = MPR_READABLE;
     event->timestamp = net->http->now;
     (net->ioCallback)(net, event);
@@ -268,6 +285,24 @@ static HttpPacket *getPacket(HttpNet *net, ssize *lenp)
 }
 
 
+/*
+    Refuse a connection that exceeds the client connection rate. Send a minimal response if a status is configured.
+ */
+static void refuseConnection(HttpNet *net, HttpRate *rate, MprTicks wait)
+{
+    cchar   *response;
+
+    mprLog("net info", 3, "Connection rate exceeded for client %s", net->ip);
+    httpMonitorNetEvent(net, HTTP_COUNTER_LIMIT_ERRORS, 1);
+    if (rate->status && !net->endpoint->ssl) {
+        response = sfmt("HTTP/1.1 %d %s\r\nConnection: close\r\nContent-Length: 0\r\nRetry-After: %lld\r\n\r\n",
+            rate->status, httpLookupStatus(rate->status), (wait + TPS - 1) / TPS);
+        mprWriteSocket(net->sock, response, slen(response));
+    }
+    httpDestroyNet(net);
+}
+
+
 static bool netBanned(HttpNet *net)
 {
     HttpAddress     *address;
@@ -152,20 +152,20 @@ static void processFirst(HttpQueue *q)
         httpLog(stream->trace, "http.rx.request", "request", "method:'%s', uri:'%s', protocol:'%d'",
             rx->method, rx->uri, stream->net->protocol);
         httpLog(stream->trace, "http.rx.headers", "headers", "\n\n%s %s %s\n%s",
-            rx->originalMethod, rx->uri, rx->protocol, httpTraceHeaders(q, stream->rx->headers));
+            rx->originalMethod, rx->uri, rx->protocol, httpTraceHeaders(q, httpGetHeaderHash(stream)));
     }
 }
 
 
 static void processHeaders(HttpQueue *q)
 {
-    HttpNet     *net;
-    HttpStream  *stream;
-    HttpRx      *rx;
-    HttpTx      *tx;
-    MprKey      *kp;
-    char        *cp, *key, *value, *tok;
-    int         keepAliveHeader;
+    HttpNet         *net;
+    HttpStream      *stream;
+    HttpRx          *rx;
+    HttpTx          *tx;
+    HttpHeaderField *field;
+    char            *cp, *key, *value, *tok;
+    int             i, keepAliveHeader;
 
     net = q->net;
     stream = q->stream;
@@ -173,32 +173,35 @@ static void processHeaders(HttpQueue *q)
     tx = stream->tx;
     keepAliveHeader = 0;
 
-    for (ITERATE_KEYS(rx->headers, kp)) {
-        key = kp->key;
-        value = (char*) kp->data;
-        switch (tolower((uchar) key[0])) {
-        case 'a':
-            if (strcasecmp(key, "authorization") == 0) {
-                value = sclone(value);
-                stream->authType = slower(stok(value, " \t", &tok));
-                rx->authDetails = sclone(tok);
+    for (i = 0; i < rx->fieldCount; i++) {
+        field = &rx->fields[i];
+        key = (char*) field->key;
+        value = (char*) field->value;
+        switch (field->id) {
+        case HTTP_HEADER_AUTHORIZATION:
+            value = sclone(value);
+            stream->authType = slower(stok(value, " \t", &tok));
+            rx->authDetails = sclone(tok);
+            break;
 
-            } else if (strcasecmp(key, "accept-charset") == 0) {
-                rx->acceptCharset = sclone(value);
+        case HTTP_HEADER_ACCEPT_CHARSET:
+            rx->acceptCharset = sclone(value);
+            break;
 
-            } else if (strcasecmp(key, "accept") == 0) {
-                rx->accept = sclone(value);
+        case HTTP_HEADER_ACCEPT:
+            rx->accept = sclone(value);
+            break;
 
-            } else if (strcasecmp(key, "accept-encoding") == 0) {
-                rx->acceptEncoding = sclone(value);
+        case HTTP_HEADER_ACCEPT_ENCODING:
+            rx->acceptEncoding = sclone(value);
+            break;
 
-            } else if (strcasecmp(key, "accept-language") == 0) {
-                rx->acceptLanguage = sclone(value);
-            }
+        case HTTP_HEADER_ACCEPT_LANGUAGE:
+            rx->acceptLanguage = sclone(value);
             break;
 
-        case 'c':
-            if (strcasecmp(key, "connection") == 0 && net->protocol < 2) {
+        case HTTP_HEADER_CONNECTION:
+            if (net->protocol < 2) {
                 rx->connection = sclone(value);
                 if (scaselesscmp(value, "KEEP-ALIVE") == 0) {
                     keepAliveHeader = 1;
@@ -206,230 +209,214 @@ static void processHeaders(HttpQueue *q)
                 } else if (scaselesscmp(value, "CLOSE") == 0) {
                     stream->keepAliveCount = 0;
                 }
+            }
+            break;
 
-            } else if (strcasecmp(key, "content-length") == 0) {
-                if (rx->length >= 0) {
-                    httpBadRequestError(stream, HTTP_CLOSE | HTTP_CODE_BAD_REQUEST, "Mulitple content length headers");
-                    break;
-                }
-                rx->length = stoi(value);
-                if (rx->length < 0) {
-                    httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad content length");
-                    return;
-                }
-                rx->contentLength = sclone(value);
-                assert(rx->length >= 0);
-                if (httpServerStream(stream) || !scaselessmatch(tx->method, "HEAD")) {
-                    rx->remainingContent = rx->length;
-                    rx->needInputPipeline = 1;
-                }
+        case HTTP_HEADER_CONTENT_LENGTH:
+            if (rx->length >= 0) {
+                httpBadRequestError(stream, HTTP_CLOSE | HTTP_CODE_BAD_REQUEST, "Mulitple content length headers");
+                break;
+            }
+            rx->length = stoi(value);
+            if (rx->length < 0) {
+                httpBadRequestError(stream, HTTP_ABORT | HTTP_CODE_BAD_REQUEST, "Bad content length");
+                return;
+            }
+            rx->contentLength = sclone(value);
+            assert(rx->length >= 0);
+            if (httpServerStream(stream) || !scaselessmatch(tx->method, "HEAD")) {
+                rx->remainingContent = rx->length;
+                rx->needInputPipeline = 1;
+            }
+            break;
 
-            } else if (strcasecmp(key, "content-range") == 0) {
-                /*
-                    The Content-Range header is used in the response. The Range header is used in the request.
-                    This headers specifies the range of any posted body data
-                    Format is:  Content-Range: bytes n1-n2/length
-                    Where n1 is first byte pos and n2 is last byte pos
-                 */
-                char    *sp;
-                MprOff  start, end, size;
+        case HTTP_HEADER_CONTENT_RANGE: {
+            /*
+                The Content-Range header is used in the response. The Range header is used in the request.
+                This headers specifies the range of any posted body data
+                Format is:  Content-Range: bytes n1-n2/length
+                Where n1 is first byte pos and n2 is last byte pos
+             */
+            char    *sp;
+            MprOff  start, end, size;
 
-                start = end = size = -1;
-                sp = value;
-                while (*sp && !isdigit((uchar) *sp)) {
-                    sp++;
-                }
-                if (*sp) {
-                    start = stoi(sp);
-                    if ((sp = strchr(sp, '-')) != 0) {
-                        end = stoi(++sp);
-                        if ((sp = strchr(sp, '/')) != 0) {
-                            /*
-                                Note this is not the content length transmitted, but the original size of the input of which
-                                the client is transmitting only a portion.
-                             */
-                            size = stoi(++sp);
-                        }
-                    }
-                }
-                if (start < 0 || end < 0 || size < 0 || end < start) {
-                    httpBadRequestError(stream, HTTP_CLOSE | HTTP_CODE_RANGE_NOT_SATISFIABLE, "Bad content range");
-                    break;
-                }
-                rx->inputRange = httpCreateRange(stream, start, end);
-
-            } else if (strcasecmp(key, "content-type") == 0) {
-                rx->mimeType = sclone(value);
-                if (rx->flags & (HTTP_POST | HTTP_PUT)) {
-                    if (httpServerStream(stream)) {
-                        rx->form = scontains(rx->mimeType, "application/x-www-form-urlencoded") != 0;
-                        rx->json = sstarts(rx->mimeType, "application/json");
-                        rx->upload = scontains(rx->mimeType, "multipart/form-data") != 0;
+            start = end = size = -1;
+            sp = value;
+            while (*sp && !isdigit((uchar) *sp)) {
+                sp++;
+            }
+            if (*sp) {
+                start = stoi(sp);
+                if ((sp = strchr(sp, '-')) != 0) {
+                    end = stoi(++sp);
+                    if ((sp = strchr(sp, '/')) != 0) {
+                        /*
+                            Note this is not the content length transmitted, but the original size of the input of which
+                            the client is transmitting only a portion.
+                         */
+                        size = stoi(++sp);
                     }
                 }
-            } else if (strcasecmp(key, "cookie") == 0) {
-                /* Should be only one cookie header really with semicolon delimmited key/value pairs */
-                if (rx->cookie && *rx->cookie) {
-                    rx->cookie = sjoin(rx->cookie, "; ", value, NULL);
-                } else {
-                    rx->cookie = sclone(value);
-                }
             }
+            if (start < 0 || end < 0 || size < 0 || end < start) {
+                httpBadRequestError(stream, HTTP_CLOSE | HTTP_CODE_RANGE_NOT_SATISFIABLE, "Bad content range");
+                break;
+            }
+            rx->inputRange = httpCreateRange(stream, start, end);
             break;
+        }
 
-        case 'e':
-            if (strcasecmp(key, "expect") == 0) {
-                /*
-                    Handle 100-continue for HTTP/1.1+ clients only. This is the only expectation that is currently supported.
-                 */
-                if (stream->net->protocol > 0) {
-                    if (strcasecmp(value, "100-continue") != 0) {
-                        httpBadRequestError(stream, HTTP_CODE_EXPECTATION_FAILED, "Expect header value is not supported");
-                    } else {
-                        rx->flags |= HTTP_EXPECT_CONTINUE;
-                    }
+        case HTTP_HEADER_CONTENT_TYPE:
+            rx->mimeType = sclone(value);
+            if (rx->flags & (HTTP_POST | HTTP_PUT)) {
+                if (httpServerStream(stream)) {
+                    rx->form = scontains(rx->mimeType, "application/x-www-form-urlencoded") != 0;
+                    rx->json = sstarts(rx->mimeType, "application/json");
+                    rx->upload = scontains(rx->mimeType, "multipart/form-data") != 0;
                 }
             }
             break;
 
-        case 'h':
-            if (strcasecmp(key, "host") == 0) {
-                if ((int) strspn(value, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_-.[]:")
-                        < (int) slen(value)) {
-                    httpBadRequestError(stream, HTTP_CODE_BAD_REQUEST, "Bad host header");
+        case HTTP_HEADER_COOKIE:
+            /* Should be only one cookie header really with semicolon delimmited key/value pairs */
+            if (rx->cookie && *rx->cookie) {
+                rx->cookie = sjoin(rx->cookie, "; ", value, NULL);
+            } else {
+                rx->cookie = sclone(value);
+            }
+            break;
+
+        case HTTP_HEADER_EXPECT:
+            /*
+                Handle 100-continue for HTTP/1.1+ clients only. This is the only expectation that is currently supported.
+             */
+            if (stream->net->protocol > 0) {
+                if (strcasecmp(value, "100-continue") != 0) {
+                    httpBadRequestError(stream, HTTP_CODE_EXPECTATION_FAILED, "Expect header value is not supported");
                 } else {
-                    rx->hostHeader = sclone(value);
+                    rx->flags |= HTTP_EXPECT_CONTINUE;
                 }
             }
             break;
 
-        case 'i':
-            if ((strcasecmp(key, "if-modified-since") == 0) || (strcasecmp(key, "if-unmodified-since") == 0)) {
-                MprTime     newDate = 0;
-                char        *cp;
-                bool        ifModified = (tolower((uchar) key[3]) == 'm');
-
-                if ((cp = strchr(value, ';')) != 0) {
-                    *cp = '\0';
-                }
-                if (mprParseTime(&newDate, value, MPR_UTC_TIMEZONE, NULL) < 0) {
-                    assert(0);
-                    break;
-                }
-                if (newDate) {
-                    rx->since = newDate;
-                    rx->ifModified = ifModified;
-                    rx->flags |= HTTP_IF_MODIFIED;
-                }
+        case HTTP_HEADER_HOST:
+            if ((int) strspn(value, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_-.[]:")
+                    < (int) slen(value)) {
+                httpBadRequestError(stream, HTTP_CODE_BAD_REQUEST, "Bad host header");
+            } else {
+                rx->hostHeader = sclone(value);
+            }
+            break;
 
-            } else if ((strcasecmp(key, "if-match") == 0) || (strcasecmp(key, "if-none-match") == 0)) {
-                char    *word, *tok;
-                bool    ifMatch = (tolower((uchar) key[3]) == 'm');
+        case HTTP_HEADER_IF_MODIFIED_SINCE:
+        case HTTP_HEADER_IF_UNMODIFIED_SINCE: {
+            MprTime     newDate = 0;
+            bool        ifModified = (field->id == HTTP_HEADER_IF_MODIFIED_SINCE);
 
-                if ((tok = strchr(value, ';')) != 0) {
-                    *tok = '\0';
-                }
-                rx->ifMatch = ifMatch;
+            if ((cp = strchr(value, ';')) != 0) {
+                *cp = '\0';
+            }
+            if (mprParseTime(&newDate, value, MPR_UTC_TIMEZONE, NULL) < 0) {
+                assert(0);
+                break;
+            }
+            if (newDate) {
+                rx->since = newDate;
+                rx->ifModified = ifModified;
                 rx->flags |= HTTP_IF_MODIFIED;
-                value = sclone(value);
-                word = stok(value, " ,", &tok);
-                while (word) {
-                    addMatchEtag(stream, word);
-                    word = stok(0, " ,", &tok);
-                }
+            }
+            break;
+        }
 
-            } else if (strcasecmp(key, "if-range") == 0) {
-                char    *word, *tok;
-                if ((tok = strchr(value, ';')) != 0) {
-                    *tok = '\0';
-                }
-                rx->ifMatch = 1;
-                rx->flags |= HTTP_IF_MODIFIED;
-                value = sclone(value);
-                word = stok(value, " ,", &tok);
-                while (word) {
-                    addMatchEtag(stream, word);
-                    word = stok(0, " ,", &tok);
-                }
+        case HTTP_HEADER_IF_MATCH:
+        case HTTP_HEADER_IF_NONE_MATCH:
+        case HTTP_HEADER_IF_RANGE: {
+            char    *word;
+
+            if ((tok = strchr(value, ';')) != 0) {
+                *tok = '\0';
+            }
+            rx->ifMatch = (field->id != HTTP_HEADER_IF_NONE_MATCH);
+            rx->flags |= HTTP_IF_MODIFIED;
+            value = sclone(value);
+            word = stok(value, " ,", &tok);
+            while (word) {
+                addMatchEtag(stream, word);
+                word = stok(0, " ,", &tok);
             }
             break;
+        }
 
-        case 'k':
+        case HTTP_HEADER_KEEP_ALIVE:
             /* Keep-Alive: timeout=N, max=1 */
-            if (strcasecmp(key, "keep-alive") == 0) {
-                if ((tok = scontains(value, "max=")) != 0) {
-                    stream->keepAliveCount = atoi(&tok[4]);
-                    if (stream->keepAliveCount < 0) {
-                        stream->keepAliveCount = 0;
-                    }
-                    if (stream->keepAliveCount > ME_MAX_KEEP_ALIVE) {
-                        stream->keepAliveCount = ME_MAX_KEEP_ALIVE;
-                    }
-                    /*
-                        IMPORTANT: Deliberately close client connections one request early. This encourages a client-led
-                        termination and may help relieve excessive server-side TIME_WAIT conditions.
-                     */
-                    if (httpClientStream(stream) && stream->keepAliveCount == 1) {
-                        stream->keepAliveCount = 0;
-                    }
+            if ((tok = scontains(value, "max=")) != 0) {
+                stream->keepAliveCount = atoi(&tok[4]);
+                if (stream->keepAliveCount < 0) {
+                    stream->keepAliveCount = 0;
+                }
+                if (stream->keepAliveCount > ME_MAX_KEEP_ALIVE) {
+                    stream->keepAliveCount = ME_MAX_KEEP_ALIVE;
+                }
+                /*
+                    IMPORTANT: Deliberately close client connections one request early. This encourages a client-led
+                    termination and may help relieve excessive server-side TIME_WAIT conditions.
+                 */
+                if (httpClientStream(stream) && stream->keepAliveCount == 1) {
+                    stream->keepAliveCount = 0;
                 }
             }
             break;
 
-        case 'l':
-            if (strcasecmp(key, "location") == 0) {
-                rx->redirect = sclone(value);
-            }
+        case HTTP_HEADER_LOCATION:
+            rx->redirect = sclone(value);
             break;
 
-        case 'o':
-            if (strcasecmp(key, "origin") == 0) {
-                rx->origin = sclone(value);
-            }
+        case HTTP_HEADER_ORIGIN:
+            rx->origin = sclone(value);
             break;
 
-        case 'p':
-            if (strcasecmp(key, "pragma") == 0) {
-                rx->pragma = sclone(value);
-            }
+        case HTTP_HEADER_PRAGMA:
+            rx->pragma = sclone(value);
             break;
 
-        case 'r':
-            if (strcasecmp(key, "range") == 0) {
-                /*
-                    The Content-Range header is used in the response. The Range header is used in the request.
-                 */
-                if (!parseRange(stream, value)) {
-                    httpBadRequestError(stream, HTTP_CLOSE | HTTP_CODE_RANGE_NOT_SATISFIABLE, "Bad range");
-                }
-            } else if (strcasecmp(key, "referer") == 0) {
-                /* NOTE: yes the header is misspelt in the spec */
-                rx->referrer = sclone(value);
+        case HTTP_HEADER_RANGE:
+            /*
+                The Content-Range header is used in the response. The Range header is used in the request.
+             */
+            if (!parseRange(stream, value)) {
+                httpBadRequestError(stream, HTTP_CLOSE | HTTP_CODE_RANGE_NOT_SATISFIABLE, "Bad range");
             }
             break;
 
-        case 't':
-#if DONE_IN_HTTP1
-            if (strcasecmp(key, "transfer-encoding") == 0 && stream->net->protocol == 1) {
-                if (scaselesscmp(value, "chunked") == 0) {
-                    /*
-                        remainingContent will be revised by the chunk filter as chunks are processed and will
-                        be set to zero when the last chunk has been received.
-                     */
-                    rx->flags |= HTTP_CHUNKED;
-                    rx->chunkState = HTTP_CHUNK_START;
-                    rx->remainingContent = HTTP_UNLIMITED;
-                    rx->needInputPipeline = 1;
-                }
+        case HTTP_HEADER_REFERER:
+            /* NOTE: yes the header is misspelt in the spec */
+            rx->referrer = sclone(value);
+            break;
+
+        case HTTP_HEADER_UPGRADE:
+            rx->upgrade = sclone(value);
+            break;
+
+        case HTTP_HEADER_USER_AGENT:
+            rx->userAgent = sclone(value);
+            break;
+
+        case HTTP_HEADER_WWW_AUTHENTICATE:
+            cp = value;
+            while (*value && !isspace((uchar) *value)) {
+                value++;
             }
-#endif
+            *value++ = '\0';
+            stream->authType = slower(cp);
+            rx->authDetails = sclone(value);
             break;
 
-        case 'x':
-            if (strcasecmp(key, "x-http-method-override") == 0) {
-                httpSetMethod(stream, value);
+        case HTTP_HEADER_X_HTTP_METHOD_OVERRIDE:
+            httpSetMethod(stream, value);
+            break;
 
-            } else if (strcasecmp(key, "x-own-params") == 0) {
+        case -1:
+            if (strcasecmp(key, "x-own-params") == 0) {
                 /*
                     Optimize and don't convert query and body content into params.
                     This is for those who want very large forms and to do their own custom handling.
@@ -446,26 +433,6 @@ static void processHeaders(HttpQueue *q)
 #endif
             }
             break;
-
-        case 'u':
-            if (scaselesscmp(key, "upgrade") == 0) {
-                rx->upgrade = sclone(value);
-            } else if (strcasecmp(key, "user-agent") == 0) {
-                rx->userAgent = sclone(value);
-            }
-            break;
-
-        case 'w':
-            if (strcasecmp(key, "www-authenticate") == 0) {
-                cp = value;
-                while (*value && !isspace((uchar) *value)) {
-                    value++;
-                }
-                *value++ = '\0';
-                stream->authType = slower(cp);
-                rx->authDetails = sclone(value);
-            }
-            break;
         }
     }
     if (net->protocol == 0 && !keepAliveHeader) {
@@ -772,6 +739,10 @@ static void prepErrorDoc(HttpQueue *q)
     stream->rx = httpCreateRx(stream);
     stream->tx = httpCreateTx(stream, NULL);
 
+    stream->rx->fields = rx->fields;
+    stream->rx->fieldCount = rx->fieldCount;
+    stream->rx->fieldMax = rx->fieldMax;
+    memcpy(stream->rx->known, rx->known, sizeof(rx->known));
     stream->rx->headers = rx->headers;
     stream->rx->method = rx->method;
     stream->rx->originalMethod = rx->originalMethod;
@@ -865,13 +836,15 @@ static void addMatchEtag(HttpStream *stream, char *etag)
         Range: bytes=-50              Last 50 bytes
         Range: bytes=1-               Skip first byte then emit the rest
 
+    Ranges may overlap and be in any order. The rangeFilter sorts and coalesces them once the entity length is known.
     Return 1 if more ranges, 0 if end of ranges, -1 if bad range.
  */
 static bool parseRange(HttpStream *stream, char *value)
 {
     HttpTx      *tx;
-    HttpRange   *range, *last, *next;
+    HttpRange   *range, *last;
     char        *tok, *ep;
+    int         count;
 
     tx = stream->tx;
     value = sclone(value);
@@ -881,7 +854,10 @@ static bool parseRange(HttpStream *stream, char *value)
      */
     stok(value, "=", &value);
 
-    for (last = 0; value && *value; ) {
+    for (last = 0, count = 0; value && *value; ) {
+        if (++count > stream->limits->rangesMax) {
+            return 0;
+        }
         if ((range = httpCreateRange(stream, 0, 0)) == 0) {
             return 0;
         }
@@ -927,19 +903,6 @@ static bool parseRange(HttpStream *stream, char *value)
         if (range->start < 0 && range->end < 0) {
             return 0;
         }
-        next = range->next;
-        if (range->start < 0 && next) {
-            /* This range goes to the end, so cannot have another range afterwards */
-            return 0;
-        }
-        if (next) {
-            if (range->end < 0) {
-                return 0;
-            }
-            if (next->start >= 0 && range->end > next->start) {
-                return 0;
-            }
-        }
     }
     stream->tx->currentRange = tx->outputRanges;
     return (last) ? 1: 0;
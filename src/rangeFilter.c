@@ -3,6 +3,9 @@
 
     This is an output only filter to select a subet range of data to transfer to the client.
 
+    Ranges are sorted and overlapping or adjacent ranges are coalesced before any data is sent. Entity (file) packets
+    are passed through by the handler so only the selected byte ranges are read from the file.
+
     Copyright (c) All Rights Reserved. See details at the end of the file.
  */
 
@@ -21,9 +24,11 @@ static void createRangeBoundary(HttpStream *stream);
 static HttpPacket *createRangePacket(HttpStream *stream, HttpRange *range);
 static HttpPacket *createFinalRangePacket(HttpStream *stream);
 static void manageRange(HttpRange *range, int flags);
+static void mergeRanges(HttpTx *tx);
 static void outgoingRangeService(HttpQueue *q);
 static bool fixRangeLength(HttpStream *stream, HttpQueue *q);
 static int matchRange(HttpStream *stream, HttpRoute *route, int dir);
+static HttpPacket *readEntity(HttpQueue *q, HttpPacket *packet, MprOff count);
 static void startRange(HttpQueue *q);
 
 /*********************************** Code *************************************/
@@ -128,7 +133,16 @@ static void outgoingRangeService(HttpQueue *q)
     }
     for (packet = httpGetPacket(q); packet; packet = httpGetPacket(q)) {
         if (packet->flags & HTTP_PACKET_DATA) {
-            if ((packet = selectBytes(q, packet)) == 0) {
+            if (!tx->outputRanges && packet->fill) {
+                /* Ranges could not be applied, so read the entire entity */
+                packet = readEntity(q, packet, packet->esize);
+            } else {
+                packet = selectBytes(q, packet);
+            }
+            if (packet == 0) {
+                if (stream->error) {
+                    return;
+                }
                 continue;
             }
         } else if (packet->flags & HTTP_PACKET_END) {
@@ -162,14 +176,15 @@ static HttpPacket *selectBytes(HttpQueue *q, HttpPacket *packet)
 
     /*
         Process the data packet over multiple ranges ranges until all the data is processed or discarded.
+        Entity packets are trimmed without reading the file, and only the selected bytes are read.
      */
     while (range && packet) {
-        length = httpGetPacketLength(packet);
+        length = packet->fill ? packet->esize : httpGetPacketLength(packet);
         if (length <= 0) {
             return 0;
         }
         endPacket = tx->rangePos + length;
-        if (endPacket < range->start) {
+        if (endPacket <= range->start) {
             /* Packet is before the next range, so discard the entire packet and seek forwards */
             tx->rangePos += length;
             return 0;
@@ -193,11 +208,15 @@ static HttpPacket *selectBytes(HttpQueue *q, HttpPacket *packet)
             span = max(span, 0);
             count = (ssize) min(span, q->nextQ->packetSize);
             assert(count > 0);
-            if (length > count) {
+            if (packet->fill) {
+                if ((packet = readEntity(q, packet, count)) == 0) {
+                    return 0;
+                }
+            } else if (length > count) {
                 /* Split packet if packet extends past range */
                 httpPutBackPacket(q, httpSplitPacket(packet, count));
             }
-            if (tx->rangeBoundary) {
+            if (tx->rangeBoundary && tx->rangePos == range->start) {
                 httpPutPacketToNext(q, createRangePacket(stream, range));
             }
             tx->rangePos += count;
@@ -211,6 +230,26 @@ static HttpPacket *selectBytes(HttpQueue *q, HttpPacket *packet)
 }
 
 
+/*
+    Read up to count bytes from the start of an entity packet. The remainder of the entity is put back on the queue.
+ */
+static HttpPacket *readEntity(HttpQueue *q, HttpPacket *packet, MprOff count)
+{
+    HttpPacket  *data;
+    ssize       size;
+
+    size = (ssize) min(count, q->nextQ->packetSize);
+    if (packet->esize > size) {
+        httpPutBackPacket(q, httpSplitPacket(packet, size));
+    }
+    data = httpCreateDataPacket(size);
+    if (packet->fill(q, data, packet->epos, size) < 0) {
+        return 0;
+    }
+    return data;
+}
+
+
 /*
     Create a range boundary packet
  */
@@ -327,10 +366,47 @@ static bool fixRangeLength(HttpStream *stream, HttpQueue *q)
         }
         range->len = (int) (range->end - range->start);
     }
+    mergeRanges(tx);
+    if (tx->outputRanges == 0) {
+        return 0;
+    }
+    if (tx->outputRanges->next == 0) {
+        /* Coalesced into a single range, so a multipart response is not required */
+        tx->rangeBoundary = 0;
+    }
     return 1;
 }
 
 
+/*
+    Sort ranges by starting position, then coalesce overlapping and adjacent ranges and remove empty ranges.
+    The number of ranges is bounded by limits->rangesMax, so an insertion sort is sufficient.
+ */
+static void mergeRanges(HttpTx *tx)
+{
+    HttpRange   *range, *next, *sorted, **prev;
+
+    sorted = 0;
+    for (range = tx->outputRanges; range; range = next) {
+        next = range->next;
+        if (range->start >= range->end) {
+            continue;
+        }
+        for (prev = &sorted; *prev && (*prev)->start <= range->start; prev = &(*prev)->next) ;
+        range->next = *prev;
+        *prev = range;
+    }
+    for (range = sorted; range; range = range->next) {
+        while ((next = range->next) != 0 && next->start <= range->end) {
+            range->end = max(range->end, next->end);
+            range->next = next->next;
+        }
+        range->len = range->end - range->start;
+    }
+    tx->outputRanges = tx->currentRange = sorted;
+}
+
+
 /*
     Copyright (c) Embedthis Software. All Rights Reserved.
     This software is distributed under commercial and open source licenses.
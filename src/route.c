@@ -25,30 +25,235 @@
         route->field = mprCloneHash(route->parent->field); \
     }
 
+/*
+    Route index limits. Path segments beyond these limits are not indexed. If a request walks more than
+    ROUTE_INDEX_NODES nodes, all routes are tested.
+ */
+#define ROUTE_INDEX_DEPTH       16          /* Maximum indexed path segments */
+#define ROUTE_INDEX_SEGMENT     64          /* Maximum indexed path segment length */
+#define ROUTE_INDEX_NODES       32          /* Maximum nodes visited for a request */
+#define ROUTE_INDEX_WILD        "*"         /* Index key segment for a "{token}" that matches any one segment */
+#define ROUTE_COMBINE_MAX       64          /* Maximum route patterns in one combined matcher */
+#define ROUTE_COMBINE_CAPTURES  256         /* Maximum capture groups in one combined matcher */
+#define ROUTE_CALLOUT           255         /* Callout number marking the end of a combined matcher alternative */
+
+#define ROUTE_CACHE_WAYS        4           /* Route cache set associativity */
+#define ROUTE_CACHE_PATH        256         /* Maximum pathInfo length to cache */
+
+#define ROUTE_METHOD_OTHER      0x80        /* Method mask bit for methods without an rx method flag */
+#define ROUTE_METHOD_ALL        0xFF        /* Method mask for routes accepting all methods */
+
+#define ROUTE_TEMPLATE_MATCHES  0x1         /* Template has pattern match tokens: $N, $&, $`, $' and $$ */
+#define ROUTE_TEMPLATE_PIECES   32          /* Template ops evaluated without allocating */
+
+/*
+    Compiled template op types
+ */
+#define TPL_LITERAL             0           /* Literal text */
+#define TPL_MATCH               1           /* Pattern submatch $N. $& is submatch zero. */
+#define TPL_BEFORE              2           /* Text preceding the pattern match: $` */
+#define TPL_AFTER               3           /* Text following the pattern match: $' */
+#define TPL_HEADER              4           /* ${header:name=default} */
+#define TPL_PARAM               5           /* ${param:name=default} */
+#define TPL_REQUEST             6           /* ${request:var=default} */
+#define TPL_SSL                 7           /* ${ssl:var} */
+
+/*
+    Request variables for ${request:var}. Indexes into templateRequestVars.
+ */
+#define TPL_REQ_AUTHENTICATED   0
+#define TPL_REQ_CLIENT_ADDRESS  1
+#define TPL_REQ_CLIENT_PORT     2
+#define TPL_REQ_ERROR           3
+#define TPL_REQ_EXT             4
+#define TPL_REQ_EXTRA_PATH      5
+#define TPL_REQ_FILENAME        6
+#define TPL_REQ_LANGUAGE        7
+#define TPL_REQ_LANGUAGE_DIR    8
+#define TPL_REQ_HOST            9
+#define TPL_REQ_METHOD          10
+#define TPL_REQ_ORIGIN          11
+#define TPL_REQ_ORIGINAL_URI    12
+#define TPL_REQ_PATH_INFO       13
+#define TPL_REQ_PREFIX          14
+#define TPL_REQ_QUERY           15
+#define TPL_REQ_REFERENCE       16
+#define TPL_REQ_SCHEME          17
+#define TPL_REQ_SCRIPT_NAME     18
+#define TPL_REQ_SERVER_ADDRESS  19
+#define TPL_REQ_SERVER_PORT     20
+#define TPL_REQ_URI             21
+
+static cchar *templateRequestVars[] = {
+    "authenticated", "clientAddress", "clientPort", "error", "ext", "extraPath", "filename", "language",
+    "languageDir", "host", "method", "origin", "originalUri", "pathInfo", "prefix", "query", "reference", "scheme",
+    "scriptName", "serverAddress", "serverPort", "uri", 0
+};
+
+/*
+    Trie node over literal path segments. The routes array holds the ascending indexes of routes whose literal
+    pattern prefix ends at this node.
+ */
+typedef struct HttpRouteNode {
+    MprHash         *children;              /* Child nodes keyed by path segment */
+    MprList         *matchers;              /* Combined pattern matchers for the routes. Null if not combined. */
+    struct HttpRouteNode *wild;             /* Child node for any path segment */
+    int             *routes;                /* Route indexes in host->routes order */
+    int             count;                  /* Number of routes */
+    int             size;                   /* Size of routes */
+} HttpRouteNode;
+
+/*
+    Combined matcher for a run of node routes. The route patterns are compiled into one anchored pcre alternation.
+    A callout after each alternative identifies the matching route and rejects routes that are not eligible.
+ */
+typedef struct HttpRouteMatcher {
+    void            *compiled;              /* Compiled pcre pattern (not alloced). Null if compilation failed. */
+    int             *offsets;               /* Pattern offset after the callout for each alternative */
+    int             *groups;                /* Number of the first capture group of each alternative */
+    int             *captures;              /* Number of capture groups in each alternative. -1 if not combined. */
+    int             captureCount;           /* Total capture groups */
+    int             first;                  /* Position in node->routes of the first alternative */
+    int             count;                  /* Number of alternatives */
+} HttpRouteMatcher;
+
+/*
+    Cached route selection for a request method and pathInfo. Entries are immutable once published except lastUsed.
+ */
+typedef struct RouteCacheEntry {
+    char            *method;
+    char            *path;
+    HttpRoute       *route;
+    int             matches[ME_MAX_ROUTE_MATCHES * 2];
+    int             matchCount;
+    uint            hash;
+    int             lastUsed;               /* index->cacheClock when last used */
+} RouteCacheEntry;
+
+/*
+    Compiled route index for a host
+ */
+typedef struct HttpRouteIndex {
+    RouteCacheEntry **cache;                /* Set associative route cache. Read without locking. */
+    int             cacheSets;              /* Number of cache sets */
+    int             cacheClock;             /* Cache use counter for LRU replacement */
+    MprList         *routes;                /* Host route list indexed */
+    HttpRouteNode   *all;                   /* Node holding all routes */
+    HttpRouteNode   *root;                  /* Trie root. Holds routes without a literal leading segment */
+    int             *methods;               /* Method mask for each route */
+    int             length;                 /* Number of routes indexed */
+    int             version;                /* HTTP->routeVersion when built */
+} HttpRouteIndex;
+
+/*
+    State to walk the index nodes for a request
+ */
+typedef struct RouteWalk {
+    HttpRouteIndex  *index;
+    HttpRouteNode   *nodes[ROUTE_INDEX_NODES];
+    int             cursors[ROUTE_INDEX_NODES];     /* Position of the next candidate in each node */
+    int             matched[ROUTE_INDEX_NODES];     /* Cursor position found by a combined matcher or -1 */
+    int             matches[ME_MAX_ROUTE_MATCHES * 2];  /* Captures for the prematched route */
+    int             matchCount;
+    int             prematched;                     /* Route index with captures from a combined matcher or -1 */
+    cchar           *path;
+    int             count;                          /* Number of nodes */
+    int             method;                         /* Request method mask */
+} RouteWalk;
+
+/*
+    Callout data for a combined matcher
+ */
+typedef struct RouteCallout {
+    HttpRouteIndex      *index;
+    HttpRouteNode       *node;
+    HttpRouteMatcher    *matcher;
+    int                 start;                      /* First eligible position in node->routes */
+    int                 method;                     /* Request method mask */
+    int                 found;                      /* Position of the matching route */
+} RouteCallout;
+
+/*
+    Compiled template op
+ */
+typedef struct RouteTemplateOp {
+    cchar           *str;                   /* Literal text or token name */
+    cchar           *defaultValue;          /* Token default value */
+    ssize           len;                    /* Literal text length */
+    int             type;                   /* Op type: TPL_* */
+    int             index;                  /* Submatch or request variable index */
+} RouteTemplateOp;
+
+/*
+    Route target, condition and update strings compiled into a list of literal text and token ops
+ */
+typedef struct HttpRouteTemplate {
+    cchar           *source;                /* Compiled string */
+    RouteTemplateOp *ops;
+    int             count;
+} HttpRouteTemplate;
+
+/*
+    The pcre callout hook is process wide. It is only installed while combined matchers run and the prior hook is
+    restored when none are running. Other callouts made in the meantime are passed to the prior hook.
+ */
+static MprSpin      calloutLock;
+static int          calloutLockInit;
+static int          calloutUsers;
+static int          (*priorCallout)(pcre_callout_block *cb);
+
 /********************************** Forwards **********************************/
 
+static void addRouteToNode(HttpRouteNode *node, int routeIndex);
+static void addTemplateLiteral(HttpRouteTemplate *tp, cchar *str, ssize len);
 static void addUniqueItem(MprList *list, HttpRouteOp *op);
+static HttpRouteIndex *buildRouteIndex(HttpHost *host);
+static bool canCacheRoute(HttpRoute *route);
+static bool canCombineRoute(HttpRoute *route);
 static int checkRoute(HttpStream *stream, HttpRoute *route);
+static void combineNodeRoutes(HttpRouteIndex *index, HttpRouteNode *node);
+static HttpRouteTemplate *compileTemplate(cchar *str, int flags);
+static bool compileTemplateToken(RouteTemplateOp *op, cchar *token, ssize len);
 static HttpLang *createLangDef(cchar *path, cchar *suffix, int flags);
+static char *getRouteIndexKey(HttpRoute *route);
+static cchar *getTemplateValue(HttpStream *stream, RouteTemplateOp *op, ssize *len);
+static int lookupRouteNodes(HttpRouteIndex *index, cchar *path, HttpRouteNode **nodes);
 static HttpRouteOp *createRouteOp(cchar *name, int flags);
 static void definePathVars(HttpRoute *route);
 static void defineHostVars(HttpRoute *route);
+static char *expandOpTokens(HttpStream *stream, HttpRouteOp *op, cchar *str);
+static char *expandRouteTarget(HttpStream *stream, HttpRoute *route);
+static char *expandTemplate(HttpStream *stream, HttpRouteTemplate *tp);
 static char *expandTokens(HttpStream *stream, cchar *path);
-static char *expandPatternTokens(cchar *str, cchar *replacement, int *matches, int matchCount);
-static char *expandRequestTokens(HttpStream *stream, char *targetKey);
 static void finalizePattern(HttpRoute *route);
 static char *finalizeReplacement(HttpRoute *route, cchar *str);
 static char *finalizeTemplate(HttpRoute *route);
 static bool opPresent(MprList *list, HttpRouteOp *op);
 static void manageRoute(HttpRoute *route, int flags);
 static void manageLang(HttpLang *lang, int flags);
+static void manageRouteCacheEntry(RouteCacheEntry *entry, int flags);
+static void manageRouteIndex(HttpRouteIndex *index, int flags);
+static void manageRouteMatcher(HttpRouteMatcher *matcher, int flags);
+static void manageRouteNode(HttpRouteNode *node, int flags);
 static void manageRouteOp(HttpRouteOp *op, int flags);
-static int matchRequestUri(HttpStream *stream, HttpRoute *route);
-static int matchRoute(HttpStream *stream, HttpRoute *route);
+static void manageRouteTemplate(HttpRouteTemplate *tp, int flags);
+static int matchRequestUri(HttpStream *stream, HttpRoute *route, bool prematched);
+static int matchRoute(HttpStream *stream, HttpRoute *route, bool prematched);
+static int nextRouteCandidate(RouteWalk *walk);
+static int resolveCombinedRoute(RouteWalk *walk, int i);
+static void setCombinedMatches(RouteWalk *walk, HttpRouteNode *node, HttpRouteMatcher *matcher, int alt, int *ovector);
+static int routeCallout(pcre_callout_block *cb);
+static void startRouteCallout(void);
+static void stopRouteCallout(void);
+static int routeMethodMask(HttpRoute *route);
+static int runRouteTarget(HttpStream *stream, HttpRoute *route);
+static void saveRouteCache(HttpStream *stream, HttpRouteIndex *index, HttpRoute *route, cchar *path);
+static bool routeSegmentEnds(cchar *cp);
 static int selectHandler(HttpStream *stream, HttpRoute *route);
 static int testCondition(HttpStream *stream, HttpRoute *route, HttpRouteOp *condition);
 static char *trimQuotes(char *str);
 static int updateRequest(HttpStream *stream, HttpRoute *route, HttpRouteOp *update);
+static int useRouteCache(HttpStream *stream, HttpRouteIndex *index);
 
 /************************************ Code ************************************/
 /*
@@ -162,6 +367,10 @@ PUBLIC HttpRoute *httpCreateInheritedRoute(HttpRoute *parent)
     route->languages = parent->languages;
     route->lifespan = parent->lifespan;
     route->limits = parent->limits;
+    route->rate = parent->rate;
+    route->literalExact = parent->literalExact;
+    route->literalPattern = parent->literalPattern;
+    route->literalPatternLen = parent->literalPatternLen;
     route->map = parent->map;
     route->methods = parent->methods;
     route->mimeTypes = parent->mimeTypes;
@@ -183,6 +392,7 @@ PUBLIC HttpRoute *httpCreateInheritedRoute(HttpRoute *parent)
     route->sourceName = parent->sourceName;
     route->ssl = parent->ssl;
     route->target = parent->target;
+    route->targetTemplate = parent->targetTemplate;
     route->targetRule = parent->targetRule;
     route->tokens = parent->tokens;
     route->trace = parent->trace;
@@ -195,6 +405,9 @@ PUBLIC HttpRoute *httpCreateInheritedRoute(HttpRoute *parent)
 
 static void manageRoute(HttpRoute *route, int flags)
 {
+    HttpHeaderPrefix    **prefixes;
+    int                 i;
+
     if (flags & MPR_MANAGE_MARK) {
         mprMark(route->auth);
         mprMark(route->caching);
@@ -218,13 +431,21 @@ static void manageRoute(HttpRoute *route, int flags)
         mprMark(route->handler);
         mprMark(route->handlers);
         mprMark(route->headers);
+        if ((prefixes = route->headerPrefixes) != 0) {
+            for (i = 0; i < ME_MAX_HEADER_PREFIXES; i++) {
+                mprMark(prefixes[i]);
+            }
+            mprMark(prefixes);
+        }
         mprMark(route->home);
         mprMark(route->host);
         mprMark(route->http);
         mprMark(route->indexes);
         mprMark(route->inputStages);
         mprMark(route->languages);
+        mprMark(route->literalPattern);
         mprMark(route->limits);
+        mprMark(route->rate);
         mprMark(route->map);
         mprMark(route->methods);
         mprMark(route->mimeTypes);
@@ -245,6 +466,7 @@ static void manageRoute(HttpRoute *route, int flags)
         mprMark(route->startSegment);
         mprMark(route->startWith);
         mprMark(route->target);
+        mprMark(route->targetTemplate);
         mprMark(route->targetRule);
         mprMark(route->tokens);
         mprMark(route->trace);
@@ -361,44 +583,98 @@ PUBLIC void httpStopRoute(HttpRoute *route)
  */
 PUBLIC void httpRouteRequest(HttpStream *stream)
 {
-    HttpRx      *rx;
-    HttpTx      *tx;
-    HttpRoute   *route;
-    int         next, rewrites, match;
+    HttpRx          *rx;
+    HttpTx          *tx;
+    HttpHost        *host;
+    HttpRoute       *route;
+    HttpRouteIndex  *index;
+    RouteWalk       walk;
+    bool            conditional;
+    int             next, rewrites, match, method;
 
     rx = stream->rx;
     tx = stream->tx;
+    host = stream->host;
     route = 0;
     rewrites = 0;
+    match = HTTP_ROUTE_REJECT;
 
     if (stream->error) {
         tx->handler = stream->http->passHandler;
-        route = rx->route = stream->host->defaultRoute;
+        route = rx->route = host->defaultRoute;
 
     } else {
-        for (next = rewrites = 0; rewrites < ME_MAX_REWRITE; ) {
-            if (next >= stream->host->routes->length) {
-                break;
+        index = host->routeIndex;
+        if (!index || index->version != HTTP->routeVersion || index->routes != host->routes ||
+                index->length != host->routes->length) {
+            index = host->routeIndex = buildRouteIndex(host);
+        }
+        /*
+            The method flags may be unset (error documents) or stale (method overrides), so the mask is only a pre-test
+         */
+        method = (rx->flags & (HTTP_DELETE | HTTP_GET | HTTP_HEAD | HTTP_OPTIONS | HTTP_POST | HTTP_PUT | HTTP_TRACE));
+        method = method ? (method | ROUTE_METHOD_OTHER) : ROUTE_METHOD_ALL;
+        for (rewrites = 0; rewrites < ME_MAX_REWRITE; ) {
+            if (index->cache) {
+                if ((match = useRouteCache(stream, index)) == HTTP_ROUTE_OK) {
+                    route = rx->route;
+                    break;
+                } else if (match == HTTP_ROUTE_REROUTE) {
+                    route = 0;
+                    rewrites++;
+                    continue;
+                }
+            }
+            /*
+                Walk the index over the pathInfo segments. Candidates are visited in route order.
+             */
+            if ((walk.count = lookupRouteNodes(index, rx->pathInfo, walk.nodes)) < 0) {
+                walk.nodes[0] = index->all;
+                walk.count = 1;
             }
-            route = stream->host->routes->items[next++];
-            if (route->startSegment && strncmp(rx->pathInfo, route->startSegment, route->startSegmentLen) != 0) {
-                /* Failed to match the first URI segment, skip to the next group */
-                if (next < route->nextGroup) {
-                    next = route->nextGroup;
+            walk.index = index;
+            walk.path = rx->pathInfo;
+            walk.method = method;
+            walk.prematched = -1;
+            conditional = 0;
+            memset(walk.cursors, 0, walk.count * sizeof(int));
+            memset(walk.matched, -1, walk.count * sizeof(int));
+            while ((next = nextRouteCandidate(&walk)) >= 0) {
+                route = index->routes->items[next];
+                if (!(index->methods[next] & method)) {
+                    continue;
                 }
-
-            } else if (route->startWith && strncmp(rx->pathInfo, route->startWith, route->startWithLen) != 0) {
-                /* Failed to match starting literal segment of the route pattern, advance to test the next route */
-                continue;
-
-            } else if ((match = matchRoute(stream, route)) == HTTP_ROUTE_REROUTE) {
-                next = 0;
+                if (route->startWith && strncmp(rx->pathInfo, route->startWith, route->startWithLen) != 0) {
+                    /* Failed to match starting literal segment of the route pattern, advance to test the next route */
+                    continue;
+                }
+                if (next == walk.prematched) {
+                    /* Captures already determined by a combined matcher */
+                    memcpy(rx->matches, walk.matches, sizeof(rx->matches));
+                    rx->matchCount = walk.matchCount;
+                }
+                rx->route = 0;
+                if ((match = matchRoute(stream, route, next == walk.prematched)) == HTTP_ROUTE_OK ||
+                        match == HTTP_ROUTE_REROUTE) {
+                    break;
+                }
+                if (rx->route) {
+                    /* The route pattern matched but the route was rejected by a request dependent test */
+                    conditional = 1;
+                }
+            }
+            if (next < 0) {
                 route = 0;
-                rewrites++;
-
-            } else if (match == HTTP_ROUTE_OK) {
                 break;
             }
+            if (match == HTTP_ROUTE_OK) {
+                if (index->cache && !conditional) {
+                    saveRouteCache(stream, index, route, walk.path);
+                }
+                break;
+            }
+            route = 0;
+            rewrites++;
         }
     }
     if (route == 0 || tx->handler == 0) {
@@ -409,6 +685,11 @@ PUBLIC void httpRouteRequest(HttpStream *stream)
     rx->route = route;
     stream->limits = route->limits;
     stream->trace = route->trace;
+    httpUpdateDeadline(stream);
+
+    if ((route->rate || stream->http->requestRate) && !stream->error) {
+        httpCheckRequestRate(stream);
+    }
 
     if (rewrites >= ME_MAX_REWRITE) {
         httpError(stream, HTTP_CODE_INTERNAL_SERVER_ERROR, "Too many request rewrites");
@@ -423,7 +704,7 @@ PUBLIC void httpRouteRequest(HttpStream *stream)
 }
 
 
-static int matchRoute(HttpStream *stream, HttpRoute *route)
+static int matchRoute(HttpStream *stream, HttpRoute *route, bool prematched)
 {
     HttpRx      *rx;
     cchar       *savePathInfo, *pathInfo;
@@ -445,75 +726,776 @@ static int matchRoute(HttpStream *stream, HttpRoute *route)
         if (*pathInfo == '\0') {
             pathInfo = "/";
         }
-        rx->pathInfo = sclone(pathInfo);
-        rx->scriptName = route->prefix;
+        rx->pathInfo = sclone(pathInfo);
+        rx->scriptName = route->prefix;
+    }
+    if ((rc = matchRequestUri(stream, route, prematched)) == HTTP_ROUTE_OK) {
+        rc = checkRoute(stream, route);
+    }
+    if (rc == HTTP_ROUTE_REJECT && savePathInfo) {
+        /* Keep the modified pathInfo if OK or REWRITE */
+        rx->pathInfo = savePathInfo;
+        rx->scriptName = 0;
+    }
+    return rc;
+}
+
+
+static int matchRequestUri(HttpStream *stream, HttpRoute *route, bool prematched)
+{
+    HttpRx      *rx;
+
+    assert(stream);
+    assert(route);
+    rx = stream->rx;
+
+    if (prematched) {
+        /* rx->matches set by a combined matcher */
+        ;
+    } else if (route->literalPattern) {
+        /* Pattern has no regular expression characters, so a string comparison suffices */
+        rx->matchCount = -1;
+        if (strncmp(rx->pathInfo, route->literalPattern, route->literalPatternLen) == 0 &&
+                (!route->literalExact || rx->pathInfo[route->literalPatternLen] == '\0')) {
+            rx->matchCount = 1;
+            rx->matches[0] = 0;
+            rx->matches[1] = (int) route->literalPatternLen;
+        }
+    } else if (route->patternCompiled) {
+        rx->matchCount = pcre_exec(route->patternCompiled, NULL, rx->pathInfo, (int) slen(rx->pathInfo), 0, 0,
+            rx->matches, sizeof(rx->matches) / sizeof(int));
+    }
+    if (route->literalPattern || route->patternCompiled) {
+        if (route->flags & HTTP_ROUTE_NOT) {
+            if (rx->matchCount > 0) {
+                return HTTP_ROUTE_REJECT;
+            }
+            rx->matchCount = 1;
+            rx->matches[0] = 0;
+            rx->matches[1] = (int) slen(rx->pathInfo);
+
+        } else if (rx->matchCount <= 0) {
+            return HTTP_ROUTE_REJECT;
+        }
+    } else if (route->pattern && *route->pattern) {
+        /* Pattern compilation failed */
+        return HTTP_ROUTE_REJECT;
+    }
+    if (!mprLookupKey(route->methods, rx->method)) {
+        if (!mprLookupKey(route->methods, "*")) {
+            if (!(rx->flags & HTTP_HEAD && mprLookupKey(route->methods, "GET"))) {
+                return HTTP_ROUTE_REJECT;
+            }
+        }
+    }
+    rx->route = route;
+    return HTTP_ROUTE_OK;
+}
+
+
+/*
+    Build the route index for a host. The index is a trie over the literal leading path segments of each route.
+    Each route is added to the node for its last complete literal segment so that a request only tests the routes
+    along the trie walk of its path. The index is rebuilt when the host routes change.
+ */
+static HttpRouteIndex *buildRouteIndex(HttpHost *host)
+{
+    HttpRouteIndex  *index;
+    HttpRouteNode   *node, *child;
+    HttpRoute       *route;
+    cchar           *cp, *ep;
+    char            *key, *segment;
+    int             next, depth;
+
+    if ((index = mprAllocObj(HttpRouteIndex, manageRouteIndex)) == 0) {
+        return 0;
+    }
+    index->routes = host->routes;
+    index->length = mprGetListLength(host->routes);
+    index->version = HTTP->routeVersion;
+    index->methods = mprAlloc(max(index->length, 1) * sizeof(int));
+    index->root = mprAllocObj(HttpRouteNode, manageRouteNode);
+    index->all = mprAllocObj(HttpRouteNode, manageRouteNode);
+    if (ME_MAX_ROUTE_CACHE >= ROUTE_CACHE_WAYS) {
+        index->cacheSets = ME_MAX_ROUTE_CACHE / ROUTE_CACHE_WAYS;
+        index->cache = mprAllocZeroed(index->cacheSets * ROUTE_CACHE_WAYS * sizeof(RouteCacheEntry*));
+    }
+
+    for (ITERATE_ITEMS(host->routes, route, next)) {
+        index->methods[next - 1] = routeMethodMask(route);
+        node = index->root;
+        if ((key = getRouteIndexKey(route)) != 0 && *key == '/') {
+            for (cp = &key[1], depth = 0; depth < ROUTE_INDEX_DEPTH && (ep = strchr(cp, '/')) != 0; cp = ep + 1, depth++) {
+                if ((ep - cp) > ROUTE_INDEX_SEGMENT) {
+                    break;
+                }
+                segment = snclone(cp, ep - cp);
+                if (smatch(segment, ROUTE_INDEX_WILD)) {
+                    if (!node->wild) {
+                        node->wild = mprAllocObj(HttpRouteNode, manageRouteNode);
+                    }
+                    child = node->wild;
+                } else {
+                    if (!node->children) {
+                        node->children = mprCreateHash(0, 0);
+                    }
+                    if ((child = mprLookupKey(node->children, segment)) == 0) {
+                        child = mprAllocObj(HttpRouteNode, manageRouteNode);
+                        mprAddKey(node->children, segment, child);
+                    }
+                }
+                node = child;
+            }
+        }
+        addRouteToNode(node, next - 1);
+        addRouteToNode(index->all, next - 1);
+    }
+    if (host->flags & HTTP_HOST_COMBINE_ROUTES) {
+        combineNodeRoutes(index, index->root);
+        combineNodeRoutes(index, index->all);
+    }
+    return index;
+}
+
+
+/*
+    Test if a route pattern can be embedded in a combined matcher. The pattern must be self-contained.
+ */
+static bool canCombineRoute(HttpRoute *route)
+{
+    cchar   *cp;
+    int     captures;
+
+    if (!route->optimizedPattern || !route->patternCompiled || (route->flags & HTTP_ROUTE_NOT) ||
+            (route->prefix && *route->prefix)) {
+        return 0;
+    }
+    if (pcre_fullinfo(route->patternCompiled, NULL, PCRE_INFO_CAPTURECOUNT, &captures) < 0 ||
+            (captures + 1) * 3 > ME_MAX_ROUTE_MATCHES * 2) {
+        /* Too many captures for rx->matches */
+        return 0;
+    }
+    for (cp = route->optimizedPattern; *cp; cp++) {
+        if (*cp == '\\' && cp[1]) {
+            /* Back references are renumbered in a combined pattern */
+            if (isdigit((uchar) cp[1]) || cp[1] == 'g' || cp[1] == 'k') {
+                return 0;
+            }
+            cp++;
+        } else if (*cp == '(' && cp[1] == '?' && schr("P<'C", cp[2])) {
+            /* Named groups may be duplicated and callouts are reserved */
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+    Compile the route patterns of a node and its children into combined matchers. Routes whose patterns cannot be
+    combined (negated, prefixed or using back references or named groups) are represented by an empty alternative
+    so they are always returned as candidates for matchRoute to test.
+ */
+static void combineNodeRoutes(HttpRouteIndex *index, HttpRouteNode *node)
+{
+    HttpRouteMatcher    *matcher;
+    HttpRoute           *route;
+    MprBuf              *buf;
+    MprKey              *kp;
+    cchar               *errMsg, *pattern;
+    int                 column, first, i;
+
+    if (node->children) {
+        for (ITERATE_KEYS(node->children, kp)) {
+            combineNodeRoutes(index, (HttpRouteNode*) kp->data);
+        }
+    }
+    if (node->wild) {
+        combineNodeRoutes(index, node->wild);
+    }
+    if (node->count < 2) {
+        return;
+    }
+    if (!calloutLockInit) {
+        mprGlobalLock();
+        if (!calloutLockInit) {
+            mprInitSpinLock(&calloutLock);
+            calloutLockInit = 1;
+        }
+        mprGlobalUnlock();
+    }
+    node->matchers = mprCreateList(0, 0);
+    for (first = 0; first < node->count; first += ROUTE_COMBINE_MAX) {
+        matcher = mprAllocObj(HttpRouteMatcher, manageRouteMatcher);
+        matcher->first = first;
+        matcher->count = min(node->count - first, ROUTE_COMBINE_MAX);
+        matcher->offsets = mprAlloc(matcher->count * sizeof(int));
+        matcher->groups = mprAlloc(matcher->count * sizeof(int));
+        matcher->captures = mprAlloc(matcher->count * sizeof(int));
+        buf = mprCreateBuf(0, 0);
+        mprPutStringToBuf(buf, "(?:");
+        for (i = 0; i < matcher->count; i++) {
+            route = index->routes->items[node->routes[first + i]];
+            matcher->groups[i] = matcher->captureCount + 1;
+            if (canCombineRoute(route)) {
+                pattern = route->optimizedPattern;
+                pcre_fullinfo(route->patternCompiled, NULL, PCRE_INFO_CAPTURECOUNT, &matcher->captures[i]);
+                matcher->captureCount += matcher->captures[i];
+            } else {
+                pattern = "";
+                matcher->captures[i] = -1;
+            }
+            mprPutToBuf(buf, "%s(?:%s)(?C%d)", i ? "|" : "", pattern, ROUTE_CALLOUT);
+            matcher->offsets[i] = (int) mprGetBufLength(buf);
+        }
+        mprPutCharToBuf(buf, ')');
+        mprAddNullToBuf(buf);
+        if ((matcher->compiled = pcre_compile2(mprGetBufStart(buf), PCRE_ANCHORED, 0, &errMsg, &column, NULL)) == 0) {
+            mprLog("error http route", 4, "Cannot combine route patterns. Error %s at column %d", errMsg, column);
+        }
+        mprAddItem(node->matchers, matcher);
+    }
+}
+
+
+static void addRouteToNode(HttpRouteNode *node, int routeIndex)
+{
+    if (node->count >= node->size) {
+        node->size = max(node->size * 2, 8);
+        node->routes = mprRealloc(node->routes, node->size * sizeof(int));
+    }
+    node->routes[node->count++] = routeIndex;
+}
+
+
+/*
+    Get the literal path that any request matching the route must start with. The key includes a trailing "/" if
+    the last literal segment must be complete. Tokens with literal values, such as "{controller=user}", are literal.
+ */
+static char *getRouteIndexKey(HttpRoute *route)
+{
+    MprBuf      *buf;
+    cchar       *cp, *ep, *start;
+
+    if (route->flags & HTTP_ROUTE_NOT) {
+        /* Negated patterns can match any path */
+        return route->startWith;
+    }
+    if (route->prefix && *route->prefix) {
+        return route->prefix;
+    }
+    if (!route->optimizedPattern || route->optimizedPattern[0] != '^') {
+        return 0;
+    }
+    buf = mprCreateBuf(0, 0);
+    for (cp = &route->optimizedPattern[1]; *cp; ) {
+        if (sncmp(cp, "([^/]*)", 7) == 0 && mprLookAtLastCharInBuf(buf) == '/' &&
+                (cp[7] == '\0' || routeSegmentEnds(&cp[7]))) {
+            /* Token matching any one segment. Whatever follows the token must start a new segment. */
+            mprPutStringToBuf(buf, ROUTE_INDEX_WILD);
+            cp += 7;
+
+        } else if (*cp == '(') {
+            /* Capture group with only literal content and no quantifier */
+            start = &cp[1];
+            if (start[0] == '?' && start[1] == ':') {
+                start += 2;
+            }
+            ep = &start[strcspn(start, "^$*+?.()|{}[]\\")];
+            if (*ep != ')' || (ep[1] && schr("*+?{", ep[1]))) {
+                break;
+            }
+            mprPutBlockToBuf(buf, start, ep - start);
+            cp = ep + 1;
+
+        } else if (*cp == '\\' && cp[1] && !isalnum((uchar) cp[1]) && !schr("*+?{", cp[2])) {
+            mprPutCharToBuf(buf, cp[1]);
+            cp += 2;
+
+        } else if (schr("^$*+?.()|{}[]\\", *cp) || (cp[1] && schr("*+?{", cp[1]))) {
+            break;
+
+        } else {
+            mprPutCharToBuf(buf, *cp++);
+        }
+    }
+    if (mprLookAtLastCharInBuf(buf) != '/' && routeSegmentEnds(cp)) {
+        /* The rest of the pattern can only match the end of the path or a new segment */
+        mprPutCharToBuf(buf, '/');
+    }
+    mprAddNullToBuf(buf);
+    return mprGetBufStart(buf);
+}
+
+
+/*
+    Test if a pattern fragment can only match the end of the path or a string starting with "/". An empty fragment
+    of an unanchored pattern matches anything, so "^/foo" must not be indexed as the complete segment "/foo/".
+ */
+static bool routeSegmentEnds(cchar *cp)
+{
+    cchar   *ep;
+    int     level;
+
+    if (*cp == '$' || *cp == '/') {
+        return 1;
+    }
+    if (*cp != '(') {
+        return 0;
+    }
+    ep = &cp[1];
+    if (ep[0] == '?' && ep[1] == ':') {
+        ep += 2;
+    }
+    if (*ep != '/') {
+        return 0;
+    }
+    for (level = 1; *ep && level > 0; ep++) {
+        if (*ep == '\\' && ep[1]) {
+            ep++;
+        } else if (*ep == '(') {
+            level++;
+        } else if (*ep == ')') {
+            level--;
+        }
+    }
+    if (level > 0) {
+        return 0;
+    }
+    if (*ep == '*' || *ep == '?') {
+        /* Optional group, so test what follows */
+        return routeSegmentEnds(&ep[1]);
+    }
+    if (*ep == '{') {
+        /* Counted repetition may be zero */
+        return 0;
+    }
+    return 1;
+}
+
+
+/*
+    Find the index nodes along the walks of a request path. A segment may match both a literal and a wildcard child,
+    so several nodes may be visited at each level. Returns the number of nodes or -1 if there are too many nodes.
+ */
+static int lookupRouteNodes(HttpRouteIndex *index, cchar *path, HttpRouteNode **nodes)
+{
+    HttpRouteNode   *node, *child;
+    cchar           *cp, *ep;
+    char            segment[ROUTE_INDEX_SEGMENT + 1];
+    ssize           len;
+    int             count, first, last, i;
+
+    count = 0;
+    nodes[count++] = index->root;
+    if (!path || *path != '/') {
+        return count;
+    }
+    for (first = 0, cp = &path[1]; ; first = last, cp = ep + 1) {
+        if ((ep = strchr(cp, '/')) == 0) {
+            /* Last segment. May be empty. */
+            ep = &cp[slen(cp)];
+        }
+        if ((len = ep - cp) <= ROUTE_INDEX_SEGMENT) {
+            memcpy(segment, cp, len);
+            segment[len] = '\0';
+        }
+        for (last = count, i = first; i < last; i++) {
+            node = nodes[i];
+            if (node->children && len <= ROUTE_INDEX_SEGMENT && (child = mprLookupKey(node->children, segment)) != 0) {
+                if (count >= ROUTE_INDEX_NODES) {
+                    return -1;
+                }
+                nodes[count++] = child;
+            }
+            if (node->wild) {
+                if (count >= ROUTE_INDEX_NODES) {
+                    return -1;
+                }
+                nodes[count++] = node->wild;
+            }
+        }
+        if (count == last || *ep == '\0') {
+            break;
+        }
+    }
+    return count;
+}
+
+
+/*
+    Return the next candidate route index by merging the ascending node route lists. Returns -1 when exhausted.
+ */
+static int nextRouteCandidate(RouteWalk *walk)
+{
+    HttpRouteNode   *node;
+    int             i, best, bestNode;
+
+    while (1) {
+        best = MAXINT;
+        bestNode = -1;
+        for (i = 0; i < walk->count; i++) {
+            node = walk->nodes[i];
+            if (walk->cursors[i] < node->count && node->routes[walk->cursors[i]] < best) {
+                best = node->routes[walk->cursors[i]];
+                bestNode = i;
+            }
+        }
+        if (bestNode < 0) {
+            return -1;
+        }
+        if (walk->nodes[bestNode]->matchers && walk->matched[bestNode] != walk->cursors[bestNode]) {
+            /*
+                Only resolve a combined matcher when its node holds the next candidate so that earlier matches in
+                other nodes avoid running it
+             */
+            walk->cursors[bestNode] = walk->matched[bestNode] = resolveCombinedRoute(walk, bestNode);
+            continue;
+        }
+        walk->cursors[bestNode]++;
+        return best;
+    }
+}
+
+
+/*
+    Use the combined matchers of a node to advance the node cursor to the first route whose pattern matches the request
+    path and accepts the request method. Returns the route position or node->count if none match.
+ */
+static int resolveCombinedRoute(RouteWalk *walk, int i)
+{
+    HttpRouteNode       *node;
+    HttpRouteMatcher    *matcher;
+    RouteCallout        data;
+    pcre_extra          extra;
+    int                 ovector[ROUTE_COMBINE_CAPTURES * 3];
+    int                 next, rc, result, size;
+
+    node = walk->nodes[i];
+    memset(&extra, 0, sizeof(extra));
+    extra.flags = PCRE_EXTRA_CALLOUT_DATA;
+    extra.callout_data = &data;
+    data.index = walk->index;
+    data.node = node;
+    data.method = walk->method;
+    data.start = walk->cursors[i];
+    result = node->count;
+
+    startRouteCallout();
+    for (next = data.start / ROUTE_COMBINE_MAX; next < mprGetListLength(node->matchers); next++) {
+        matcher = mprGetItem(node->matchers, next);
+        if (!matcher->compiled) {
+            /* Test each route of this matcher individually */
+            result = data.start;
+            break;
+        }
+        data.matcher = matcher;
+        data.found = -1;
+        size = (matcher->captureCount < ROUTE_COMBINE_CAPTURES) ? (matcher->captureCount + 1) * 3 : 0;
+        rc = pcre_exec(matcher->compiled, &extra, walk->path, (int) slen(walk->path), 0, 0, size ? ovector : NULL, size);
+        if (rc >= 0 && data.found >= 0) {
+            if (size) {
+                setCombinedMatches(walk, node, matcher, data.found - matcher->first, ovector);
+            }
+            result = data.found;
+            break;
+        }
+        if (rc != PCRE_ERROR_NOMATCH) {
+            result = data.start;
+            break;
+        }
+        data.start = matcher->first + matcher->count;
+    }
+    stopRouteCallout();
+    return result;
+}
+
+
+/*
+    Install the route callout hook for the duration of a combined match. Nested and concurrent matches share the hook.
+ */
+static void startRouteCallout()
+{
+    mprSpinLock(&calloutLock);
+    if (calloutUsers++ == 0 && pcre_callout != routeCallout) {
+        priorCallout = pcre_callout;
+        pcre_callout = routeCallout;
+    }
+    mprSpinUnlock(&calloutLock);
+}
+
+
+/*
+    Restore the prior callout hook when the last combined match completes, unless the hook has since been replaced
+ */
+static void stopRouteCallout()
+{
+    mprSpinLock(&calloutLock);
+    if (--calloutUsers == 0 && pcre_callout == routeCallout) {
+        pcre_callout = priorCallout;
+    }
+    mprSpinUnlock(&calloutLock);
+}
+
+
+/*
+    Save the captures of a combined matcher alternative as they would be returned by the route pattern
+ */
+static void setCombinedMatches(RouteWalk *walk, HttpRouteNode *node, HttpRouteMatcher *matcher, int alt, int *ovector)
+{
+    int     group, i;
+
+    if (matcher->captures[alt] < 0) {
+        /* Route pattern was not combined */
+        return;
+    }
+    walk->matches[0] = ovector[0];
+    walk->matches[1] = ovector[1];
+    walk->matchCount = 1;
+    for (i = 1; i <= matcher->captures[alt]; i++) {
+        group = matcher->groups[alt] + i - 1;
+        walk->matches[i * 2] = ovector[group * 2];
+        walk->matches[i * 2 + 1] = ovector[group * 2 + 1];
+        if (ovector[group * 2] >= 0) {
+            walk->matchCount = i + 1;
+        }
+    }
+    walk->prematched = node->routes[matcher->first + alt];
+}
+
+
+/*
+    Callout run after each alternative of a combined matcher matches. Return non-zero to reject the route and continue
+    with the next alternative.
+ */
+static int routeCallout(pcre_callout_block *cb)
+{
+    RouteCallout        *data;
+    HttpRouteMatcher    *matcher;
+    int                 low, high, mid, pos;
+
+    if (cb->callout_number != ROUTE_CALLOUT || (data = cb->callout_data) == 0 || (matcher = data->matcher) == 0) {
+        /* Not a combined matcher callout */
+        return priorCallout ? (priorCallout)(cb) : 0;
+    }
+    for (low = 0, high = matcher->count - 1; low <= high; ) {
+        mid = (low + high) / 2;
+        if (matcher->offsets[mid] == cb->pattern_position) {
+            pos = matcher->first + mid;
+            if (pos < data->start || !(data->index->methods[data->node->routes[pos]] & data->method)) {
+                return 1;
+            }
+            data->found = pos;
+            return 0;
+        } else if (matcher->offsets[mid] < cb->pattern_position) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+    Compute a mask of the rx method flags accepted by a route. This is a fast pre-test for matchRequestUri.
+ */
+static int routeMethodMask(HttpRoute *route)
+{
+    MprKey      *kp;
+    int         mask;
+
+    mask = 0;
+    for (ITERATE_KEYS(route->methods, kp)) {
+        if (smatch(kp->key, "*")) {
+            return ROUTE_METHOD_ALL;
+        } else if (smatch(kp->key, "DELETE")) {
+            mask |= HTTP_DELETE;
+        } else if (smatch(kp->key, "GET")) {
+            mask |= HTTP_GET | HTTP_HEAD;
+        } else if (smatch(kp->key, "HEAD")) {
+            mask |= HTTP_HEAD;
+        } else if (smatch(kp->key, "OPTIONS")) {
+            mask |= HTTP_OPTIONS;
+        } else if (smatch(kp->key, "POST")) {
+            mask |= HTTP_POST;
+        } else if (smatch(kp->key, "PUT")) {
+            mask |= HTTP_PUT;
+        } else if (smatch(kp->key, "TRACE")) {
+            mask |= HTTP_TRACE;
+        } else {
+            mask |= ROUTE_METHOD_OTHER;
+        }
+    }
+    return mask;
+}
+
+
+static void manageRouteIndex(HttpRouteIndex *index, int flags)
+{
+    int     i;
+
+    if (flags & MPR_MANAGE_MARK) {
+        if (index->cache) {
+            for (i = 0; i < index->cacheSets * ROUTE_CACHE_WAYS; i++) {
+                mprMark(index->cache[i]);
+            }
+            mprMark(index->cache);
+        }
+        mprMark(index->all);
+        mprMark(index->routes);
+        mprMark(index->root);
+        mprMark(index->methods);
+    }
+}
+
+
+static void manageRouteMatcher(HttpRouteMatcher *matcher, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(matcher->captures);
+        mprMark(matcher->groups);
+        mprMark(matcher->offsets);
+
+    } else if (flags & MPR_MANAGE_FREE) {
+        if (matcher->compiled) {
+            free(matcher->compiled);
+        }
+    }
+}
+
+
+static void manageRouteNode(HttpRouteNode *node, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(node->children);
+        mprMark(node->matchers);
+        mprMark(node->routes);
+        mprMark(node->wild);
+    }
+}
+
+
+/*
+    Test if the selection of a route depends only on the request method and pathInfo
+ */
+static bool canCacheRoute(HttpRoute *route)
+{
+    return mprGetListLength(route->conditions) == 0 && mprGetListLength(route->updates) == 0 &&
+        mprGetListLength(route->params) == 0 && mprGetListLength(route->requestHeaders) == 0 &&
+        !route->prefix[0] && (route->handler || mprGetListLength(route->handlers) == 0);
+}
+
+
+static uint routeCacheHash(cchar *method, cchar *path)
+{
+    return shash(path, slen(path)) * 31 + shash(method, slen(method));
+}
+
+
+/*
+    Select the route for a request from the route cache. This bypasses route matching and request checks, but runs
+    the handler selection and route target for the request. Returns HTTP_ROUTE_REJECT if the request is not cached.
+ */
+static int useRouteCache(HttpStream *stream, HttpRouteIndex *index)
+{
+    HttpRx          *rx;
+    HttpRoute       *route;
+    RouteCacheEntry *entry, **set;
+    uint            hash;
+    int             i, rc;
+
+    rx = stream->rx;
+    hash = routeCacheHash(rx->method, rx->pathInfo);
+    set = &index->cache[(hash % index->cacheSets) * ROUTE_CACHE_WAYS];
+    for (i = 0; i < ROUTE_CACHE_WAYS; i++) {
+        entry = set[i];
+        if (entry && entry->hash == hash && smatch(entry->path, rx->pathInfo) && smatch(entry->method, rx->method)) {
+            break;
+        }
     }
-    if ((rc = matchRequestUri(stream, route)) == HTTP_ROUTE_OK) {
-        rc = checkRoute(stream, route);
+    if (i >= ROUTE_CACHE_WAYS) {
+        mprAtomicAdd64(&stream->http->routeCacheMisses, 1);
+        return HTTP_ROUTE_REJECT;
     }
-    if (rc == HTTP_ROUTE_REJECT && savePathInfo) {
-        /* Keep the modified pathInfo if OK or REWRITE */
-        rx->pathInfo = savePathInfo;
-        rx->scriptName = 0;
+    entry->lastUsed = ++index->cacheClock;
+    mprAtomicAdd64(&stream->http->routeCacheHits, 1);
+
+    route = rx->route = entry->route;
+    memcpy(rx->matches, entry->matches, sizeof(rx->matches));
+    rx->matchCount = entry->matchCount;
+    rx->target = route->target ? expandRouteTarget(stream, route) : sclone(&rx->pathInfo[1]);
+    if ((rc = selectHandler(stream, route)) != HTTP_ROUTE_OK) {
+        return rc;
     }
-    return rc;
+    return runRouteTarget(stream, route);
 }
 
 
-static int matchRequestUri(HttpStream *stream, HttpRoute *route)
+/*
+    Save a route selection in the route cache. The least recently used entry of the cache set is replaced.
+ */
+static void saveRouteCache(HttpStream *stream, HttpRouteIndex *index, HttpRoute *route, cchar *path)
 {
-    HttpRx      *rx;
+    HttpRx          *rx;
+    RouteCacheEntry *entry, **set;
+    uint            hash;
+    int             i, slot;
 
-    assert(stream);
-    assert(route);
     rx = stream->rx;
-
-    if (route->patternCompiled) {
-        rx->matchCount = pcre_exec(route->patternCompiled, NULL, rx->pathInfo, (int) slen(rx->pathInfo), 0, 0,
-            rx->matches, sizeof(rx->matches) / sizeof(int));
-        if (route->flags & HTTP_ROUTE_NOT) {
-            if (rx->matchCount > 0) {
-                return HTTP_ROUTE_REJECT;
-            }
-            rx->matchCount = 1;
-            rx->matches[0] = 0;
-            rx->matches[1] = (int) slen(rx->pathInfo);
-
-        } else if (rx->matchCount <= 0) {
-            return HTTP_ROUTE_REJECT;
-        }
-    } else if (route->pattern && *route->pattern) {
-        /* Pattern compilation failed */
-        return HTTP_ROUTE_REJECT;
+    if (!canCacheRoute(route) || slen(path) > ROUTE_CACHE_PATH || !smatch(path, rx->pathInfo) || stream->tx->finalized) {
+        return;
     }
-    if (!mprLookupKey(route->methods, rx->method)) {
-        if (!mprLookupKey(route->methods, "*")) {
-            if (!(rx->flags & HTTP_HEAD && mprLookupKey(route->methods, "GET"))) {
-                return HTTP_ROUTE_REJECT;
-            }
+    if ((entry = mprAllocObj(RouteCacheEntry, manageRouteCacheEntry)) == 0) {
+        return;
+    }
+    entry->method = sclone(rx->method);
+    entry->path = sclone(path);
+    entry->route = route;
+    memcpy(entry->matches, rx->matches, sizeof(entry->matches));
+    entry->matchCount = rx->matchCount;
+    entry->hash = hash = routeCacheHash(entry->method, entry->path);
+    entry->lastUsed = ++index->cacheClock;
+
+    set = &index->cache[(hash % index->cacheSets) * ROUTE_CACHE_WAYS];
+    for (slot = 0, i = 0; i < ROUTE_CACHE_WAYS; i++) {
+        if (!set[i]) {
+            slot = i;
+            break;
+        }
+        if (set[i]->lastUsed < set[slot]->lastUsed) {
+            slot = i;
         }
     }
-    rx->route = route;
-    return HTTP_ROUTE_OK;
+    /* Publish the completed entry for readers */
+    mprAtomicBarrier();
+    set[slot] = entry;
+}
+
+
+static void manageRouteCacheEntry(RouteCacheEntry *entry, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(entry->method);
+        mprMark(entry->path);
+        mprMark(entry->route);
+    }
 }
 
 
 static int checkRoute(HttpStream *stream, HttpRoute *route)
 {
     HttpRouteOp     *op, *condition, *update;
-    HttpRouteProc   *proc;
     HttpRx          *rx;
-    HttpTx          *tx;
-    cchar           *token, *value, *header, *field;
+    cchar           *header, *field;
     int             next, rc, matched[ME_MAX_ROUTE_MATCHES * 2], count, result;
 
     assert(stream);
     assert(route);
     rx = stream->rx;
-    tx = stream->tx;
     assert(rx->pathInfo[0]);
 
-    rx->target = route->target ? expandTokens(stream, route->target) : sclone(&rx->pathInfo[1]);
+    rx->target = route->target ? expandRouteTarget(stream, route) : sclone(&rx->pathInfo[1]);
 
     if (route->requestHeaders) {
         for (next = 0; (op = mprGetNextItem(route->requestHeaders, &next)) != 0; ) {
@@ -570,6 +1552,24 @@ static int checkRoute(HttpStream *stream, HttpRoute *route)
     if ((rc = selectHandler(stream, route)) != HTTP_ROUTE_OK) {
         return rc;
     }
+    return runRouteTarget(stream, route);
+}
+
+
+/*
+    Define token params and run the route target for a selected route
+ */
+static int runRouteTarget(HttpStream *stream, HttpRoute *route)
+{
+    HttpRouteProc   *proc;
+    HttpRx          *rx;
+    HttpTx          *tx;
+    cchar           *token, *value;
+    int             next, rc;
+
+    rx = stream->rx;
+    tx = stream->tx;
+
     if (route->tokens) {
         for (next = 0; (token = mprGetNextItem(route->tokens, &next)) != 0; ) {
             int index = rx->matches[next * 2];
@@ -769,7 +1769,11 @@ PUBLIC int httpAddRouteCondition(HttpRoute *route, cchar *name, cchar *details,
         }
         op->details = finalizeReplacement(route, details);
     }
+    if (op->details) {
+        op->compiled = compileTemplate(op->details, ROUTE_TEMPLATE_MATCHES);
+    }
     addUniqueItem(route->conditions, op);
+    HTTP->routeVersion++;
     return 0;
 }
 
@@ -944,6 +1948,7 @@ PUBLIC void httpAddRouteParam(HttpRoute *route, cchar *field, cchar *value, int
     } else {
         op->flags |= HTTP_ROUTE_FREE;
         mprAddItem(route->params, op);
+        HTTP->routeVersion++;
     }
 }
 
@@ -970,6 +1975,7 @@ PUBLIC void httpAddRouteRequestHeaderCheck(HttpRoute *route, cchar *header, ccha
     } else {
         op->flags |= HTTP_ROUTE_FREE;
         mprAddItem(route->requestHeaders, op);
+        HTTP->routeVersion++;
     }
 }
 
@@ -998,6 +2004,7 @@ PUBLIC void httpAddRouteResponseHeader(HttpRoute *route, int cmd, cchar *header,
         }
     }
     mprAddItem(route->headers, mprCreateKeyPair(header, value, cmd));
+    route->headerPrefixes = 0;
 }
 
 
@@ -1022,6 +2029,7 @@ PUBLIC int httpAddRouteUpdate(HttpRoute *route, cchar *rule, cchar *details, int
     }
     if (scaselessmatch(rule, "cmd")) {
         op->details = sclone(details);
+        op->compiled = compileTemplate(op->details, ROUTE_TEMPLATE_MATCHES);
 
     } else if (scaselessmatch(rule, "lang")) {
         /* Nothing to do */;
@@ -1031,11 +2039,13 @@ PUBLIC int httpAddRouteUpdate(HttpRoute *route, cchar *rule, cchar *details, int
             return MPR_ERR_BAD_SYNTAX;
         }
         op->value = finalizeReplacement(route, value);
+        op->compiled = compileTemplate(op->value, ROUTE_TEMPLATE_MATCHES);
 
     } else {
         return MPR_ERR_BAD_SYNTAX;
     }
     addUniqueItem(route->updates, op);
+    HTTP->routeVersion++;
     return 0;
 }
 
@@ -1180,6 +2190,15 @@ PUBLIC void httpResetHandlers(HttpRoute *route)
 }
 
 
+PUBLIC void httpSetRouteAsyncRead(HttpRoute *route, bool on)
+{
+    route->flags &= ~HTTP_ROUTE_ASYNC_READ;
+    if (on) {
+        route->flags |= HTTP_ROUTE_ASYNC_READ;
+    }
+}
+
+
 PUBLIC void httpSetRouteAuth(HttpRoute *route, HttpAuth *auth)
 {
     assert(route);
@@ -1346,6 +2365,7 @@ PUBLIC void httpAddRouteMethods(HttpRoute *route, cchar *methods)
     while ((method = stok(tok, ", \t\n\r", &tok)) != 0) {
         mprAddKey(route->methods, method, LTOP(1));
     }
+    HTTP->routeVersion++;
 }
 
 
@@ -1358,6 +2378,7 @@ PUBLIC void httpRemoveRouteMethods(HttpRoute *route, cchar *methods)
     while ((method = stok(tok, ", \t\n\r", &tok)) != 0) {
         mprRemoveKey(route->methods, method);
     }
+    HTTP->routeVersion++;
 }
 
 
@@ -1410,6 +2431,7 @@ PUBLIC void httpSetRoutePattern(HttpRoute *route, cchar *pattern, int flags)
     route->flags |= (flags & HTTP_ROUTE_NOT);
     route->pattern = sclone(pattern);
     finalizePattern(route);
+    HTTP->routeVersion++;
 }
 
 
@@ -1437,6 +2459,7 @@ PUBLIC void httpSetRoutePrefix(HttpRoute *route, cchar *prefix)
     if (route->pattern) {
         finalizePattern(route);
     }
+    HTTP->routeVersion++;
     assert(route->prefix);
 }
 
@@ -1499,6 +2522,7 @@ PUBLIC void httpSetRouteStealth(HttpRoute *route, bool on)
     if (on) {
         route->flags |= HTTP_ROUTE_STEALTH;
     }
+    route->headerPrefixes = 0;
 }
 
 
@@ -1704,6 +2728,21 @@ static void finalizePattern(HttpRoute *route)
     if (mprGetListLength(route->tokens) == 0) {
         route->tokens = 0;
     }
+    /*
+        Patterns without regular expression characters are matched by string comparison instead of pcre
+     */
+    route->literalPattern = 0;
+    route->literalPatternLen = 0;
+    route->literalExact = 0;
+    if (!route->tokens) {
+        cp = &route->optimizedPattern[1];
+        len = strcspn(cp, "^$*+?.()|{}[]\\");
+        if (cp[len] == '\0' || (cp[len] == '$' && cp[len + 1] == '\0')) {
+            route->literalPattern = snclone(cp, len);
+            route->literalPatternLen = len;
+            route->literalExact = (cp[len] == '$');
+        }
+    }
     if (route->patternCompiled && (route->flags & HTTP_ROUTE_FREE_PATTERN)) {
         free(route->patternCompiled);
     }
@@ -1895,6 +2934,9 @@ PUBLIC void httpFinalizeRoute(HttpRoute *route)
     if (mprGetListLength(route->indexes) == 0) {
         mprAddItem(route->indexes,  sclone("index.html"));
     }
+    if (route->target && (!route->targetTemplate || route->targetTemplate->source != route->target)) {
+        route->targetTemplate = compileTemplate(route->target, ROUTE_TEMPLATE_MATCHES);
+    }
     httpAddRoute(route->host, route);
 }
 
@@ -2238,7 +3280,7 @@ static int directoryCondition(HttpStream *stream, HttpRoute *route, HttpRouteOp
     saveFilename = tx->filename;
 
     httpMapFile(stream);
-    path = mprJoinPath(route->documents, expandTokens(stream, op->details));
+    path = mprJoinPath(route->documents, expandOpTokens(stream, op, op->details));
     tx->ext = saveExt;
     tx->filename = saveFilename;
 
@@ -2267,7 +3309,7 @@ static int existsCondition(HttpStream *stream, HttpRoute *route, HttpRouteOp *op
     saveFilename = tx->filename;
 
     httpMapFile(stream);
-    path = mprJoinPath(route->documents, expandTokens(stream, op->details));
+    path = mprJoinPath(route->documents, expandOpTokens(stream, op, op->details));
     tx->ext = saveExt;
     tx->filename = saveFilename;
 
@@ -2290,7 +3332,7 @@ static int matchCondition(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
     assert(route);
     assert(op);
 
-    str = expandTokens(stream, op->details);
+    str = expandOpTokens(stream, op, op->details);
     count = pcre_exec(op->mdata, NULL, str, (int) slen(str), 0, 0, matched, sizeof(matched) / sizeof(int));
     if (count > 0) {
         return HTTP_ROUTE_OK;
@@ -2321,7 +3363,7 @@ static int secureCondition(HttpStream *stream, HttpRoute *route, HttpRouteOp *op
     if (op->flags & HTTP_ROUTE_REDIRECT) {
         if (!stream->secure) {
             assert(op->details && *op->details);
-            httpRedirect(stream, HTTP_CODE_MOVED_PERMANENTLY, expandTokens(stream, op->details));
+            httpRedirect(stream, HTTP_CODE_MOVED_PERMANENTLY, expandOpTokens(stream, op, op->details));
         }
         return HTTP_ROUTE_OK;
     }
@@ -2359,7 +3401,7 @@ static int cmdUpdate(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
     assert(route);
     assert(op);
 
-    command = expandTokens(stream, op->details);
+    command = expandOpTokens(stream, op, op->details);
     cmd = mprCreateCmd(stream->dispatcher);
     httpLog(stream->trace, "route.run", "context", "command:'%s'", command);
     if ((status = mprRunCmd(cmd, command, NULL, NULL, &out, &err, -1, 0)) != 0) {
@@ -2379,7 +3421,7 @@ static int paramUpdate(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
     assert(route);
     assert(op);
 
-    httpSetParam(stream, op->var, expandTokens(stream, op->value));
+    httpSetParam(stream, op->var, expandOpTokens(stream, op, op->value));
     return HTTP_ROUTE_OK;
 }
 
@@ -2442,7 +3484,7 @@ static int redirectTarget(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
     assert(route);
     assert(route->target);
 
-    target = expandTokens(stream, route->target);
+    target = expandRouteTarget(stream, route);
     httpRedirect(stream, route->responseStatus ? route->responseStatus : HTTP_CODE_MOVED_TEMPORARILY, target);
     return HTTP_ROUTE_OK;
 }
@@ -2450,7 +3492,7 @@ static int redirectTarget(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
 
 static int runTarget(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
 {
-    stream->rx->target = route->target ? expandTokens(stream, route->target) : sclone(&stream->rx->pathInfo[1]);
+    stream->rx->target = route->target ? expandRouteTarget(stream, route) : sclone(&stream->rx->pathInfo[1]);
     return HTTP_ROUTE_OK;
 }
 
@@ -2465,7 +3507,7 @@ static int writeTarget(HttpStream *stream, HttpRoute *route, HttpRouteOp *op)
     /*
         Need to re-compute output string as updates may have run to define params which affect the route->target tokens
      */
-    str = route->target ? expandTokens(stream, route->target) : sclone(&stream->rx->pathInfo[1]);
+    str = route->target ? expandRouteTarget(stream, route) : sclone(&stream->rx->pathInfo[1]);
     if (!(route->flags & HTTP_ROUTE_RAW)) {
         str = mprEscapeHtml(str);
     }
@@ -2664,6 +3706,7 @@ static void manageRouteOp(HttpRouteOp *op, int flags)
         mprMark(op->details);
         mprMark(op->var);
         mprMark(op->value);
+        mprMark(op->compiled);
 
     } else if (flags & MPR_MANAGE_FREE) {
         if (op->flags & HTTP_ROUTE_FREE) {
@@ -2757,260 +3800,404 @@ static void defineHostVars(HttpRoute *route)
 }
 
 
-static char *expandTokens(HttpStream *stream, cchar *str)
-{
-    HttpRx      *rx;
-
-    assert(stream);
-    assert(str);
-
-    rx = stream->rx;
-    return expandRequestTokens(stream, expandPatternTokens(rx->pathInfo, str, rx->matches, rx->matchCount));
-}
-
-
 /*
-    WARNING: str is modified. Result is allocated string.
+    Compile a string with pattern and request tokens into a list of literal text and token ops.
+    If flags has ROUTE_TEMPLATE_MATCHES, the string may contain pattern match tokens prepared by finalizeReplacement:
+    $N, $&, $`, $' and $$. In that case, "$${token}" is a request token. Request tokens are of the form:
+    ${header:name=default}, ${param:name=default}, ${request:var=default} and ${ssl:var}.
  */
-static char *expandRequestTokens(HttpStream *stream, char *str)
+static HttpRouteTemplate *compileTemplate(cchar *str, int flags)
 {
-    HttpRx      *rx;
-    HttpTx      *tx;
-    HttpRoute   *route;
-    HttpUri     *uri;
-    MprBuf      *buf;
-    HttpLang    *lang;
-    char        *tok, *cp, *key, *value, *field, *header, *defaultValue, *state, *v, *p;
-
-    assert(stream);
-    assert(str);
-
-    rx = stream->rx;
-    route = rx->route;
-    tx = stream->tx;
-    buf = mprCreateBuf(-1, -1);
-    tok = 0;
-    uri = rx->parsedUri;
+    HttpRouteTemplate   *tp;
+    RouteTemplateOp     *op;
+    cchar               *cp, *lit, *next, *end;
+    int                 max;
 
-    for (cp = str; cp && *cp; ) {
-        if ((tok = strstr(cp, "${")) == 0) {
-            break;
-        }
-        if (tok > cp) {
-            mprPutBlockToBuf(buf, cp, tok - cp);
+    if ((tp = mprAllocObj(HttpRouteTemplate, manageRouteTemplate)) == 0) {
+        return 0;
+    }
+    tp->source = str;
+    for (max = 1, cp = str; cp && *cp; cp++) {
+        if (*cp == '$') {
+            max += 2;
         }
-        if ((key = stok(&tok[2], ".:}", &value)) == 0) {
+    }
+    if ((tp->ops = mprAllocZeroed(max * sizeof(RouteTemplateOp))) == 0) {
+        return 0;
+    }
+    for (lit = cp = str; cp && *cp; ) {
+        if (*cp != '$') {
+            cp++;
             continue;
         }
-        if ((stok(value, "}", &cp)) == 0) {
-            continue;
+        next = &cp[1];
+        if ((flags & ROUTE_TEMPLATE_MATCHES) && *next == '$') {
+            if (next[1] != '{') {
+                /* "$$" is a literal "$" */
+                addTemplateLiteral(tp, lit, next - lit);
+                lit = cp = &next[1];
+                continue;
+            }
+            /* "$${token}" is a request token */
+            next++;
         }
-        if (smatch(key, "header")) {
-            header = stok(value, "=", &defaultValue);
-            if ((value = (char*) httpGetHeader(stream, header)) == 0) {
-                value = defaultValue ? defaultValue : "";
+        if (*next == '{') {
+            if ((end = schr(next, '}')) == 0) {
+                break;
             }
-            mprPutStringToBuf(buf, value);
-
-        } else if (smatch(key, "param")) {
-            field = stok(value, "=", &defaultValue);
-            if (defaultValue == 0) {
-                defaultValue = "";
+            addTemplateLiteral(tp, lit, cp - lit);
+            if (compileTemplateToken(&tp->ops[tp->count], &next[1], end - &next[1])) {
+                tp->count++;
+            }
+            lit = cp = &end[1];
+
+        } else if ((flags & ROUTE_TEMPLATE_MATCHES) &&
+                (*next == '&' || *next == '`' || *next == '\'' || isdigit((uchar) *next))) {
+            addTemplateLiteral(tp, lit, cp - lit);
+            op = &tp->ops[tp->count++];
+            if (*next == '&') {
+                op->type = TPL_MATCH;
+            } else if (*next == '`') {
+                op->type = TPL_BEFORE;
+            } else if (*next == '\'') {
+                op->type = TPL_AFTER;
+            } else {
+                op->type = TPL_MATCH;
+                op->index = atoi(next);
+                while (isdigit((uchar) next[1])) {
+                    next++;
+                }
             }
-            mprPutStringToBuf(buf, httpGetParam(stream, field, defaultValue));
+            lit = cp = &next[1];
+
+        } else {
+            /* Not a token. Keep the "$" as literal text. */
+            cp = next;
+        }
+    }
+    if (lit) {
+        addTemplateLiteral(tp, lit, slen(lit));
+    }
+    return tp;
+}
 
-        } else if (smatch(key, "request")) {
-            value = stok(value, "=", &defaultValue);
-            //  OPT with switch on first char
 
-            if (smatch(value, "authenticated")) {
-                mprPutStringToBuf(buf, rx->authenticated ? "true" : "false");
+static void addTemplateLiteral(HttpRouteTemplate *tp, cchar *str, ssize len)
+{
+    RouteTemplateOp     *op;
 
-            } else if (smatch(value, "clientAddress")) {
-                mprPutStringToBuf(buf, stream->ip);
+    if (len > 0) {
+        op = &tp->ops[tp->count++];
+        op->type = TPL_LITERAL;
+        op->str = snclone(str, len);
+        op->len = len;
+    }
+}
 
-            } else if (smatch(value, "clientPort")) {
-                mprPutIntToBuf(buf, stream->port);
 
-            } else if (smatch(value, "error")) {
-                mprPutStringToBuf(buf, stream->errorMsg);
+/*
+    Compile a request token of the form: "key:name=default". The key may also be delimited by ".".
+    Returns false for unknown tokens which expand to nothing.
+ */
+static bool compileTemplateToken(RouteTemplateOp *op, cchar *token, ssize len)
+{
+    char    *key, *name, *defaultValue;
+    int     i;
 
-            } else if (smatch(value, "ext")) {
-                mprPutStringToBuf(buf, uri->ext);
+    key = snclone(token, len);
+    if ((name = spbrk(key, ".:")) == 0) {
+        return 0;
+    }
+    *name++ = '\0';
+    name = stok(name, "=", &defaultValue);
+    op->str = sclone(name);
+    op->defaultValue = defaultValue ? sclone(defaultValue) : 0;
 
-            } else if (smatch(value, "extraPath")) {
-                mprPutStringToBuf(buf, rx->extraPath);
+    if (smatch(key, "header")) {
+        op->type = TPL_HEADER;
 
-            } else if (smatch(value, "filename")) {
-                mprPutStringToBuf(buf, tx->filename);
+    } else if (smatch(key, "param")) {
+        op->type = TPL_PARAM;
 
-            } else if (scaselessmatch(value, "language")) {
-                if (!defaultValue) {
-                    defaultValue = route->defaultLanguage;
-                }
-                if ((lang = httpGetLanguage(stream, route->languages, defaultValue)) != 0) {
-                    mprPutStringToBuf(buf, lang->suffix);
-                } else {
-                    mprPutStringToBuf(buf, defaultValue);
-                }
+    } else if (smatch(key, "request")) {
+        op->type = TPL_REQUEST;
+        for (i = 0; templateRequestVars[i]; i++) {
+            if (smatch(name, templateRequestVars[i]) ||
+                    ((i == TPL_REQ_LANGUAGE || i == TPL_REQ_LANGUAGE_DIR) && scaselessmatch(name, templateRequestVars[i]))) {
+                break;
+            }
+        }
+        if (templateRequestVars[i] == 0) {
+            return 0;
+        }
+        op->index = i;
 
-            } else if (scaselessmatch(value, "languageDir")) {
-                lang = httpGetLanguage(stream, route->languages, 0);
-                if (!defaultValue) {
-                    defaultValue = ".";
-                }
-                mprPutStringToBuf(buf, lang ? lang->path : defaultValue);
+    } else if (smatch(key, "ssl")) {
+        op->type = TPL_SSL;
 
-            } else if (smatch(value, "host")) {
-                mprPutStringToBuf(buf, httpFormatUri(0, uri->host, uri->port, 0, 0, 0, 0));
+    } else {
+        return 0;
+    }
+    return 1;
+}
 
-            } else if (smatch(value, "method")) {
-                mprPutStringToBuf(buf, rx->method);
 
-            } else if (smatch(value, "origin")) {
-                if (rx->origin) {
-                    mprPutStringToBuf(buf, rx->origin);
-                } else {
-                    mprPutStringToBuf(buf, httpFormatUri(rx->parsedUri->scheme, uri->host, uri->port, 0, 0, 0, 0));
-                }
+/*
+    Get the value of a template op for the current request and set *len. Match values are not null terminated.
+ */
+static cchar *getTemplateValue(HttpStream *stream, RouteTemplateOp *op, ssize *len)
+{
+    HttpRx      *rx;
+    HttpTx      *tx;
+    HttpUri     *uri;
+    HttpLang    *lang;
+    cchar       *value, *defaultValue, *state, *p;
+    char        *v;
+    int         *matches, submatch;
 
-            } else if (smatch(value, "originalUri")) {
-                mprPutStringToBuf(buf, rx->originalUri);
+    rx = stream->rx;
+    tx = stream->tx;
+    uri = rx->parsedUri;
+    matches = rx->matches;
+    value = 0;
+
+    switch (op->type) {
+    case TPL_LITERAL:
+        *len = op->len;
+        return op->str;
+
+    case TPL_MATCH:
+        submatch = op->index * 2;
+        if (op->index < rx->matchCount && matches[submatch] >= 0) {
+            *len = matches[submatch + 1] - matches[submatch];
+            return &rx->pathInfo[matches[submatch]];
+        }
+        break;
 
-            } else if (smatch(value, "pathInfo")) {
-                mprPutStringToBuf(buf, rx->pathInfo);
+    case TPL_BEFORE:
+        if (rx->matchCount > 0) {
+            *len = matches[0];
+            return rx->pathInfo;
+        }
+        break;
 
-            } else if (smatch(value, "prefix")) {
-                mprPutStringToBuf(buf, route->prefix);
+    case TPL_AFTER:
+        if (rx->matchCount > 0) {
+            value = &rx->pathInfo[matches[1]];
+        }
+        break;
 
-            } else if (smatch(value, "query")) {
-                mprPutStringToBuf(buf, uri->query);
+    case TPL_HEADER:
+        if ((value = httpGetHeader(stream, op->str)) == 0) {
+            value = op->defaultValue;
+        }
+        break;
 
-            } else if (smatch(value, "reference")) {
-                mprPutStringToBuf(buf, uri->reference);
+    case TPL_PARAM:
+        value = httpGetParam(stream, op->str, op->defaultValue ? op->defaultValue : "");
+        break;
 
-            } else if (smatch(value, "scheme")) {
-                if (uri->scheme) {
-                    mprPutStringToBuf(buf, uri->scheme);
-                }  else {
-                    mprPutStringToBuf(buf, (stream->secure) ? "https" : "http");
-                }
+    case TPL_REQUEST:
+        defaultValue = op->defaultValue;
+        switch (op->index) {
+        case TPL_REQ_AUTHENTICATED:
+            value = rx->authenticated ? "true" : "false";
+            break;
+        case TPL_REQ_CLIENT_ADDRESS:
+            value = stream->ip;
+            break;
+        case TPL_REQ_CLIENT_PORT:
+            value = itos(stream->port);
+            break;
+        case TPL_REQ_ERROR:
+            value = stream->errorMsg;
+            break;
+        case TPL_REQ_EXT:
+            value = uri->ext;
+            break;
+        case TPL_REQ_EXTRA_PATH:
+            value = rx->extraPath;
+            break;
+        case TPL_REQ_FILENAME:
+            value = tx->filename;
+            break;
+        case TPL_REQ_LANGUAGE:
+            if (!defaultValue) {
+                defaultValue = rx->route->defaultLanguage;
+            }
+            lang = httpGetLanguage(stream, rx->route->languages, defaultValue);
+            value = lang ? lang->suffix : defaultValue;
+            break;
+        case TPL_REQ_LANGUAGE_DIR:
+            lang = httpGetLanguage(stream, rx->route->languages, 0);
+            value = lang ? lang->path : (defaultValue ? defaultValue : ".");
+            break;
+        case TPL_REQ_HOST:
+            value = httpFormatUri(0, uri->host, uri->port, 0, 0, 0, 0);
+            break;
+        case TPL_REQ_METHOD:
+            value = rx->method;
+            break;
+        case TPL_REQ_ORIGIN:
+            value = rx->origin ? rx->origin : httpFormatUri(uri->scheme, uri->host, uri->port, 0, 0, 0, 0);
+            break;
+        case TPL_REQ_ORIGINAL_URI:
+            value = rx->originalUri;
+            break;
+        case TPL_REQ_PATH_INFO:
+            value = rx->pathInfo;
+            break;
+        case TPL_REQ_PREFIX:
+            value = rx->route->prefix;
+            break;
+        case TPL_REQ_QUERY:
+            value = uri->query;
+            break;
+        case TPL_REQ_REFERENCE:
+            value = uri->reference;
+            break;
+        case TPL_REQ_SCHEME:
+            value = uri->scheme ? uri->scheme : (stream->secure ? "https" : "http");
+            break;
+        case TPL_REQ_SCRIPT_NAME:
+            value = rx->scriptName;
+            break;
+        case TPL_REQ_SERVER_ADDRESS:
+            /* Pure IP address, no port. See "serverPort" */
+            value = stream->sock->acceptIp;
+            break;
+        case TPL_REQ_SERVER_PORT:
+            value = itos(stream->sock->acceptPort);
+            break;
+        case TPL_REQ_URI:
+            value = rx->uri;
+            break;
+        }
+        break;
+
+    case TPL_SSL:
+        state = mprGetSocketState(stream->sock);
+        if (smatch(op->str, "state")) {
+            value = state;
+        } else if ((p = scontains(state, op->str)) != 0) {
+            stok(sclone(p), "=", &v);
+            value = stok(v, ", ", NULL);
+        }
+        break;
+    }
+    *len = slen(value);
+    return value ? value : "";
+}
 
-            } else if (smatch(value, "scriptName")) {
-                mprPutStringToBuf(buf, rx->scriptName);
 
-            } else if (smatch(value, "serverAddress")) {
-                /* Pure IP address, no port. See "serverPort" */
-                mprPutStringToBuf(buf, stream->sock->acceptIp);
+/*
+    Expand a compiled template for the current request. The token values are gathered first so the result can be
+    written into one allocation.
+ */
+static char *expandTemplate(HttpStream *stream, HttpRouteTemplate *tp)
+{
+    RouteTemplateOp *op;
+    cchar           *pieces[ROUTE_TEMPLATE_PIECES], **values;
+    ssize           sizes[ROUTE_TEMPLATE_PIECES], *lens, len;
+    char            *result, *cp;
+    int             i;
+
+    if (tp->count == 0) {
+        return sclone("");
+    }
+    if (tp->count == 1 && tp->ops[0].type == TPL_LITERAL) {
+        return sclone(tp->ops[0].str);
+    }
+    if (tp->count <= ROUTE_TEMPLATE_PIECES) {
+        values = pieces;
+        lens = sizes;
+    } else {
+        values = mprAlloc(tp->count * sizeof(cchar*));
+        lens = mprAlloc(tp->count * sizeof(ssize));
+    }
+    for (len = 0, i = 0; i < tp->count; i++) {
+        op = &tp->ops[i];
+        values[i] = getTemplateValue(stream, op, &lens[i]);
+        len += lens[i];
+    }
+    if ((result = mprAlloc(len + 1)) == 0) {
+        return 0;
+    }
+    for (cp = result, i = 0; i < tp->count; i++) {
+        memcpy(cp, values[i], lens[i]);
+        cp += lens[i];
+    }
+    *cp = '\0';
+    return result;
+}
 
-            } else if (smatch(value, "serverPort")) {
-                mprPutIntToBuf(buf, stream->sock->acceptPort);
 
-            } else if (smatch(value, "uri")) {
-                mprPutStringToBuf(buf, rx->uri);
-            }
+static void manageRouteTemplate(HttpRouteTemplate *tp, int flags)
+{
+    RouteTemplateOp *op;
+    int             i;
 
-        } else if (smatch(key, "ssl")) {
-            value = stok(value, "=", &defaultValue);
-            if (smatch(value, "state")) {
-                mprPutStringToBuf(buf, mprGetSocketState(stream->sock));
-            } else {
-                state = mprGetSocketState(stream->sock);
-                if ((p = scontains(state, value)) != 0) {
-                    stok(p, "=", &v);
-                    mprPutStringToBuf(buf, stok(v, ", ", NULL));
-                }
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(tp->source);
+        if (tp->ops) {
+            for (i = 0; i < tp->count; i++) {
+                op = &tp->ops[i];
+                mprMark(op->str);
+                mprMark(op->defaultValue);
             }
+            mprMark(tp->ops);
         }
     }
-    assert(cp);
-    if (tok) {
-        if (tok > cp) {
-            mprPutBlockToBuf(buf, tok, tok - cp);
-        }
-    } else {
-        mprPutStringToBuf(buf, cp);
-    }
-    mprAddNullToBuf(buf);
-    return sclone(mprGetBufStart(buf));
 }
 
 
-PUBLIC char *httpExpandVars(HttpStream *stream, cchar *str)
+/*
+    Expand pattern and request tokens in a string
+ */
+static char *expandTokens(HttpStream *stream, cchar *str)
 {
-    return expandRequestTokens(stream, stemplate(str, stream->rx->route->vars));
+    assert(stream);
+    assert(str);
+
+    return expandTemplate(stream, compileTemplate(str, ROUTE_TEMPLATE_MATCHES));
 }
 
 
 /*
-    Replace text using pcre regular expression match indexes
+    Expand the route target using the template compiled when the route was finalized
  */
-static char *expandPatternTokens(cchar *str, cchar *replacement, int *matches, int matchCount)
+static char *expandRouteTarget(HttpStream *stream, HttpRoute *route)
 {
-    MprBuf  *result;
-    cchar   *end, *cp, *lastReplace;
-    int     submatch;
+    HttpRouteTemplate   *tp;
 
-    assert(str);
-    assert(replacement);
-    assert(matches);
+    assert(route->target);
 
-    result = mprCreateBuf(-1, -1);
-    lastReplace = replacement;
-    end = &replacement[slen(replacement)];
+    if ((tp = route->targetTemplate) == 0 || tp->source != route->target) {
+        /* Target modified after finalization */
+        tp = compileTemplate(route->target, ROUTE_TEMPLATE_MATCHES);
+    }
+    return expandTemplate(stream, tp);
+}
 
-    for (cp = replacement; cp < end; ) {
-        if (*cp == '$') {
-            if (lastReplace < cp) {
-                mprPutSubStringToBuf(result, lastReplace, (int) (cp - lastReplace));
-            }
-            switch (*++cp) {
-            case '$':
-                mprPutCharToBuf(result, '$');
-                break;
-            case '&':
-                /* Replace the matched string */
-                if (matchCount > 0) {
-                    mprPutSubStringToBuf(result, &str[matches[0]], matches[1] - matches[0]);
-                }
-                break;
-            case '`':
-                /* Insert the portion that preceeds the matched string */
-                if (matchCount > 0) {
-                    mprPutSubStringToBuf(result, str, matches[0]);
-                }
-                break;
-            case '\'':
-                /* Insert the portion that follows the matched string */
-                if (matchCount > 0) {
-                    mprPutSubStringToBuf(result, &str[matches[1]], slen(str) - matches[1]);
-                }
-                break;
-            default:
-                /* Insert the nth submatch */
-                if (isdigit((uchar) *cp)) {
-                    submatch = (int) atoi(cp);
-                    while (isdigit((uchar) *++cp))
-                        ;
-                    cp--;
-                    if (submatch < matchCount) {
-                        submatch *= 2;
-                        mprPutSubStringToBuf(result, &str[matches[submatch]], matches[submatch + 1] - matches[submatch]);
-                    }
-                } else {
-                    mprDebug("http route", 5, "Bad replacement $ specification in page");
-                    return 0;
-                }
-            }
-            lastReplace = cp + 1;
-        }
-        cp++;
+
+/*
+    Expand the details or value of a route condition or update using the template compiled when the op was defined
+ */
+static char *expandOpTokens(HttpStream *stream, HttpRouteOp *op, cchar *str)
+{
+    if (op->compiled && op->compiled->source == str) {
+        return expandTemplate(stream, op->compiled);
     }
-    if (lastReplace < cp && lastReplace < end) {
-        mprPutSubStringToBuf(result, lastReplace, (int) (cp - lastReplace));
+    return expandTokens(stream, str);
+}
+
+
+PUBLIC char *httpExpandVars(HttpStream *stream, cchar *str)
+{
+    if (str == 0 || !schr(str, '$')) {
+        return sclone(str);
     }
-    mprAddNullToBuf(result);
-    return sclone(mprGetBufStart(result));
+    return expandTemplate(stream, compileTemplate(stemplate(str, stream->rx->route->vars), 0));
 }
 
 
@@ -28,7 +28,6 @@ PUBLIC HttpRx *httpCreateRx(HttpStream *stream)
     rx->pathInfo = sclone("/");
     rx->scriptName = mprEmptyString();
     rx->needInputPipeline = httpClientStream(stream);
-    rx->headers = mprCreateHash(HTTP_SMALL_HASH_SIZE, MPR_HASH_CASELESS | MPR_HASH_STABLE);
     rx->chunkState = HTTP_CHUNK_UNCHUNKED;
     rx->remainingContent = 0;
 
@@ -41,6 +40,8 @@ PUBLIC HttpRx *httpCreateRx(HttpStream *stream)
 
 static void manageRx(HttpRx *rx, int flags)
 {
+    int     i;
+
     if (flags & MPR_MANAGE_MARK) {
         mprMark(rx->accept);
         mprMark(rx->acceptCharset);
@@ -57,6 +58,15 @@ static void manageRx(HttpRx *rx, int flags)
         mprMark(rx->files);
         mprMark(rx->headerPacket);
         mprMark(rx->headers);
+        if (rx->fields) {
+            for (i = 0; i < rx->fieldCount; i++) {
+                if (rx->fields[i].id < 0) {
+                    mprMark(rx->fields[i].key);
+                }
+                mprMark(rx->fields[i].value);
+            }
+            mprMark(rx->fields);
+        }
         mprMark(rx->hostHeader);
         mprMark(rx->inputPipeline);
         mprMark(rx->inputRange);
@@ -226,13 +236,118 @@ PUBLIC cchar *httpGetCookie(HttpStream *stream, cchar *name)
 }
 
 
+/*
+    Names of the well-known headers. Must be in HTTP_HEADER_* order.
+ */
+static cchar *headerNames[HTTP_HEADER_MAX] = {
+    "accept", "accept-charset", "accept-encoding", "accept-language", "authorization", "cache-control", "connection",
+    "content-length", "content-range", "content-type", "cookie", "expect", "host", "if-match", "if-modified-since",
+    "if-none-match", "if-range", "if-unmodified-since", "keep-alive", "location", "origin", "pragma", "range",
+    "referer", "sec-websocket-accept", "sec-websocket-key", "sec-websocket-protocol", "sec-websocket-version",
+    "set-cookie", "transfer-encoding", "upgrade", "user-agent", "www-authenticate", "x-http-method-override"
+};
+
+
+PUBLIC void httpInitHeaders(void)
+{
+    Http    *http;
+    int     id;
+
+    http = HTTP;
+    http->headerIds = mprCreateHash(HTTP_HEADER_MAX * 2,
+        MPR_HASH_CASELESS | MPR_HASH_STATIC_KEYS | MPR_HASH_STATIC_VALUES | MPR_HASH_STABLE);
+    for (id = 0; id < HTTP_HEADER_MAX; id++) {
+        mprAddKey(http->headerIds, headerNames[id], ITOP(id + 1));
+    }
+}
+
+
+PUBLIC int httpGetHeaderId(cchar *key)
+{
+    return (int) PTOI(mprLookupKey(HTTP->headerIds, key)) - 1;
+}
+
+
+/*
+    Received headers are stored in a flat field array. Well-known headers are indexed by ID in rx->known.
+ */
+PUBLIC void httpSetRxHeader(HttpStream *stream, cchar *key, cchar *value)
+{
+    HttpRx          *rx;
+    HttpHeaderField *field;
+    int             id, i;
+
+    rx = stream->rx;
+    id = httpGetHeaderId(key);
+    field = 0;
+    if (id >= 0) {
+        if (rx->known[id] && id != HTTP_HEADER_SET_COOKIE) {
+            field = &rx->fields[rx->known[id] - 1];
+        }
+    } else {
+        for (i = 0; i < rx->fieldCount; i++) {
+            if (rx->fields[i].id < 0 && scaselessmatch(rx->fields[i].key, key)) {
+                field = &rx->fields[i];
+                break;
+            }
+        }
+    }
+    if (!field) {
+        if (rx->fieldCount >= rx->fieldMax) {
+            rx->fieldMax = rx->fieldMax ? rx->fieldMax * 2 : HTTP_SMALL_HASH_SIZE;
+            if ((rx->fields = mprRealloc(rx->fields, rx->fieldMax * sizeof(HttpHeaderField))) == 0) {
+                return;
+            }
+        }
+        field = &rx->fields[rx->fieldCount];
+        field->id = id;
+        field->key = (id >= 0) ? headerNames[id] : httpArenaClone(stream, key);
+        if (id >= 0) {
+            rx->known[id] = (short) rx->fieldCount + 1;
+        }
+        rx->fieldCount++;
+    }
+    field->value = value;
+
+    if (rx->headers) {
+        if (id == HTTP_HEADER_SET_COOKIE) {
+            mprAddDuplicateKey(rx->headers, field->key, value);
+        } else {
+            mprAddKey(rx->headers, field->key, value);
+        }
+    }
+}
+
+
+PUBLIC cchar *httpGetHeaderById(HttpStream *stream, int id)
+{
+    HttpRx      *rx;
+
+    if ((rx = stream->rx) == 0 || id < 0 || id >= HTTP_HEADER_MAX || !rx->known[id]) {
+        return 0;
+    }
+    return rx->fields[rx->known[id] - 1].value;
+}
+
+
 PUBLIC cchar *httpGetHeader(HttpStream *stream, cchar *key)
 {
-    if (stream->rx == 0) {
+    HttpRx      *rx;
+    int         i, id;
+
+    if ((rx = stream->rx) == 0) {
         assert(stream->rx);
         return 0;
     }
-    return mprLookupKey(stream->rx->headers, slower(key));
+    if ((id = httpGetHeaderId(key)) >= 0) {
+        return httpGetHeaderById(stream, id);
+    }
+    for (i = 0; i < rx->fieldCount; i++) {
+        if (rx->fields[i].id < 0 && scaselessmatch(rx->fields[i].key, key)) {
+            return rx->fields[i].value;
+        }
+    }
+    return 0;
 }
 
 
@@ -264,17 +379,35 @@ PUBLIC char *httpGetHeadersFromHash(MprHash *hash)
 
 PUBLIC char *httpGetHeaders(HttpStream *stream)
 {
-    return httpGetHeadersFromHash(stream->rx->headers);
+    return httpGetHeadersFromHash(httpGetHeaderHash(stream));
 }
 
 
+/*
+    Create the hash view of the header fields on demand
+ */
 PUBLIC MprHash *httpGetHeaderHash(HttpStream *stream)
 {
-    if (stream->rx == 0) {
+    HttpRx          *rx;
+    HttpHeaderField *field;
+    int             i;
+
+    if ((rx = stream->rx) == 0) {
         assert(stream->rx);
         return 0;
     }
-    return stream->rx->headers;
+    if (!rx->headers) {
+        rx->headers = mprCreateHash(HTTP_SMALL_HASH_SIZE, MPR_HASH_CASELESS | MPR_HASH_STABLE);
+        for (i = 0; i < rx->fieldCount; i++) {
+            field = &rx->fields[i];
+            if (field->id == HTTP_HEADER_SET_COOKIE) {
+                mprAddDuplicateKey(rx->headers, field->key, field->value);
+            } else {
+                mprAddKey(rx->headers, field->key, field->value);
+            }
+        }
+    }
+    return rx->headers;
 }
 
 
@@ -472,7 +605,7 @@ PUBLIC HttpLang *httpGetLanguage(HttpStream *stream, MprHash *spoken, cchar *def
         return 0;
     }
     list = mprCreateList(-1, MPR_LIST_STABLE);
-    if ((accept = httpGetHeader(stream, "Accept-Language")) != 0) {
+    if ((accept = httpGetHeaderById(stream, HTTP_HEADER_ACCEPT_LANGUAGE)) != 0) {
         for (tok = stok(sclone(accept), ",", &nextTok); tok; tok = stok(nextTok, ",", &nextTok)) {
             language = stok(tok, ";q=", &quality);
             if (quality == 0) {
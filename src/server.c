@@ -9,6 +9,7 @@
             --home path             # Set the home working directory
             --log logFile:level     # Log to file file at verbosity level
             --name uniqueName       # Name for this instance
+            --prefork count         # Run count worker processes
             --show                  # Show route table
             --trace traceFile:level # Log to file file at verbosity level
             --version               # Output version information
@@ -31,6 +32,7 @@ typedef struct App {
     cchar       *home;
     cchar       *configFile;
     cchar       *pathVar;
+    int         prefork;
     int         show;
 } App;
 
@@ -50,7 +52,7 @@ MAIN(http, int argc, char **argv, char **envp)
     Mpr     *mpr;
     cchar   *argp;
     char    *logSpec, *traceSpec;
-    int     argind;
+    int     argind, workers;
 
     logSpec = 0;
     traceSpec = 0;
@@ -69,6 +71,7 @@ MAIN(http, int argc, char **argv, char **envp)
     }
     app->mpr = mpr;
     app->home = mprGetCurrentPath();
+    app->prefork = -1;
     argc = mpr->argc;
     argv = (char**) mpr->argv;
 
@@ -98,6 +101,12 @@ MAIN(http, int argc, char **argv, char **envp)
             }
             mprSetAppName(argv[++argind], 0, 0);
 
+        } else if (smatch(argp, "--prefork")) {
+            if (argind >= argc) {
+                usageError();
+            }
+            app->prefork = (int) stoi(argv[++argind]);
+
         } else if (smatch(argp, "--show") || smatch(argp, "-s")) {
             app->show = 1;
 
@@ -156,11 +165,18 @@ MAIN(http, int argc, char **argv, char **envp)
     if (createEndpoints(argc - argind, &argv[argind]) < 0) {
         return MPR_ERR_CANT_INITIALIZE;
     }
-    if (httpStartEndpoints() < 0) {
+    /*
+        In prefork mode, this process supervises the workers and the workers listen on the endpoints
+     */
+    if ((workers = httpPrefork(app->prefork >= 0 ? app->prefork : HTTP->prefork)) < 0) {
+        mprLog("error http", 0, "Cannot start worker processes, exiting.");
+        exit(6);
+    }
+    if (workers == 0 && httpStartEndpoints() < 0) {
         mprLog("error http", 0, "Cannot start HTTP service, exiting.");
         exit(6);
     }
-    if (app->show) {
+    if (app->show && !HTTP->preforkWorker) {
         httpLogRoutes(0, 0);
     }
     mprServiceEvents(-1, 0);
@@ -234,6 +250,7 @@ static void usageError()
         "    --debugger              # Disable timeouts to make debugging easier\n"
         "    --log logFile:level     # Log to file at verbosity level (0-5)\n"
         "    --name uniqueName       # Unique name for this instance\n"
+        "    --prefork count         # Run count worker processes\n"
         "    --show                  # Show route table\n"
         "    --trace traceFile:level # Trace to file at verbosity level (0-5)\n"
         "    --verbose               # Same as --log stderr:2\n"
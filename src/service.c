@@ -55,6 +55,7 @@ PUBLIC HttpStatusCode HttpStatusCodes[] = {
     { 415, "415", "Unsupported Media Type" },
     { 416, "416", "Requested Range Not Satisfiable" },
     { 417, "417", "Expectation Failed" },
+    { 429, "429", "Too Many Requests" },
     { 500, "500", "Internal Server Error" },
     { 501, "501", "Not Implemented" },
     { 502, "502", "Bad Gateway" },
@@ -71,13 +72,46 @@ PUBLIC HttpStatusCode HttpStatusCodes[] = {
     { 0,   0 }
 };
 
+/*
+    Environment variable identifying a prefork worker process. Value is the worker index (1-based).
+ */
+#define PREFORK_ENV         "HTTP_PREFORK_WORKER"
+#define PREFORK_MIN_LIFE    1000            /* Workers exiting sooner than this are failing to start */
+#define PREFORK_MAX_FAILS   5               /* Consecutive failed starts before the master gives up */
+#define PREFORK_WATCH       2000            /* Period for workers to check the master is alive */
+
+/*
+    Prefork worker process supervised by the master
+ */
+typedef struct PreforkWorker {
+    MprCmd      *cmd;                       /* Command running the worker process */
+    MprTicks    started;                    /* When the worker was started */
+    int         index;                      /* Worker index (0-based) */
+    int         failures;                   /* Consecutive failed starts */
+} PreforkWorker;
+
 /****************************** Forward Declarations **************************/
 
+static MprTicks addTimeout(MprTicks when, MprTicks timeout);
+static bool checkNetTimeouts(Http *http, HttpNet *net, MprEvent *event);
+static void expireNetTimeouts(Http *http, MprEvent *event);
+static void fileNetTimeout(Http *http, HttpNet *net, MprTicks deadline);
+static MprTicks getNetDeadline(HttpNet *net);
+static MprTicks getStreamDeadline(HttpStream *stream);
 static void httpTimer(Http *http, MprEvent *event);
 static bool isHttpServiceIdle(bool traceRequests);
 static void manageHttp(Http *http, int flags);
+static void managePreforkWorker(PreforkWorker *worker, int flags);
+static void preforkWorkerExit(MprCmd *cmd, int channel, PreforkWorker *worker);
+static void respawnPreforkWorker(PreforkWorker *worker, MprEvent *event);
+static void restartNextPreforkWorker(Http *http);
+static void restartPreforkWorkers(Http *http, MprSignal *sp);
+static int startPreforkWorker(PreforkWorker *worker);
+static void stopPreforkWorkers(Http *http);
 static void terminateHttp(int state, int how, int status);
+static void unlinkNetTimeout(Http *http, HttpNet *net);
 static void updateCurrentDate(void);
+static void watchPreforkMaster(Http *http, MprEvent *event);
 
 /*********************************** Code *************************************/
 
@@ -105,6 +139,7 @@ PUBLIC Http *httpCreate(int flags)
     http->authStores = mprCreateHash(-1, MPR_HASH_CASELESS | MPR_HASH_UNIQUE | MPR_HASH_STABLE);
     http->routeSets = mprCreateHash(-1, MPR_HASH_STATIC_VALUES | MPR_HASH_STABLE);
     http->booted = mprGetTime();
+    http->timeoutTick = mprGetTicks() / HTTP_TIMER_PERIOD;
     http->flags = flags;
     http->monitorPeriod = ME_HTTP_MONITOR_PERIOD;
     http->secret = mprGetRandomString(HTTP_MAX_SECRET);
@@ -112,6 +147,9 @@ PUBLIC Http *httpCreate(int flags)
     http->startLevel = 2;
     http->localPlatform = slower(sfmt("%s-%s-%s", ME_OS, ME_CPU, ME_PROFILE));
     http->upload = 1;
+    http->preforkRestart = -1;
+    http->sharedClients = ME_HTTP_SHARED_CLIENTS;
+    http->sharedFd = -1;
     httpSetPlatform(http->localPlatform);
     httpSetPlatformDir(NULL);
 
@@ -120,6 +158,7 @@ PUBLIC Http *httpCreate(int flags)
     for (code = HttpStatusCodes; code->code; code++) {
         mprAddKey(http->statusCodes, code->codeString, code);
     }
+    httpInitHeaders();
     httpGetUserGroup();
     httpInitParser();
     httpInitAuth();
@@ -146,7 +185,7 @@ PUBLIC Http *httpCreate(int flags)
         http->routeConditions = mprCreateHash(-1, MPR_HASH_STATIC_VALUES | MPR_HASH_STABLE);
         http->routeUpdates = mprCreateHash(-1, MPR_HASH_STATIC_VALUES | MPR_HASH_STABLE);
         http->sessionCache = mprCreateCache(MPR_CACHE_SHARED | MPR_HASH_STABLE);
-        http->addresses = mprCreateHash(-1, MPR_HASH_STABLE);
+        http->addresses = httpCreateAddresses(ME_MAX_CLIENTS_HASH);
         http->defenses = mprCreateHash(-1, MPR_HASH_STABLE);
         http->remedies = mprCreateHash(-1, MPR_HASH_CASELESS | MPR_HASH_STATIC_VALUES | MPR_HASH_STABLE);
         httpOpenUploadFilter();
@@ -186,12 +225,15 @@ static void manageHttp(Http *http, int flags)
         mprMark(http->clientLimits);
         mprMark(http->clientRoute);
         mprMark(http->networks);
+        mprMark(http->connectionRate);
         mprMark(http->context);
         mprMark(http->counters);
         mprMark(http->currentDate);
+        mprMark(http->dateHeader);
         mprMark(http->dateCache);
         mprMark(http->defaultClientHost);
         mprMark(http->defenses);
+        mprMark(http->diskCache);
         mprMark(http->endpoints);
         mprMark(http->forkData);
         mprMark(http->group);
@@ -203,8 +245,12 @@ static void manageHttp(Http *http, int flags)
         mprMark(http->parsers);
         mprMark(http->platform);
         mprMark(http->platformDir);
+        mprMark(http->preforkTimer);
+        mprMark(http->preforkWorkers);
+        mprMark(http->sharedPath);
         mprMark(http->proxyHost);
         mprMark(http->remedies);
+        mprMark(http->requestRate);
         mprMark(http->routeConditions);
         mprMark(http->routeSets);
         mprMark(http->routeTargets);
@@ -216,6 +262,7 @@ static void manageHttp(Http *http, int flags)
         mprMark(http->stages);
         mprMark(http->staticHeaders);
         mprMark(http->statusCodes);
+        mprMark(http->headerIds);
         mprMark(http->timer);
         mprMark(http->timestamp);
         mprMark(http->trace);
@@ -248,6 +295,12 @@ PUBLIC int httpStartEndpoints()
     if (!HTTP) {
         return MPR_ERR_BAD_STATE;
     }
+    if (HTTP->sharedPath && !HTTP->shared) {
+        /*
+            Prefork workers attach to the segment created by the master. Otherwise monitor without sharing.
+         */
+        httpOpenSharedCounters(HTTP->sharedPath, HTTP->sharedClients, !HTTP->preforkWorker);
+    }
     for (ITERATE_ITEMS(HTTP->endpoints, endpoint, next)) {
         if (httpStartEndpoint(endpoint) < 0) {
             return MPR_ERR_CANT_OPEN;
@@ -278,6 +331,236 @@ PUBLIC void httpStopEndpoints()
 }
 
 
+/*
+    Start prefork worker processes. Workers re-execute the application and are identified via PREFORK_ENV.
+ */
+PUBLIC int httpPrefork(int count)
+{
+    Http            *http;
+    PreforkWorker   *worker;
+    cchar           *index;
+    int             i;
+
+    if ((http = HTTP) == 0) {
+        return MPR_ERR_BAD_STATE;
+    }
+    if ((index = getenv(PREFORK_ENV)) != 0) {
+        http->preforkWorker = (int) stoi(index);
+#if ME_UNIX_LIKE
+        /*
+            Don't leak into CGI and other child processes
+         */
+        unsetenv(PREFORK_ENV);
+        http->preforkParent = getppid();
+        http->preforkTimer = mprCreateTimerEvent(NULL, "preforkWatch", PREFORK_WATCH, watchPreforkMaster, http,
+            MPR_EVENT_QUICK);
+#endif
+        return 0;
+    }
+    if (count <= 0) {
+        return 0;
+    }
+#if ME_UNIX_LIKE
+    /*
+        Create the shared counters before the workers so they can attach and the master can monitor all clients
+     */
+    if (http->sharedPath && httpOpenSharedCounters(http->sharedPath, http->sharedClients, 1) < 0) {
+        return MPR_ERR_CANT_CREATE;
+    }
+    http->prefork = count;
+    http->preforkWorkers = mprCreateList(count, MPR_LIST_STABLE);
+    for (i = 0; i < count; i++) {
+        if ((worker = mprAllocObj(PreforkWorker, managePreforkWorker)) == 0) {
+            return MPR_ERR_MEMORY;
+        }
+        worker->index = i;
+        mprAddItem(http->preforkWorkers, worker);
+        if (startPreforkWorker(worker) < 0) {
+            stopPreforkWorkers(http);
+            return MPR_ERR_CANT_CREATE;
+        }
+    }
+    mprAddSignalHandler(SIGHUP, restartPreforkWorkers, http, NULL, MPR_SIGNAL_AFTER);
+    mprLog("info http", HTTP->startLevel, "Started %d prefork worker processes", count);
+    return count;
+#else
+    mprLog("error http", 0, "Prefork worker processes are not supported on this platform");
+    return MPR_ERR_BAD_STATE;
+#endif
+}
+
+
+static void managePreforkWorker(PreforkWorker *worker, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(worker->cmd);
+    }
+}
+
+
+static int startPreforkWorker(PreforkWorker *worker)
+{
+    cchar   **argv, *env[2];
+    int     argc, i;
+
+    argc = MPR->argc;
+    if ((argv = mprAlloc((argc + 1) * sizeof(char*))) == 0) {
+        return MPR_ERR_MEMORY;
+    }
+    argv[0] = mprGetAppPath();
+    for (i = 1; i < argc; i++) {
+        argv[i] = MPR->argv[i];
+    }
+    argv[argc] = 0;
+    env[0] = sfmt("%s=%d", PREFORK_ENV, worker->index + 1);
+    env[1] = 0;
+
+    worker->cmd = mprCreateCmd(NULL);
+    mprSetCmdCallback(worker->cmd, (MprCmdProc) preforkWorkerExit, worker);
+    worker->started = mprGetTicks();
+    if (mprStartCmd(worker->cmd, argc, argv, env, 0) < 0) {
+        mprLog("error http", 0, "Cannot start prefork worker %d", worker->index + 1);
+        mprDestroyCmd(worker->cmd);
+        worker->cmd = 0;
+        return MPR_ERR_CANT_CREATE;
+    }
+    return 0;
+}
+
+
+/*
+    Start a replacement worker process. If the process cannot be started, no exit will be reaped for it, so count
+    the failure here and retry after a delay.
+ */
+static void respawnPreforkWorker(PreforkWorker *worker, MprEvent *event)
+{
+    if (mprIsStopping() || worker->cmd) {
+        return;
+    }
+    if (startPreforkWorker(worker) < 0) {
+        if (++worker->failures >= PREFORK_MAX_FAILS) {
+            mprLog("error http", 0, "Prefork worker %d cannot start, exiting", worker->index + 1);
+            mprShutdown(MPR_EXIT_NORMAL, 1, 0);
+            return;
+        }
+        mprCreateEvent(NULL, "preforkRespawn", PREFORK_MIN_LIFE, respawnPreforkWorker, worker, 0);
+    }
+}
+
+
+/*
+    Respawn worker processes when they exit. Workers failing to start are retried after a delay.
+    Runs on the MPR dispatcher when the child is reaped.
+ */
+static void preforkWorkerExit(MprCmd *cmd, int channel, PreforkWorker *worker)
+{
+    Http        *http;
+    MprTicks    delay;
+
+    http = HTTP;
+    if (channel >= 0 || mprIsCmdRunning(cmd) || cmd != worker->cmd || mprIsStopping()) {
+        return;
+    }
+    delay = 0;
+    if (worker->index == http->preforkRestart) {
+        mprLog("info http", 2, "Restarting prefork worker %d", worker->index + 1);
+        worker->failures = 0;
+
+    } else if (mprGetElapsedTicks(worker->started) < PREFORK_MIN_LIFE) {
+        if (++worker->failures >= PREFORK_MAX_FAILS) {
+            mprLog("error http", 0, "Prefork worker %d cannot start, exiting", worker->index + 1);
+            mprShutdown(MPR_EXIT_NORMAL, 1, 0);
+            return;
+        }
+        delay = PREFORK_MIN_LIFE;
+
+    } else {
+        mprLog("error http", 0, "Prefork worker %d exited with status %d, respawning", worker->index + 1,
+            mprGetCmdExitStatus(cmd));
+        worker->failures = 0;
+    }
+    http->preforkRespawns++;
+    worker->cmd = 0;
+    if (delay) {
+        mprCreateEvent(NULL, "preforkRespawn", delay, respawnPreforkWorker, worker, 0);
+    } else {
+        respawnPreforkWorker(worker, NULL);
+    }
+    if (worker->index == http->preforkRestart) {
+        /*
+            Rolling restart. Stop the next worker only once this one is replaced so capacity is retained.
+         */
+        http->preforkRestart++;
+        restartNextPreforkWorker(http);
+    }
+}
+
+
+/*
+    Stop the next worker of a rolling restart. Workers waiting to be respawned have no process and are skipped
+    as they will start afresh.
+ */
+static void restartNextPreforkWorker(Http *http)
+{
+    PreforkWorker   *worker;
+
+    for (; http->preforkRestart < mprGetListLength(http->preforkWorkers); http->preforkRestart++) {
+        worker = mprGetItem(http->preforkWorkers, http->preforkRestart);
+        if (worker->cmd && mprIsCmdRunning(worker->cmd)) {
+            mprStopCmd(worker->cmd, SIGTERM);
+            return;
+        }
+    }
+    http->preforkRestart = -1;
+    mprLog("info http", 2, "Prefork workers restarted");
+}
+
+
+/*
+    SIGHUP handler for the master. Gracefully restart workers one at a time.
+ */
+static void restartPreforkWorkers(Http *http, MprSignal *sp)
+{
+    if (http->preforkRestart >= 0 || mprGetListLength(http->preforkWorkers) == 0) {
+        return;
+    }
+    http->preforkRestart = 0;
+    restartNextPreforkWorker(http);
+}
+
+
+/*
+    Forward a shutdown to the workers. Each worker exits when its requests complete.
+ */
+static void stopPreforkWorkers(Http *http)
+{
+    PreforkWorker   *worker;
+    int             next;
+
+    for (ITERATE_ITEMS(http->preforkWorkers, worker, next)) {
+        if (worker->cmd && mprIsCmdRunning(worker->cmd)) {
+            mprStopCmd(worker->cmd, SIGTERM);
+        }
+    }
+}
+
+
+/*
+    Workers exit if the master exits without stopping them (e.g. abortive exit)
+ */
+static void watchPreforkMaster(Http *http, MprEvent *event)
+{
+#if ME_UNIX_LIKE
+    if (getppid() != http->preforkParent) {
+        mprLog("error http", 0, "Prefork master exited, stopping worker %d", http->preforkWorker);
+        mprRemoveEvent(event);
+        http->preforkTimer = 0;
+        mprShutdown(MPR_EXIT_NORMAL, 0, MPR_EXIT_TIMEOUT);
+    }
+#endif
+}
+
+
 /*
     Called to close all networks owned by a service (e.g. ejs)
  */
@@ -313,6 +596,7 @@ PUBLIC void httpDestroy()
     }
     httpStopNetworks(0);
     httpStopEndpoints();
+    httpCloseSharedCounters();
     httpSetDefaultHost(0);
 
     if (http->timer) {
@@ -335,6 +619,16 @@ PUBLIC void httpDestroy()
  */
 static void terminateHttp(int state, int how, int status)
 {
+    if (state == MPR_STOPPING && HTTP) {
+        if (HTTP->preforkWorkers) {
+            stopPreforkWorkers(HTTP);
+        } else if (HTTP->preforkWorker) {
+            /*
+                Stop listening so the kernel directs new connections to the other workers
+             */
+            httpStopEndpoints();
+        }
+    }
     if (state >= MPR_STOPPED) {
         httpDestroy();
     }
@@ -454,7 +748,9 @@ PUBLIC HttpHost *httpLookupHost(cchar *name)
 PUBLIC void httpInitLimits(HttpLimits *limits, bool serverSide)
 {
     memset(limits, 0, sizeof(HttpLimits));
+    limits->arenaSize = ME_MAX_ARENA;
     limits->cacheItemSize = ME_MAX_CACHE_ITEM;
+    limits->cacheVariants = ME_MAX_CACHE_VARIANTS;
     limits->chunkSize = ME_MAX_CHUNK;
     limits->clientMax = ME_MAX_CLIENTS;
     limits->connectionsMax = ME_MAX_CONNECTIONS;
@@ -463,6 +759,7 @@ PUBLIC void httpInitLimits(HttpLimits *limits, bool serverSide)
     limits->keepAliveMax = ME_MAX_KEEP_ALIVE;
     limits->packetSize = ME_PACKET_SIZE;
     limits->processMax = ME_MAX_PROCESSES;
+    limits->rangesMax = ME_MAX_RANGES;
     limits->requestsPerClientMax = ME_MAX_REQUESTS_PER_CLIENT;
     limits->sessionMax = ME_MAX_SESSIONS;
     limits->uriSize = ME_MAX_URI;
@@ -592,67 +889,36 @@ PUBLIC void httpSetListenCallback(HttpListenCallback fn)
 /*
     The http timer does maintenance activities and will fire per second while there are active requests.
     This routine will also be called by httpTerminate with event == 0 to signify a shutdown.
+    Request timeouts are found via the timeout wheel so each tick only examines networks that may have expired.
+    When stopping, all networks are examined.
     NOTE: Because we lock the http here, streams cannot be deleted while we are modifying the list.
  */
 static void httpTimer(Http *http, MprEvent *event)
 {
     HttpNet     *net;
-    HttpStream  *stream;
     HttpStage   *stage;
-    HttpLimits  *limits;
     MprModule   *module;
-    int         next, active, abort, nextConn;
-
-    active = 0;
+    int         next, active;
 
     updateCurrentDate();
     lock(http->networks);
 
     if (!mprGetDebugMode()) {
-        for (next = 0; (net = mprGetNextItem(http->networks, &next)) != 0; active++) {
-            /*
-               Check for any inactive streams or expired requests (inactivityTimeout and requestTimeout)
-             */
-            for (active = 0, nextConn = 0; (stream = mprGetNextItem(net->streams, &nextConn)) != 0; active++) {
-                limits = stream->limits;
-                abort = mprIsStopping();
-                if (httpServerStream(stream) && (HTTP_STATE_CONNECTED < stream->state && stream->state < HTTP_STATE_PARSED) &&
-                        (http->now - stream->started) > limits->requestParseTimeout) {
-                    stream->timeout = HTTP_PARSE_TIMEOUT;
-                    abort = 1;
-                } else if ((http->now - stream->lastActivity) > limits->inactivityTimeout) {
-                    stream->timeout = HTTP_INACTIVITY_TIMEOUT;
-                    abort = 1;
-                } else if ((http->now - stream->started) > limits->requestTimeout) {
-                    stream->timeout = HTTP_REQUEST_TIMEOUT;
-                    abort = 1;
-                } else if (!event) {
-                    /* Called directly from httpStop to stop streams */
-                    if (MPR->exitTimeout > 0) {
-                        if (stream->state == HTTP_STATE_COMPLETE ||
-                            (HTTP_STATE_CONNECTED < stream->state && stream->state < HTTP_STATE_PARSED)) {
-                            abort = 1;
-                        }
-                    } else {
-                        abort = 1;
-                    }
-                }
-                if (abort) {
-                    httpStreamTimeout(stream);
-                }
-            }
-            if ((http->now - net->lastActivity) > net->limits->inactivityTimeout) {
-                net->timeout = HTTP_INACTIVITY_TIMEOUT;
-                httpNetTimeout(net);
+        if (!event || mprIsStopping()) {
+            for (next = 0; (net = mprGetNextItem(http->networks, &next)) != 0; ) {
+                checkNetTimeouts(http, net, event);
             }
+        } else {
+            expireNetTimeouts(http, event);
         }
     }
+    active = mprGetListLength(http->networks);
 
     /*
         Check for unloadable modules
         OPT - could check for modules every minute
      */
-    if (mprGetListLength(http->networks) == 0) {
+    if (active == 0) {
         for (next = 0; (module = mprGetNextItem(MPR->moduleService->modules, &next)) != 0; ) {
             if (module->timeout) {
                 if (module->lastActivity + module->timeout < http->now) {
@@ -690,6 +956,209 @@ static void httpTimer(Http *http, MprEvent *event)
 }
 
 
+/*
+    Check for any inactive streams or expired requests (requestParseTimeout, inactivityTimeout and requestTimeout).
+    Returns true if the network or any of its streams has timed out.
+ */
+static bool checkNetTimeouts(Http *http, HttpNet *net, MprEvent *event)
+{
+    HttpStream  *stream;
+    HttpLimits  *limits;
+    int         next, abort, expired;
+
+    expired = 0;
+    for (next = 0; (stream = mprGetNextItem(net->streams, &next)) != 0; ) {
+        limits = stream->limits;
+        abort = mprIsStopping();
+        if (httpServerStream(stream) && (HTTP_STATE_CONNECTED < stream->state && stream->state < HTTP_STATE_PARSED) &&
+                (http->now - stream->started) > limits->requestParseTimeout) {
+            stream->timeout = HTTP_PARSE_TIMEOUT;
+            abort = 1;
+        } else if ((http->now - stream->lastActivity) > limits->inactivityTimeout) {
+            stream->timeout = HTTP_INACTIVITY_TIMEOUT;
+            abort = 1;
+        } else if ((http->now - stream->started) > limits->requestTimeout) {
+            stream->timeout = HTTP_REQUEST_TIMEOUT;
+            abort = 1;
+        } else if (!event) {
+            /* Called directly from httpStop to stop streams */
+            if (MPR->exitTimeout > 0) {
+                if (stream->state == HTTP_STATE_COMPLETE ||
+                    (HTTP_STATE_CONNECTED < stream->state && stream->state < HTTP_STATE_PARSED)) {
+                    abort = 1;
+                }
+            } else {
+                abort = 1;
+            }
+        }
+        if (abort) {
+            httpStreamTimeout(stream);
+            expired = 1;
+        }
+    }
+    if ((http->now - net->lastActivity) > net->limits->inactivityTimeout) {
+        net->timeout = HTTP_INACTIVITY_TIMEOUT;
+        httpNetTimeout(net);
+        expired = 1;
+    }
+    return expired;
+}
+
+
+/*
+    Examine the networks in the timeout wheel slots that have come due since the last tick. Activity only moves
+    deadlines later, so networks that have not expired are re-filed at their recomputed deadline. Expired networks
+    are re-examined on the next tick until they are closed, as before. Must be called locked.
+ */
+static void expireNetTimeouts(Http *http, MprEvent *event)
+{
+    HttpNet     *net, *nextNet;
+    int64       tick, last;
+    int         slot;
+
+    /*
+        The timer does not run on period boundaries, so include the current period. Networks not yet expired are
+        re-filed for the next tick.
+     */
+    last = http->now / HTTP_TIMER_PERIOD + 1;
+    tick = max(http->timeoutTick, last - HTTP_TIMER_SLOTS);
+    http->timeoutTick = last;
+
+    while (tick < last) {
+        slot = (int) (++tick % HTTP_TIMER_SLOTS);
+        nextNet = http->timeouts[slot];
+        http->timeouts[slot] = 0;
+        while ((net = nextNet) != 0) {
+            nextNet = net->timeoutNext;
+            net->timeoutNext = net->timeoutPrev = 0;
+            net->timeoutSlot = 0;
+            if (checkNetTimeouts(http, net, event)) {
+                fileNetTimeout(http, net, http->now);
+            } else {
+                fileNetTimeout(http, net, getNetDeadline(net));
+            }
+        }
+    }
+}
+
+
+/*
+    File a network in the timeout wheel slot for its deadline. Deadlines beyond the wheel are filed in the furthest
+    slot and re-filed when reached. Must be called locked.
+ */
+static void fileNetTimeout(Http *http, HttpNet *net, MprTicks deadline)
+{
+    HttpNet     **head;
+    int64       tick;
+    int         slot;
+
+    if (net->timeoutSlot) {
+        unlinkNetTimeout(http, net);
+    }
+    net->deadline = deadline;
+    tick = deadline / HTTP_TIMER_PERIOD + ((deadline % HTTP_TIMER_PERIOD) ? 1 : 0);
+    tick = max(tick, http->timeoutTick + 1);
+    tick = min(tick, http->timeoutTick + HTTP_TIMER_SLOTS);
+    slot = (int) (tick % HTTP_TIMER_SLOTS);
+
+    head = &http->timeouts[slot];
+    net->timeoutPrev = 0;
+    net->timeoutNext = *head;
+    if (*head) {
+        (*head)->timeoutPrev = net;
+    }
+    *head = net;
+    net->timeoutSlot = slot + 1;
+}
+
+
+static void unlinkNetTimeout(Http *http, HttpNet *net)
+{
+    if (net->timeoutPrev) {
+        net->timeoutPrev->timeoutNext = net->timeoutNext;
+    } else {
+        http->timeouts[net->timeoutSlot - 1] = net->timeoutNext;
+    }
+    if (net->timeoutNext) {
+        net->timeoutNext->timeoutPrev = net->timeoutPrev;
+    }
+    net->timeoutNext = net->timeoutPrev = 0;
+    net->timeoutSlot = 0;
+}
+
+
+static MprTicks addTimeout(MprTicks when, MprTicks timeout)
+{
+    if (timeout < 0 || timeout >= HTTP_UNLIMITED - when) {
+        return HTTP_UNLIMITED;
+    }
+    return when + timeout;
+}
+
+
+/*
+    Get the earliest deadline for the network and its streams. A server network may start a new request at any time,
+    so it must be examined again within the parse timeout of now.
+ */
+static MprTicks getNetDeadline(HttpNet *net)
+{
+    HttpStream  *stream;
+    MprTicks    deadline;
+    int         next;
+
+    deadline = addTimeout(net->lastActivity, net->limits->inactivityTimeout);
+    if (httpIsServer(net)) {
+        deadline = min(deadline, addTimeout(net->http->now, net->limits->requestParseTimeout));
+    }
+    if (net->streams) {
+        for (next = 0; (stream = mprGetNextItem(net->streams, &next)) != 0; ) {
+            deadline = min(deadline, getStreamDeadline(stream));
+        }
+    }
+    return deadline;
+}
+
+
+static MprTicks getStreamDeadline(HttpStream *stream)
+{
+    HttpLimits  *limits;
+    MprTicks    deadline;
+
+    limits = stream->limits;
+    deadline = min(addTimeout(stream->lastActivity, limits->inactivityTimeout),
+        addTimeout(stream->started, limits->requestTimeout));
+    if (httpServerStream(stream) && (HTTP_STATE_CONNECTED < stream->state && stream->state < HTTP_STATE_PARSED)) {
+        deadline = min(deadline, addTimeout(stream->started, limits->requestParseTimeout));
+    }
+    return deadline;
+}
+
+
+/*
+    Bring forward the network timeout deadline if the stream limits now give an earlier deadline.
+    This is required when a stream is added or its limits change. Later deadlines are found lazily by httpTimer.
+ */
+PUBLIC void httpUpdateDeadline(HttpStream *stream)
+{
+    Http        *http;
+    HttpNet     *net;
+    MprTicks    deadline;
+
+    if ((net = stream->net) == 0 || !net->timeoutSlot) {
+        return;
+    }
+    http = stream->http;
+    deadline = getStreamDeadline(stream);
+    if (deadline < net->deadline) {
+        lock(http->networks);
+        if (net->timeoutSlot && deadline < net->deadline) {
+            fileNetTimeout(http, net, deadline);
+        }
+        unlock(http->networks);
+    }
+}
+
+
 static void timestamp()
 {
     mprLog("info http", 0, "Time: %s", mprGetDate(NULL));
@@ -720,9 +1189,15 @@ PUBLIC void httpAddNet(HttpNet *net)
 
     http = net->http;
 
+    lock(http->networks);
+    if (mprGetListLength(http->networks) == 0) {
+        http->timeoutTick = mprGetTicks() / HTTP_TIMER_PERIOD;
+    }
     mprAddItem(http->networks, net);
     http->now = mprGetTicks();
     updateCurrentDate();
+    fileNetTimeout(http, net, getNetDeadline(net));
+    unlock(http->networks);
 
     lock(http);
     if (!http->timer && (!ME_DEBUG || !mprGetDebugMode())) {
@@ -735,7 +1210,15 @@ PUBLIC void httpAddNet(HttpNet *net)
 
 PUBLIC void httpRemoveNet(HttpNet *net)
 {
-    mprRemoveItem(net->http->networks, net);
+    Http    *http;
+
+    http = net->http;
+    lock(http->networks);
+    if (net->timeoutSlot) {
+        unlinkNetTimeout(http, net);
+    }
+    mprRemoveItem(http->networks, net);
+    unlock(http->networks);
 }
 
 
@@ -804,17 +1287,18 @@ PUBLIC void httpSetProxy(cchar *host, int port)
 static void updateCurrentDate()
 {
     Http        *http;
-    MprTicks    diff;
+    MprTime     now;
 
     http = HTTP;
     http->now = mprGetTicks();
-    diff = http->now - http->currentTime;
-    if (diff <= TPS || diff >= TPS) {
+    now = mprGetTime();
+    if (now / TPS != http->currentTime / TPS || !http->currentDate) {
         /*
-            Optimize and only update the string date representation once per second
+            Optimize and only update the string date representation and serialized Date header once per second
          */
-        http->currentTime = http->now;
+        http->currentTime = now;
         http->currentDate = httpGetDateString(NULL);
+        http->dateHeader = sjoin("Date: ", http->currentDate, "\r\n", NULL);
     }
 }
 
@@ -823,10 +1307,11 @@ PUBLIC void httpGetStats(HttpStats *sp)
 {
     Http                *http;
     HttpAddress         *address;
-    MprKey              *kp;
     MprMemStats         *ap;
     MprWorkerStats      wstats;
+    PreforkWorker       *worker;
     ssize               memSessions;
+    int                 next;
 
     memset(sp, 0, sizeof(*sp));
     http = HTTP;
@@ -850,6 +1335,17 @@ PUBLIC void httpGetStats(HttpStats *sp)
     sp->workersIdle = wstats.idle;
     sp->workersYielded = wstats.yielded;
     sp->workersMax = wstats.max;
+    sp->workersQueued = wstats.queued;
+    sp->workersMaxQueued = wstats.maxQueued;
+    sp->workersQueueWait = wstats.queueWait;
+    sp->workersQueueWaitMax = wstats.queueWaitMax;
+    sp->workersTotalQueued = wstats.totalQueued;
+    sp->workersRejected = wstats.rejected;
+
+    for (ITERATE_ITEMS(http->preforkWorkers, worker, next)) {
+        sp->preforkWorkers += (worker->cmd && mprIsCmdRunning(worker->cmd)) ? 1 : 0;
+    }
+    sp->preforkRespawns = http->preforkRespawns;
 
     sp->activeConnections = mprGetListLength(http->networks);
     sp->activeProcesses = http->activeProcesses;
@@ -857,16 +1353,21 @@ PUBLIC void httpGetStats(HttpStats *sp)
     mprGetCacheStats(http->sessionCache, &sp->activeSessions, &memSessions);
     sp->memSessions = memSessions;
 
-    lock(http->addresses);
-    for (ITERATE_KEY_DATA(http->addresses, kp, address)) {
+    for (address = 0; (address = httpGetNextAddress(address)) != 0; ) {
         sp->activeRequests += (int) address->counters[HTTP_COUNTER_ACTIVE_REQUESTS].value;
-        sp->activeClients++;
     }
-    unlock(http->addresses);
+    sp->activeClients = httpGetAddressCount();
 
     sp->totalRequests = http->totalRequests;
     sp->totalConnections = http->totalConnections;
     sp->totalSweeps = MPR->heap->stats.sweeps;
+    sp->gcPauses = ap->gcPauses;
+    sp->gcPauseTotal = ap->gcPauseTotal;
+    sp->gcPauseMax = ap->gcPauseMax;
+    memcpy(sp->gcPauseHistogram, ap->gcPauseHistogram, sizeof(sp->gcPauseHistogram));
+    sp->routeCacheHits = http->routeCacheHits;
+    sp->routeCacheMisses = http->routeCacheMisses;
+    httpGetFileReadStats(sp);
 }
 
 
@@ -879,6 +1380,7 @@ PUBLIC char *httpStatsReport(int flags)
     static MprTime      lastTime;
     static HttpStats    last;
     double              mb;
+    int                 i;
 
     mb = 1024.0 * 1024;
     now = mprGetTime();
@@ -906,6 +1408,32 @@ PUBLIC char *httpStatsReport(int flags)
     mprPutToBuf(buf, "Connections  %8.1f per/sec\n", (s.totalConnections - last.totalConnections) / elapsed);
     mprPutToBuf(buf, "Requests     %8.1f per/sec\n", (s.totalRequests - last.totalRequests) / elapsed);
     mprPutToBuf(buf, "Sweeps       %8.1f per/sec\n", (s.totalSweeps - last.totalSweeps) / elapsed);
+    if (s.gcPauses > last.gcPauses) {
+        mprPutToBuf(buf, "GC-pauses    %8.1f usec avg, %lld usec max\n",
+            (s.gcPauseTotal - last.gcPauseTotal) / (double) (s.gcPauses - last.gcPauses), (int64) s.gcPauseMax);
+        mprPutToBuf(buf, "Pause-times ");
+        for (i = 0; i < MPR_GC_PAUSE_BUCKETS; i++) {
+            if (s.gcPauseHistogram[i] > last.gcPauseHistogram[i]) {
+                mprPutToBuf(buf, " %s%dus %lld", i < MPR_GC_PAUSE_BUCKETS - 1 ? "<" : ">=",
+                    128 << min(i, MPR_GC_PAUSE_BUCKETS - 2), s.gcPauseHistogram[i] - last.gcPauseHistogram[i]);
+            }
+        }
+        mprPutCharToBuf(buf, '\n');
+    }
+    if (s.routeCacheHits + s.routeCacheMisses > last.routeCacheHits + last.routeCacheMisses) {
+        mprPutToBuf(buf, "Route-cache  %8.1f%% hits\n", (s.routeCacheHits - last.routeCacheHits) * 100.0 /
+            (s.routeCacheHits + s.routeCacheMisses - last.routeCacheHits - last.routeCacheMisses));
+    }
+    if (s.fileReads) {
+        mprPutToBuf(buf, "File-reads   %8.1f per/sec\n", (s.fileReads - last.fileReads) / elapsed);
+        mprPutToBuf(buf, "Read-latency");
+        for (i = 0; i < HTTP_READ_LATENCY_BUCKETS; i++) {
+            if (s.fileReadLatency[i]) {
+                mprPutToBuf(buf, " <%dms %lld", 1 << i, s.fileReadLatency[i]);
+            }
+        }
+        mprPutCharToBuf(buf, '\n');
+    }
     mprPutCharToBuf(buf, '\n');
 
     mprPutToBuf(buf, "Clients      %8d active\n", s.activeClients);
@@ -915,6 +1443,12 @@ PUBLIC char *httpStatsReport(int flags)
     mprPutToBuf(buf, "Sessions     %8d active\n", s.activeSessions);
     mprPutToBuf(buf, "Workers      %8d busy - %d yielded, %d idle, %d max\n",
         s.workersBusy, s.workersYielded, s.workersIdle, s.workersMax);
+    mprPutToBuf(buf, "Worker Queue %8d queued - %d max, %lld total, %lld rejected, %d msec wait, %d msec max wait\n",
+        s.workersQueued, s.workersMaxQueued, s.workersTotalQueued, s.workersRejected, s.workersQueueWait,
+        s.workersQueueWaitMax);
+    if (s.preforkWorkers) {
+        mprPutToBuf(buf, "Prefork      %8d workers - %lld respawns\n", s.preforkWorkers, s.preforkRespawns);
+    }
     mprPutToBuf(buf, "Sessions     %8.1f MB\n", s.memSessions / mb);
     mprPutCharToBuf(buf, '\n');
 
@@ -168,6 +168,7 @@ static void manageStream(HttpStream *stream, int flags)
     assert(stream);
 
     if (flags & MPR_MANAGE_MARK) {
+        mprMark(stream->arena);
         mprMark(stream->authType);
         mprMark(stream->authData);
         mprMark(stream->boundary);
@@ -234,6 +235,10 @@ PUBLIC void httpResetServerStream(HttpStream *stream)
     stream->user = 0;
     stream->authData = 0;
     stream->encoded = 0;
+    if (stream->arena) {
+        /* Recycle request scoped memory. The prior rx and tx must not be referenced beyond this point */
+        mprResetArena(stream->arena);
+    }
     stream->rx = httpCreateRx(stream);
     stream->tx = httpCreateTx(stream, NULL);
     commonPrep(stream);
@@ -241,6 +246,43 @@ PUBLIC void httpResetServerStream(HttpStream *stream)
 }
 
 
+/*
+    Request arenas are used only for server streams. Client applications commonly retain response values
+    across requests.
+ */
+PUBLIC void *httpArenaAlloc(HttpStream *stream, ssize size)
+{
+    if (!stream->arena) {
+        if (stream->limits->arenaSize <= 0 || !httpServerStream(stream)) {
+            return mprAlloc(size);
+        }
+        stream->arena = mprCreateArena(stream->limits->arenaSize);
+    }
+    return mprArenaAlloc(stream->arena, size);
+}
+
+
+PUBLIC char *httpArenaClone(HttpStream *stream, cchar *str)
+{
+    if (!stream->arena) {
+        if (stream->limits->arenaSize <= 0 || !httpServerStream(stream)) {
+            return sclone(str);
+        }
+        stream->arena = mprCreateArena(stream->limits->arenaSize);
+    }
+    return mprArenaClone(stream->arena, str);
+}
+
+
+PUBLIC void *httpPromote(HttpStream *stream, cvoid *ptr)
+{
+    if (stream->arena) {
+        return mprArenaPromote(stream->arena, ptr);
+    }
+    return (void*) ptr;
+}
+
+
 PUBLIC void httpResetClientStream(HttpStream *stream, bool keepHeaders)
 {
     MprHash     *headers;
@@ -580,6 +622,7 @@ PUBLIC void httpSetTimeout(HttpStream *stream, MprTicks requestTimeout, MprTicks
             stream->net->limits->inactivityTimeout = inactivityTimeout;
         }
     }
+    httpUpdateDeadline(stream);
 }
 
 
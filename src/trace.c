@@ -448,7 +448,7 @@ PUBLIC void httpCommonFormatter(HttpTrace *trace, cchar *type, cchar *event, int
                 switch (*fmt++) {
                 case 'i':
                     sncopy(keyBuf, sizeof(keyBuf), qualifier, cp - qualifier);
-                    value = (char*) mprLookupKey(rx->headers, keyBuf);
+                    value = (char*) httpGetHeader(stream, keyBuf);
                     mprPutStringToBuf(buf, value ? value : "-");
                     break;
                 default:
@@ -9,6 +9,9 @@
 
 /***************************** Forward Declarations ***************************/
 
+static HttpHeaderPrefix *createHeaderPrefix(HttpStream *stream);
+static HttpHeaderPrefix *getHeaderPrefix(HttpStream *stream);
+static void manageHeaderPrefix(HttpHeaderPrefix *prefix, int flags);
 static void manageTx(HttpTx *tx, int flags);
 
 /*********************************** Code *************************************/
@@ -74,6 +77,7 @@ static void manageTx(HttpTx *tx, int flags)
         mprMark(tx->filename);
         mprMark(tx->handler);
         mprMark(tx->headers);
+        mprMark(tx->headerPrefix);
         mprMark(tx->method);
         mprMark(tx->mimeType);
         mprMark(tx->outputPipeline);
@@ -617,7 +621,7 @@ static void setCorsHeaders(HttpStream *stream)
     if (*route->corsOrigin && !route->corsCredentials) {
         httpSetHeaderString(stream, "Access-Control-Allow-Origin", route->corsOrigin);
     } else {
-        origin = httpGetHeader(stream, "Origin");
+        origin = httpGetHeaderById(stream, HTTP_HEADER_ORIGIN);
         httpSetHeaderString(stream, "Access-Control-Allow-Origin", origin ? origin : "*");
     }
     if (route->corsCredentials) {
@@ -678,6 +682,7 @@ PUBLIC void httpPrepareHeaders(HttpStream *stream)
     }
     tx->flags |= HTTP_TX_HEADERS_CREATED;
 
+    tx->headerPrefix = 0;
     if (stream->headersCallback) {
         /* Must be before headers below */
         (stream->headersCallback)(stream->headersCallbackArg);
@@ -693,8 +698,6 @@ PUBLIC void httpPrepareHeaders(HttpStream *stream)
     /*
         Mandatory headers that must be defined here use httpSetHeader which overwrites existing values.
      */
-    httpAddHeaderString(stream, "Date", stream->http->currentDate);
-
     if (tx->ext && route) {
         if (stream->error) {
             tx->mimeType = sclone("text/html");
@@ -744,9 +747,6 @@ PUBLIC void httpPrepareHeaders(HttpStream *stream)
         httpSetHeader(stream, "Accept-Ranges", "bytes");
     }
     if (httpServerStream(stream)) {
-        if (!(route->flags & HTTP_ROUTE_STEALTH)) {
-            httpAddHeaderString(stream, "Server", stream->http->software);
-        }
         if (stream->net->protocol < 2) {
             /*
                 If keepAliveCount == 1
@@ -766,26 +766,158 @@ PUBLIC void httpPrepareHeaders(HttpStream *stream)
         if (route->flags & HTTP_ROUTE_CORS) {
             setCorsHeaders(stream);
         }
+        if (stream->net->protocol < 2 && !httpTracing(stream->net)) {
+            /*
+                The status line, Date, Server and static route headers are emitted from a pre-serialized prefix
+             */
+            tx->headerPrefix = getHeaderPrefix(stream);
+        }
+        if (!tx->headerPrefix) {
+            httpAddHeaderString(stream, "Date", stream->http->currentDate);
+            if (!(route->flags & HTTP_ROUTE_STEALTH)) {
+                httpAddHeaderString(stream, "Server", stream->http->software);
+            }
+        }
         /*
-            Apply route headers
+            Apply route headers unless already included in the header prefix
          */
+        if (!tx->headerPrefix || !tx->headerPrefix->routeHeaders) {
+            for (ITERATE_ITEMS(route->headers, item, next)) {
+                if (item->flags == HTTP_ROUTE_ADD_HEADER) {
+                    value = httpExpandVars(stream, item->value);
+                    httpAddHeaderString(stream, item->key, value);
+
+                } else if (item->flags == HTTP_ROUTE_APPEND_HEADER) {
+                    value = httpExpandVars(stream, item->value);
+                    httpAppendHeaderString(stream, item->key, value);
+
+                } else if (item->flags == HTTP_ROUTE_REMOVE_HEADER) {
+                    httpRemoveHeader(stream, item->key);
+
+                } else if (item->flags == HTTP_ROUTE_SET_HEADER) {
+                    value = httpExpandVars(stream, item->value);
+                    httpSetHeaderString(stream, item->key, value);
+                }
+            }
+        }
+    } else {
+        httpAddHeaderString(stream, "Date", stream->http->currentDate);
+    }
+}
+
+
+/*
+    Return the pre-serialized header prefix for the response protocol, status and route. Prefixes are cached in a
+    small direct-mapped table per route. Returns null if the response already defines a header included in the prefix,
+    in which case the headers are created individually.
+ */
+static HttpHeaderPrefix *getHeaderPrefix(HttpStream *stream)
+{
+    HttpHeaderPrefix    *prefix, **prefixes;
+    HttpRoute           *route;
+    HttpTx              *tx;
+    MprKeyValue         *item;
+    int                 index, next, protocol;
+
+    tx = stream->tx;
+    route = stream->rx->route;
+    protocol = stream->net->protocol;
+
+    if (ME_MAX_HEADER_PREFIXES <= 0 || !route || tx->status <= 0) {
+        return 0;
+    }
+    if ((prefixes = route->headerPrefixes) == 0) {
+        if ((prefixes = mprAllocZeroed(sizeof(HttpHeaderPrefix*) * ME_MAX_HEADER_PREFIXES)) == 0) {
+            return 0;
+        }
+        route->headerPrefixes = prefixes;
+    }
+    index = (tx->status * 2 + protocol) % ME_MAX_HEADER_PREFIXES;
+    prefix = prefixes[index];
+    if (!prefix || prefix->status != tx->status || prefix->protocol != protocol ||
+            prefix->software != stream->http->software) {
+        if ((prefix = createHeaderPrefix(stream)) == 0) {
+            return 0;
+        }
+        prefixes[index] = prefix;
+    }
+    if (mprLookupKey(tx->headers, "Date") || (prefix->server && mprLookupKey(tx->headers, "Server"))) {
+        return 0;
+    }
+    if (prefix->routeHeaders) {
         for (ITERATE_ITEMS(route->headers, item, next)) {
-            if (item->flags == HTTP_ROUTE_ADD_HEADER) {
-                value = httpExpandVars(stream, item->value);
-                httpAddHeaderString(stream, item->key, value);
+            if (mprLookupKey(tx->headers, item->key)) {
+                return 0;
+            }
+        }
+    }
+    return prefix;
+}
 
-            } else if (item->flags == HTTP_ROUTE_APPEND_HEADER) {
-                value = httpExpandVars(stream, item->value);
-                httpAppendHeaderString(stream, item->key, value);
 
-            } else if (item->flags == HTTP_ROUTE_REMOVE_HEADER) {
-                httpRemoveHeader(stream, item->key);
+/*
+    Serialize the invariant part of a response header. Route headers are only included if they are all static
+    add or set headers with distinct keys. Otherwise they are applied per-request by httpPrepareHeaders.
+ */
+static HttpHeaderPrefix *createHeaderPrefix(HttpStream *stream)
+{
+    HttpHeaderPrefix    *prefix;
+    HttpRoute           *route;
+    HttpTx              *tx;
+    MprKeyValue         *item, *other;
+    MprBuf              *buf;
+    int                 next, onext;
 
-            } else if (item->flags == HTTP_ROUTE_SET_HEADER) {
-                value = httpExpandVars(stream, item->value);
-                httpSetHeaderString(stream, item->key, value);
+    tx = stream->tx;
+    route = stream->rx->route;
+
+    if ((prefix = mprAllocObj(HttpHeaderPrefix, manageHeaderPrefix)) == 0) {
+        return 0;
+    }
+    prefix->protocol = stream->net->protocol;
+    prefix->status = tx->status;
+    prefix->software = stream->http->software;
+    prefix->server = !(route->flags & HTTP_ROUTE_STEALTH);
+    prefix->routeHeaders = 1;
+
+    for (ITERATE_ITEMS(route->headers, item, next)) {
+        if ((item->flags != HTTP_ROUTE_ADD_HEADER && item->flags != HTTP_ROUTE_SET_HEADER) ||
+                !item->value || schr(item->value, '$') ||
+                scaselessmatch(item->key, "Date") || scaselessmatch(item->key, "Server")) {
+            prefix->routeHeaders = 0;
+            break;
+        }
+        for (onext = next; (other = mprGetNextItem(route->headers, &onext)) != 0; ) {
+            if (scaselessmatch(item->key, other->key)) {
+                prefix->routeHeaders = 0;
+                break;
             }
         }
+        if (!prefix->routeHeaders) {
+            break;
+        }
+    }
+    buf = mprCreateBuf(ME_BUFSIZE, -1);
+    mprPutToBuf(buf, "%s %d %s\r\n", httpGetProtocol(stream->net), tx->status, httpLookupStatus(tx->status));
+    if (prefix->server) {
+        mprPutToBuf(buf, "Server: %s\r\n", prefix->software);
+    }
+    if (prefix->routeHeaders) {
+        for (ITERATE_ITEMS(route->headers, item, next)) {
+            mprPutToBuf(buf, "%s: %s\r\n", (char*) item->key, (char*) item->value);
+        }
+    }
+    prefix->length = mprGetBufLength(buf);
+    prefix->data = mprMemdup(mprGetBufStart(buf), prefix->length);
+    return prefix;
+}
+
+
+static void manageHeaderPrefix(HttpHeaderPrefix *prefix, int flags)
+{
+    if (flags & MPR_MANAGE_MARK) {
+        mprMark(prefix->data);
+        mprMark(prefix->software);
     }
 }
 
@@ -185,17 +185,17 @@ static int matchWebSock(HttpStream *stream, HttpRoute *route, int dir)
     if (tx->flags & HTTP_TX_HEADERS_CREATED) {
         return HTTP_ROUTE_OMIT_FILTER;
     }
-    version = (int) stoi(httpGetHeader(stream, "sec-websocket-version"));
+    version = (int) stoi(httpGetHeaderById(stream, HTTP_HEADER_SEC_WEBSOCKET_VERSION));
     if (version < WS_VERSION) {
         httpSetHeader(stream, "Sec-WebSocket-Version", "%d", WS_VERSION);
         httpError(stream, HTTP_CLOSE | HTTP_CODE_BAD_REQUEST, "Unsupported Sec-WebSocket-Version");
         return HTTP_ROUTE_OMIT_FILTER;
     }
-    if ((key = httpGetHeader(stream, "sec-websocket-key")) == 0) {
+    if ((key = httpGetHeaderById(stream, HTTP_HEADER_SEC_WEBSOCKET_KEY)) == 0) {
         httpError(stream, HTTP_CLOSE | HTTP_CODE_BAD_REQUEST, "Bad Sec-WebSocket-Key");
         return HTTP_ROUTE_OMIT_FILTER;
     }
-    protocols = httpGetHeader(stream, "sec-websocket-protocol");
+    protocols = httpGetHeaderById(stream, HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL);
 
     if (dir & HTTP_STAGE_RX) {
         if ((ws = mprAllocObj(HttpWebSocket, manageWebSocket)) == 0) {
@@ -1188,16 +1188,16 @@ PUBLIC bool httpVerifyWebSocketsHandshake(HttpStream *stream)
         httpError(stream, HTTP_CODE_BAD_HANDSHAKE, "Bad WebSocket handshake status %d", rx->status);
         return 0;
     }
-    if (!smatch(httpGetHeader(stream, "connection"), "Upgrade")) {
+    if (!smatch(httpGetHeaderById(stream, HTTP_HEADER_CONNECTION), "Upgrade")) {
         httpError(stream, HTTP_CODE_BAD_HANDSHAKE, "Bad WebSocket Connection header");
         return 0;
     }
-    if (!smatch(httpGetHeader(stream, "upgrade"), "WebSocket")) {
+    if (!smatch(httpGetHeaderById(stream, HTTP_HEADER_UPGRADE), "WebSocket")) {
         httpError(stream, HTTP_CODE_BAD_HANDSHAKE, "Bad WebSocket Upgrade header");
         return 0;
     }
     expected = mprGetSHABase64(sjoin(tx->webSockKey, WS_MAGIC, NULL));
-    key = httpGetHeader(stream, "sec-websocket-accept");
+    key = httpGetHeaderById(stream, HTTP_HEADER_SEC_WEBSOCKET_ACCEPT);
     if (!smatch(key, expected)) {
         httpError(stream, HTTP_CODE_BAD_HANDSHAKE, "Bad WebSocket handshake key\n%s\n%s", key, expected);
         return 0;
@@ -0,0 +1,124 @@
+/**
+    arena.c.tst - Request arena tests
+
+    Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "testme.h"
+#include    "http.h"
+
+/*********************************** Locals ***********************************/
+
+static HttpStream   *stream;
+
+/************************************ Code ************************************/
+
+static void createStream()
+{
+    HttpEndpoint    *endpoint;
+    HttpHost        *host;
+    HttpRoute       *route;
+
+    ttrue(httpCreate(HTTP_SERVER_SIDE) != 0);
+    host = httpCreateHost();
+    ttrue(host != 0);
+    route = httpCreateDefaultRoute(host);
+    ttrue(route != 0);
+    httpSetHostDefaultRoute(host, route);
+    route->limits->arenaSize = 4096;
+
+    endpoint = httpCreateEndpoint("127.0.0.1", 0, NULL);
+    ttrue(endpoint != 0);
+    httpAddHostToEndpoint(endpoint, host);
+    mprAddRoot(endpoint);
+
+    stream = httpCreateStream(httpCreateNet(NULL, endpoint, 1, 0), 0);
+    ttrue(stream != 0);
+    ttrue(httpServerStream(stream));
+    mprAddRoot(stream);
+}
+
+
+/*
+    Receive a request header the way the HTTP/1 parser does
+ */
+static void receiveHeader(cchar *key, cchar *value)
+{
+    httpSetRxHeader(stream, key, httpArenaClone(stream, value));
+}
+
+
+/*
+    Complete the current request and reset the stream for the next request on the keep-alive connection
+ */
+static void nextRequest()
+{
+    stream->keepAliveCount = 10;
+    stream->state = HTTP_STATE_COMPLETE;
+    httpResetServerStream(stream);
+}
+
+
+static void testArenaHeaders()
+{
+    cchar   *value, *promoted;
+    int     i;
+
+    receiveHeader("X-Session", "alpha-session-value");
+    value = httpGetHeader(stream, "X-Session");
+    ttrue(smatch(value, "alpha-session-value"));
+    ttrue(mprArenaContains(stream->arena, value));
+
+    promoted = httpPromote(stream, value);
+    ttrue(promoted != value);
+    ttrue(!mprArenaContains(stream->arena, promoted));
+    ttrue(smatch(promoted, "alpha-session-value"));
+    ttrue(httpPromote(stream, promoted) == promoted);
+    mprHold(promoted);
+
+    /*
+        The next request on the connection recycles the arena and overwrites the prior request headers
+     */
+    nextRequest();
+    ttrue(httpGetHeader(stream, "X-Session") == 0);
+    for (i = 0; i < 8; i++) {
+        receiveHeader(sfmt("X-Next-%d", i), "omega-overwrite-value");
+    }
+    ttrue(smatch(promoted, "alpha-session-value"));
+
+    mprGC(MPR_GC_FORCE | MPR_GC_COMPLETE);
+    ttrue(smatch(promoted, "alpha-session-value"));
+    mprRelease(promoted);
+}
+
+
+int main(int argc, char **argv)
+{
+    mprCreate(argc, argv, 0);
+    createStream();
+    testArenaHeaders();
+    return 0;
+}
+
+/*
+    @copy   default
+
+    Copyright (c) Embedthis Software. All Rights Reserved.
+    Copyright (c) Michael O'Brien. All Rights Reserved.
+
+    This software is distributed under commercial and open source licenses.
+    You may use the Embedthis Open Source license or you may acquire a
+    commercial license from Embedthis Software. You agree to be fully bound
+    by the terms of either license. Consult the LICENSE.md distributed with
+    this software for full details and other copyrights.
+
+    Local variables:
+    tab-width: 4
+    c-basic-offset: 4
+    End:
+    vim: sw=4 ts=4 expandtab
+
+    @end
+ */
@@ -0,0 +1,349 @@
+/**
+    route.c.tst - Route matching tests and micro benchmark
+
+    Copyright (c) All Rights Reserved. See details at the end of the file.
+ */
+
+/********************************** Includes **********************************/
+
+#include    "testme.h"
+#include    "http.h"
+#include    "pcre.h"
+
+/*********************************** Locals ***********************************/
+
+#define RESOURCES   200                 /* Number of RESTful resources. Each defines 10 routes */
+#define PATTERNS    100                 /* Number of regular expression routes without a literal leading segment */
+#define ITERATIONS  20000               /* Benchmark lookups */
+
+static HttpHost     *host;
+static HttpRoute    *guardedRoute;
+static HttpRoute    *prefixRoute;
+static HttpStream   *stream;
+static int          userCallouts;
+
+/************************************ Code ************************************/
+
+static void createRoutes()
+{
+    HttpRoute   *route;
+    int         i;
+
+    ttrue(httpCreate(HTTP_SERVER_SIDE | HTTP_CLIENT_SIDE) != 0);
+    host = httpCreateHost();
+    ttrue(host != 0);
+    mprAddRoot(host);
+
+    route = httpCreateDefaultRoute(host);
+    ttrue(route != 0);
+    route->handler = HTTP->passHandler;
+    httpSetHostDefaultRoute(host, route);
+
+    for (i = 0; i < RESOURCES; i++) {
+        httpAddResource(route, sfmt("res%d", i));
+    }
+    httpDefineRoute(route, "GET", "^/static/", "$&", 0);
+    httpDefineRoute(route, "GET", "^/exact$", "$&", 0);
+    httpDefineRoute(route, "GET", "^/assets/{name}\\.css$", "$&", 0);
+    httpDefineRoute(route, "GET", "^/expand/(.*)$", "$1/${request:method}/$$/${header:X-None=none}/$&", 0);
+    httpDefineRoute(route, "GET", "^/tokens$", "${header:X-Token=hdefault}/${param:token=pdefault}", 0);
+    for (i = 0; i < PATTERNS; i++) {
+        httpDefineRoute(route, "GET", sfmt("^/[a-z]+/item%d$", i), "$&", 0);
+    }
+    httpDefineRoute(route, "GET", "^/foo", "$&", 0);
+    httpDefineRoute(route, "GET", "^/api/v1", "$&", 0);
+    httpDefineRoute(route, "GET", "^/a(/b)?", "$&", 0);
+    httpDefineRoute(route, "GET", "^/q/{id}/more", "$&", 0);
+    httpDefineRoute(route, "GET", "^/pre\\.fix", "$&", 0);
+    httpDefineRoute(route, "GET", "^/c(/)*", "$&", 0);
+    guardedRoute = httpDefineRoute(route, "GET", "^/guarded$", "$&", 0);
+    prefixRoute = httpDefineRoute(route, "GET", "^/web/(pfx)$", "$1", 0);
+    ttrue(mprGetListLength(host->routes) > RESOURCES * 10 + PATTERNS);
+
+    stream = httpCreateStream(httpCreateNet(NULL, NULL, 0, 0), 0);
+    ttrue(stream != 0);
+    stream->host = host;
+    mprAddRoot(stream);
+}
+
+
+static HttpRx *createRequest(cchar *method, cchar *path)
+{
+    HttpRx      *rx;
+
+    stream->error = 0;
+    stream->errorMsg = 0;
+    rx = stream->rx = httpCreateRx(stream);
+    stream->tx = httpCreateTx(stream, NULL);
+    rx->method = sclone(method);
+    httpParseMethod(stream);
+    rx->pathInfo = sclone(path);
+    return rx;
+}
+
+
+static cchar *routeRequest(cchar *method, cchar *path)
+{
+    HttpRx      *rx;
+
+    rx = createRequest(method, path);
+    httpRouteRequest(stream);
+    return rx->route ? rx->route->pattern : "";
+}
+
+
+static void expect(cchar *method, cchar *path, cchar *pattern)
+{
+    cchar   *matched;
+
+    matched = routeRequest(method, path);
+    if (smatch(matched, pattern)) {
+        ttrue(1);
+    } else {
+        ttrue(0);
+        tinfo("%s %s routed to \"%s\" instead of \"%s\"", method, path, matched, pattern);
+    }
+}
+
+
+static void testRouteMatch()
+{
+    expect("GET", "/res7", "^/{controller=res7}$");
+    expect("GET", "/res7/edit", "^/{controller=res7}/edit$");
+    expect("GET", "/res7/", "^/{controller=res7}(/)*$");
+    expect("POST", "/res7/delete", "^/{controller=res7}/delete$");
+    expect("POST", "/res7", "^/{controller=res7}(/)*$");
+    expect("DELETE", "/res7", "^/{controller=res7}(/)*$");
+    expect("GET", "/res7/list", "^/{controller=res7}/{action}(/)*$");
+    ttrue(smatch(httpGetParam(stream, "controller", 0), "res7"));
+    ttrue(smatch(httpGetParam(stream, "action", 0), "list"));
+    expect("GET", "/res199/edit", "^/{controller=res199}/edit$");
+    expect("GET", "/res1999", "");
+    expect("GET", "/static/index.html", "^/static/");
+    expect("GET", "/exact", "^/exact$");
+    expect("GET", "/exact/more", "");
+    expect("GET", "/assets/site.css", "^/assets/{name}\\.css$");
+    expect("HEAD", "/exact", "^/exact$");
+    expect("PUT", "/res7/edit", "");
+    expect("GET", "/abc/item42", "^/[a-z]+/item42$");
+    expect("POST", "/abc/item42", "");
+}
+
+
+/*
+    Patterns without a trailing "$" match any path they prefix, including partial segments
+ */
+static void testRouteUnanchored()
+{
+    expect("GET", "/foo", "^/foo");
+    expect("GET", "/foobar", "^/foo");
+    expect("GET", "/foo/bar", "^/foo");
+    expect("GET", "/api/v1x", "^/api/v1");
+    expect("GET", "/ab", "^/a(/b)?");
+    expect("GET", "/a/b", "^/a(/b)?");
+    expect("GET", "/q/1/moreX", "^/q/{id}/more");
+    expect("GET", "/pre.fixed", "^/pre\\.fix");
+    expect("GET", "/cat", "^/c(/)*");
+}
+
+
+/*
+    Route targets expand pattern and request tokens
+ */
+static void testRouteTarget()
+{
+    expect("GET", "/expand/abc", "^/expand/(.*)$");
+    ttrue(smatch(stream->rx->target, "abc/GET/$/none//expand/abc"));
+    expect("GET", "/expand/x${request:method}", "^/expand/(.*)$");
+    ttrue(smatch(stream->rx->target, "x${request:method}/GET/$/none//expand/x${request:method}"));
+}
+
+
+/*
+    Compiled target templates must survive garbage collection between route definition and expansion
+ */
+static void testRouteTemplateCollect()
+{
+    int     i;
+
+    mprGC(MPR_GC_FORCE | MPR_GC_COMPLETE);
+    for (i = 0; i < 1000; i++) {
+        sfmt("%08d-overwrite-collected-template-tokens", i);
+    }
+    expect("GET", "/tokens", "^/tokens$");
+    ttrue(smatch(stream->rx->target, "hdefault/pdefault"));
+
+    createRequest("GET", "/tokens");
+    httpSetRxHeader(stream, "X-Token", "hvalue");
+    httpSetParam(stream, "token", "pvalue");
+    httpRouteRequest(stream);
+    ttrue(smatch(stream->rx->target, "hvalue/pvalue"));
+}
+
+
+/*
+    Repeated requests must be served from the route cache with the same route and params
+ */
+static void testRouteCache()
+{
+    HttpStats   before, after;
+
+    expect("GET", "/res42/list", "^/{controller=res42}/{action}(/)*$");
+    httpGetStats(&before);
+    expect("GET", "/res42/list", "^/{controller=res42}/{action}(/)*$");
+    ttrue(smatch(httpGetParam(stream, "controller", 0), "res42"));
+    ttrue(smatch(httpGetParam(stream, "action", 0), "list"));
+    expect("PUT", "/res42/list", "");
+    expect("GET", "/abc/item7", "^/[a-z]+/item7$");
+    expect("GET", "/abc/item7", "^/[a-z]+/item7$");
+    httpGetStats(&after);
+    ttrue(after.routeCacheHits >= before.routeCacheHits + 2);
+}
+
+
+/*
+    Route a GET request with an X-Check header
+ */
+static HttpRoute *routeChecked(cchar *path, cchar *check)
+{
+    createRequest("GET", path);
+    httpSetRxHeader(stream, "X-Check", check);
+    httpRouteRequest(stream);
+    return stream->rx->route;
+}
+
+
+/*
+    Request checks added to a route after requests are cached must apply to later requests
+ */
+static void testRouteCacheChecks()
+{
+    ttrue(routeChecked("/guarded", "no") == guardedRoute);
+    ttrue(routeChecked("/guarded", "no") == guardedRoute);
+
+    httpAddRouteRequestHeaderCheck(guardedRoute, "X-Check", "^yes$", 0);
+    ttrue(routeChecked("/guarded", "no") != guardedRoute);
+    ttrue(routeChecked("/guarded", "yes") == guardedRoute);
+
+    httpAddRouteParam(guardedRoute, "mode", "^fast$", 0);
+    ttrue(routeChecked("/guarded", "yes") != guardedRoute);
+}
+
+
+/*
+    Route rate limits fail requests once the burst is spent
+ */
+static void testRouteRate()
+{
+    HttpRoute   *route;
+
+    expect("GET", "/exact", "^/exact$");
+    route = stream->rx->route;
+    route->rate = httpCreateRate(1, 2, 0, 0);
+    ttrue(route->rate != 0);
+    routeRequest("GET", "/exact");
+    ttrue(stream->error == 0);
+    routeRequest("GET", "/exact");
+    ttrue(stream->error == 0);
+    routeRequest("GET", "/exact");
+    ttrue(stream->error != 0);
+    /* Test streams are not server streams, so the status is recorded in the rx */
+    ttrue(stream->rx->status == HTTP_CODE_TOO_MANY_REQUESTS);
+    routeRequest("GET", "/static/index.html");
+    ttrue(stream->error == 0);
+    route->rate = 0;
+}
+
+
+/*
+    Changing a route prefix after the index is built must rebuild the index. Matches are then relative to the
+    path after the prefix.
+ */
+static void testRoutePrefix()
+{
+    expect("GET", "/web/pfx", "^/web/(pfx)$");
+    ttrue(smatch(stream->rx->target, "pfx"));
+    httpSetRoutePrefix(prefixRoute, "/web");
+    expect("GET", "/web/pfx", "^/web/(pfx)$");
+    ttrue(smatch(stream->rx->pathInfo, "/pfx"));
+    ttrue(smatch(stream->rx->target, "pfx"));
+    httpSetRoutePrefix(prefixRoute, 0);
+    expect("GET", "/web/pfx", "^/web/(pfx)$");
+    ttrue(smatch(stream->rx->target, "pfx"));
+}
+
+
+static void testRouteSpeed(cchar *mode)
+{
+    MprTicks    mark, elapsed;
+    cchar       *paths[] = { "/res3/edit", "/res150/list", "/res199", "/abc/item99", "/missing", 0 };
+    int         i;
+
+    mark = mprGetTicks();
+    for (i = 0; i < ITERATIONS; i++) {
+        routeRequest("GET", paths[i % 5]);
+    }
+    elapsed = mprGetElapsedTicks(mark);
+    ttrue(elapsed >= 0);
+    tinfo("%s: routed %d requests over %d routes in %lld msec (%.2f usec per request)", mode, ITERATIONS,
+        mprGetListLength(host->routes), (int64) elapsed, elapsed * 1000.0 / ITERATIONS);
+}
+
+
+/*
+    Application callout hook that must be preserved by combined route matching
+ */
+static int userCallout(pcre_callout_block *cb)
+{
+    userCallouts++;
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    mprCreate(argc, argv, 0);
+    createRoutes();
+    testRouteMatch();
+    testRouteUnanchored();
+    testRouteCache();
+    testRouteCacheChecks();
+    testRouteTarget();
+    testRouteTemplateCollect();
+    testRouteRate();
+    testRoutePrefix();
+    testRouteSpeed("Indexed");
+
+    httpSetHostCombineRoutes(host, 1);
+    pcre_callout = userCallout;
+    testRouteMatch();
+    testRouteUnanchored();
+    testRoutePrefix();
+    /* The route callout hook is only installed while combined matchers run */
+    ttrue(pcre_callout == userCallout);
+    ttrue(userCallouts == 0);
+    pcre_callout = 0;
+    testRouteSpeed("Combined");
+    return 0;
+}
+
+/*
+    @copy   default
+
+    Copyright (c) Embedthis Software. All Rights Reserved.
+    Copyright (c) Michael O'Brien. All Rights Reserved.
+
+    This software is distributed under commercial and open source licenses.
+    You may use the Embedthis Open Source license or you may acquire a
+    commercial license from Embedthis Software. You agree to be fully bound
+    by the terms of either license. Consult the LICENSE.md distributed with
+    this software for full details and other copyrights.
+
+    Local variables:
+    tab-width: 4
+    c-basic-offset: 4
+    End:
+    vim: sw=4 ts=4 expandtab
+
+    @end
+ */
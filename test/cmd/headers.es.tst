@@ -1,5 +1,5 @@
 /*
-    headers.tst - Test http --showHeaders
+    headers.tst - Test http --showHeaders and HTTP/1 request header parsing
  */
 
 require support
@@ -7,3 +7,53 @@ require support
 //  Validate that header appears
 let data = http("-q --showHeaders --header 'custom: MyHeader' /index.html").toLower()
 ttrue(data.contains('content-type'))
+
+/*
+    Send a raw HTTP/1 request for /numbers.html with the given header lines and return the response.
+    Malformed requests are aborted without a response.
+ */
+function request(headers: String): String {
+    let sock = new Socket
+    sock.connect((tget('TM_HTTP') || '127.0.0.1:4100').replace('http://', ''))
+    sock.write('GET /numbers.html HTTP/1.1\r\nHost: localhost\r\n' + headers + 'Connection: close\r\n\r\n')
+    let response = new ByteArray
+    while (sock.read(response, -1)) {}
+    sock.close()
+    return response.toString()
+}
+
+//  Test that the headers parse and the parser is still in step for a following Range header
+function accepted(headers: String): Boolean {
+    let response = request(headers + 'Range: bytes=0-4\r\n')
+    return response.startsWith('HTTP/1.1 206') && response.contains('\r\n01234\r\n')
+}
+
+function rejected(headers: String): Boolean {
+    return request(headers) == ''
+}
+
+//  Invalid token characters in header keys and invalid characters in values
+ttrue(rejected('X-B{ad: value\r\n'))
+ttrue(rejected('X-B@d: value\r\n'))
+ttrue(rejected(': value\r\n'))
+ttrue(rejected('X-Control: a\x01b\r\n'))
+
+//  Whitespace before the colon and obsolete line folding
+ttrue(rejected('X-Space : value\r\n'))
+ttrue(rejected('X-Tab\t: value\r\n'))
+ttrue(rejected('X-Fold: one\r\n two\r\n'))
+
+//  The last of duplicate well-known headers is used regardless of case
+ttrue(request('Range: bytes=0-1\r\nrange: bytes=0-4\r\n').contains('\r\n01234\r\n'))
+ttrue(request('Range: bytes=0-4\r\nRange: bytes=5-9\r\n').contains('\r\n56789\r\n'))
+
+//  Keys and values that end before, on and after 16 byte scanning boundaries
+for (let n = 1; n < 50; n++) {
+    ttrue(accepted('X' + 'k'.times(n - 1) + ': value\r\n'))
+    ttrue(accepted('X-Value: ' + 'v'.times(n) + '\r\n'))
+    ttrue(accepted('X-Value:' + ' '.times(n) + 'v\r\n'))
+}
+for each (n in [15, 16, 17, 31, 32, 33, 47, 48, 49]) {
+    ttrue(rejected('X' + 'k'.times(n - 1) + '{: value\r\n'))
+    ttrue(rejected('X-Value: ' + 'v'.times(n - 1) + '\x7f\r\n'))
+}
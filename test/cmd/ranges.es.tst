@@ -7,3 +7,24 @@ require support
 //  Ranges
 ttrue(http("--range 0-4 /numbers.html") == "01234")
 ttrue(http("--range -5 /numbers.html") == "5678")
+
+//  Overlapping and out of order ranges are coalesced into one range
+ttrue(http("--range 0-4,2-6 /numbers.html") == "0123456")
+ttrue(http("--range 2-6,0-4 /numbers.html") == "0123456")
+
+//  Adjacent ranges are coalesced
+ttrue(http("--range 0-4,5-9 /numbers.html") == "0123456789")
+
+//  Disjoint ranges are sent as multipart byte ranges
+let data = http("--range 0-1,3-4 /numbers.html")
+ttrue(data.contains('Content-Range: bytes 0-1/650'))
+ttrue(data.contains('Content-Range: bytes 3-4/650'))
+
+//  Requests with more ranges than limits.ranges (default 16) are rejected
+let ranges = []
+for (let i = 0; i < 17; i++) {
+    ranges.push(i * 2 + '-' + i * 2)
+}
+ttrue(http('--showStatus --range ' + ranges.join(',') + ' /numbers.html').contains('416'))
+ranges.pop()
+ttrue(http('--range ' + ranges.join(',') + ' /numbers.html').contains('Content-Range: bytes 30-30/650'))
@@ -0,0 +1,37 @@
+/*
+    vary.tst - Test server caching of responses that vary by request header
+ */
+
+require support
+
+function get(variant, uri): String {
+    return http("--header 'X-Variant: " + variant + "' " + uri)
+}
+
+//  Use new documents so responses cached by a prior run are not served
+let name = Date.now() + '.txt'
+let data = Path('web/vary/data-' + name)
+let all = Path('web/vary/all-' + name)
+
+//  Each request header value is cached as a separate variant
+data.write('one')
+ttrue(get('a', '/vary/data-' + name) == 'one')
+ttrue(get('b', '/vary/data-' + name) == 'one')
+data.write('two')
+ttrue(get('a', '/vary/data-' + name) == 'one')
+ttrue(get('b', '/vary/data-' + name) == 'one')
+ttrue(get('c', '/vary/data-' + name) == 'two')
+
+//  Variants are limited by limits.cacheVariants and the oldest variant is evicted
+ttrue(get('a', '/vary/data-' + name) == 'two')
+data.write('three')
+ttrue(get('c', '/vary/data-' + name) == 'two')
+
+//  Responses with Vary: * are not cached
+all.write('one')
+ttrue(get('a', '/vary/all-' + name) == 'one')
+all.write('two')
+ttrue(get('a', '/vary/all-' + name) == 'two')
+
+data.remove()
+all.remove()